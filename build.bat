@@ -15,7 +15,20 @@ call %MSVC_PATH%\vcvars64.bat
 pushd %~dp0
 if not exist .\build mkdir build
 
-if "%1" == "release" (
+if "%1" == "bench" (
+    cl %CFLAGS% %RELEASE_FLAGS% %INCLUDES% "code\bench.cpp" /Fo:build\ /Fe:build\bench.exe /link %LIBS% /ignore:4099
+    
+    del ".\build\*.obj"
+) else if "%1" == "replay" (
+    cl %CFLAGS% %RELEASE_FLAGS% %INCLUDES% "code\replay.cpp" /Fo:build\ /Fe:build\replay_null.exe /link %LIBS% /ignore:4099
+    cl %CFLAGS% %RELEASE_FLAGS% %INCLUDES% /DR_BACKEND_D3D11=1 "code\replay.cpp" /Fo:build\ /Fe:build\replay_d3d11.exe /link %LIBS% %D3D11_LIBS% /ignore:4099
+    
+    del ".\build\*.obj"
+) else if "%1" == "batch" (
+    cl %CFLAGS% %RELEASE_FLAGS% %INCLUDES% "code\batch.cpp" /Fo:build\ /Fe:build\batch.exe /link %LIBS% %D3D11_LIBS% /ignore:4099
+    
+    del ".\build\*.obj"
+) else if "%1" == "release" (
     cl %CFLAGS% %RELEASE_FLAGS% %INCLUDES% "code\main.cpp" /Fo:build\ /Fe:build\mathplot.exe /link %LIBS% %D3D11_LIBS% /ignore:4099
     
     if exist ".\build\OptickCore.dll" del ".\build\OptickCore.dll"
@@ -19,6 +19,17 @@
 # error No thread_var variable defined for current compiler
 #endif
 
+// @Note: Full barriers, for flags and counters shared between threads.
+#ifdef _MSC_VER
+# include <intrin.h>
+# define AtomicLoadU32(ptr) ((u32) _InterlockedOr((volatile long *) (ptr), 0))
+# define AtomicStoreU32(ptr, val) ((void) _InterlockedExchange((volatile long *) (ptr), (long) (val)))
+# define AtomicLoadU64(ptr) ((u64) _InterlockedOr64((volatile __int64 *) (ptr), 0))
+# define AtomicAddU64(ptr, val) ((u64) _InterlockedExchangeAdd64((volatile __int64 *) (ptr), (__int64) (val)))
+#else
+# error No atomics defined for current compiler
+#endif
+
 #define UNUSED(x) ((void)(x))
 
 #define KB(x) ((x) << 10)
@@ -99,5 +110,6 @@ extern "C" void __asan_unpoison_memory_region(void *, size_t);
 #define MemoryZero(p, size) memset((p), 0, (size))
 #define MemoryCopy(dst, src, size) memmove((dst), (src), (size))
 #define MemoryCopyStruct(dst, src) MemoryCopy((dst), (src), MIN(sizeof(*(dst)), sizeof(*(src))))
+#define MemoryMatch(a, b, size) (memcmp((a), (b), (size)) == 0)
 
 #endif // BASE_MACROS_H
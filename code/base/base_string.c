@@ -41,6 +41,12 @@ internal String8 str8_push_copy(Arena *arena, String8 str)
     return(result);
 }
 
+internal b32 str8_match(String8 a, String8 b)
+{
+    b32 result = (a.size == b.size) && MemoryMatch(a.data, b.data, a.size);
+    return(result);
+}
+
 internal String8 str8_alloc(Arena *arena, usize size)
 {
     String8 result = {0};
@@ -49,3 +55,61 @@ internal String8 str8_alloc(Arena *arena, usize size)
     result.data[size] = 0;
     return(result);
 }
+
+internal Str8_Decode str8_decode_utf8(u8 *data, usize size)
+{
+    Str8_Decode result = { STR8_REPLACEMENT_CHAR, 1 };
+    if (size == 0) {
+        result.size = 0;
+        return(result);
+    }
+    
+    u8 lead = data[0];
+    u32 count = 0;
+    u32 codepoint = 0;
+    u32 min = 0;
+    if (lead < 0x80) {
+        result.codepoint = lead;
+        return(result);
+    } else if ((lead & 0xE0) == 0xC0) {
+        count = 2; codepoint = lead & 0x1F; min = 0x80;
+    } else if ((lead & 0xF0) == 0xE0) {
+        count = 3; codepoint = lead & 0x0F; min = 0x800;
+    } else if ((lead & 0xF8) == 0xF0) {
+        count = 4; codepoint = lead & 0x07; min = 0x10000;
+    } else {
+        return(result);
+    }
+    
+    if (count > size) {
+        return(result);
+    }
+    
+    for (u32 i = 1; i < count; ++i) {
+        if ((data[i] & 0xC0) != 0x80) {
+            return(result);
+        }
+        
+        codepoint = (codepoint << 6) | (data[i] & 0x3F);
+    }
+    
+    // @Note: Overlong encodings, surrogates and anything past the last plane are all rejected
+    b32 valid = codepoint >= min && codepoint <= 0x10FFFF && (codepoint < 0xD800 || codepoint > 0xDFFF);
+    if (valid) {
+        result.codepoint = codepoint;
+        result.size = count;
+    }
+    
+    return(result);
+}
+
+internal u64 str8_hash(u64 seed, String8 str)
+{
+    u64 result = seed;
+    for (usize i = 0; i < str.size; ++i) {
+        result ^= str.data[i];
+        result *= 0x100000001b3ull;
+    }
+    
+    return(result);
+}
@@ -6,12 +6,27 @@ typedef struct {
     usize size;
 } String8;
 
+// @Note: One decoded codepoint and how many bytes it took, malformed input
+// decodes to U+FFFD one byte at a time so that the caller always makes progress.
+typedef struct {
+    u32 codepoint;
+    u32 size;
+} Str8_Decode;
+
+#define STR8_REPLACEMENT_CHAR 0xFFFD
+
+// @Note: FNV-1a offset basis, the usual seed for str8_hash(). Chain hashes by passing the previous result as the seed.
+#define STR8_HASH_SEED 0xcbf29ce484222325ull
+
 internal String8 str8_alloc(Arena *arena, usize size);
 internal String8 str8_make(u8 *data, usize size);
 internal String8 str8_push_cstr(Arena *arena, const char *cstr);
 internal String8 str8_from_cstr(const char *cstr);
 internal String8 str8_push_copy(Arena *arena, String8 str);
+internal b32 str8_match(String8 a, String8 b);
 internal usize str8_cstr_size(const char *cstr);
+internal Str8_Decode str8_decode_utf8(u8 *data, usize size);
+internal u64 str8_hash(u64 seed, String8 str);
 
 #define str8(cstr) str8_make((u8 *) (cstr), sizeof(cstr) - 1)
 
@@ -0,0 +1,807 @@
+#define R_BACKEND_D3D11 1
+#define FONT_USE_FREETYPE 1
+
+// @Note: Draws plots of CSV files without a window and saves them as pictures, for reports made out of
+// many files at once.
+//
+// batch <manifest> [-workers N] [-warp]
+//
+// The manifest is a CSV with a header and one picture a line, the columns can come in any order:
+//
+//   input,output,x,y,x_min,x_max,y_min,y_max,width,height,line,frames,x_step,fps
+//   data/a.csv,out/a.png,time,value,,,-1,1,1920,1080,1
+//   data/b.csv,out/b.y4m,time,value,0,10,,,1280,720,1,600,0.05,60
+//
+// Only 'input' and 'output' are needed. 'x' and 'y' pick the columns of the input by header name or
+// index (0 and 1 by default). An axis without both of its limits fits the data, the size defaults to
+// 1280x720 and 'line' connects the points. The output's extension picks the format, .png, .jpg or .tga.
+// Paths are relative to where batch runs, the font is looked for there too.
+//
+// 'frames' above 1 makes a sequence: the x window scrolls by 'x_step' every frame, or evenly until its
+// right edge meets the end of the data when that's left out. Without x limits the window is a quarter
+// of the data, starting at its left. Frames go to numbered pictures next to the
+// output ("out/b_00012.png"), or all into one uncompressed stream when the output is a .y4m, played at
+// 'fps' (30 by default). The y axis stays put over the whole sequence.
+//
+// Workers (one per CPU by default) read the inputs and encode the pictures, each with its own arenas,
+// while this thread only draws and queues the readbacks. Every worker has two jobs, so one can be
+// drawn while the other loads or encodes. -warp draws with the software rasterizer, pictures then come
+// out the same on every machine.
+
+#define BATCH_MAX_WORKERS 16
+#define BATCH_WORKER_JOBS 2
+#define BATCH_MANIFEST_MAX_COLUMNS 32
+#define BATCH_DEFAULT_WIDTH 1280
+#define BATCH_DEFAULT_HEIGHT 720
+#define BATCH_CLEAR_COLOR 0x121212FF
+#define BATCH_REPORT_MS 1000.0
+#define BATCH_SEQUENCE_WINDOW 0.25f // @Note: Of the data, when a sequence fits its x axis
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <HandmadeMath.h>
+#include <optick.h>
+
+#include <ft2build.h>
+#include <freetype/freetype.h>
+#include <freetype/ftmodapi.h>
+#include <freetype/ftoutln.h>
+
+#include "./base/base_inc.h"
+#include "./os/os_inc.h"
+#include "./gfx/gfx_inc.h"
+#include "./render/render_inc.h"
+#include "./font/font_inc.h"
+#include "./image/image_inc.h"
+#include "./csv/csv.h"
+#include "./graph/graph_inc.h"
+
+#include "./base/base_inc.c"
+#include "./os/os_inc.c"
+#include "./gfx/gfx_inc.c"
+#include "./render/render_inc.c"
+#include "./font/font_inc.c"
+#include "./image/image_inc.c"
+#include "./csv/csv.c"
+#include "./graph/graph_inc.c"
+
+typedef enum {
+    BATCH_FIELD_INPUT = 0,
+    BATCH_FIELD_OUTPUT,
+    BATCH_FIELD_X,
+    BATCH_FIELD_Y,
+    BATCH_FIELD_X_MIN,
+    BATCH_FIELD_X_MAX,
+    BATCH_FIELD_Y_MIN,
+    BATCH_FIELD_Y_MAX,
+    BATCH_FIELD_WIDTH,
+    BATCH_FIELD_HEIGHT,
+    BATCH_FIELD_LINE,
+    BATCH_FIELD_FRAMES,
+    BATCH_FIELD_X_STEP,
+    BATCH_FIELD_FPS,
+    BATCH_FIELD_COUNT,
+} Batch_Field;
+
+global const char *batch_field_names[BATCH_FIELD_COUNT] = {
+    "input", "output", "x", "y", "x_min", "x_max", "y_min", "y_max", "width", "height", "line",
+    "frames", "x_step", "fps",
+};
+
+typedef struct {
+    String8 input; // @Note: Zero terminated, they go straight to the OS
+    String8 output;
+    Image_Format format;
+    b32 y4m;
+    
+    String8 x_column;
+    String8 y_column;
+    b32 fit_x;
+    b32 fit_y;
+    HMM_Vec2 x_range;
+    HMM_Vec2 y_range;
+    
+    u32 width;
+    u32 height;
+    b32 line;
+    
+    u32 frames; // @Note: 1 for a single picture
+    b32 step_given;
+    f32 x_step; // @Note: How far the x window moves every frame
+    u32 fps;
+    
+    // @Note: Written by the worker loading the first frame, read only after that.
+    f32 *xs;
+    f32 *ys;
+    u32 count;
+    HMM_Vec2 window; // @Note: The x range of the first frame
+    HMM_Vec2 y_limits;
+    
+    // @Note: Main. The first frame's job reads the series into the item's arena, the other frames go
+    // out once it's there. The arena is released when the last frame is done.
+    Arena *arena;
+    b32 loaded;
+    b32 failed;
+    u32 frames_done;
+    b32 streaming;
+    u32 frames_written; // @Note: Of the stream, frames go in in order
+    Image_Y4m stream;
+} Batch_Item;
+
+typedef enum {
+    BATCH_JOB_FREE = 0, // @Note: Main
+    BATCH_JOB_LOADING,  // @Note: Worker, reads the input into the item's arena
+    BATCH_JOB_LOADED,   // @Note: Main, draws and queues the readback
+    BATCH_JOB_READBACK, // @Note: Main, waiting on the copy out of the target
+    BATCH_JOB_ENCODING, // @Note: Worker, reads the mapped pixels
+    BATCH_JOB_DONE,     // @Note: Main, unmaps, writes stream frames and counts
+} Batch_Job_State;
+
+typedef struct {
+    u32 state;
+    Batch_Item *item;
+    u32 frame;
+    Arena *arena; // @Note: The frame's path or converted frame, cleared once the job is done
+    String8 output;
+    u8 *converted;
+    
+    R_Target *target; // @Note: Kept between pictures, re-created when the size changes
+    u32 width;
+    u32 height;
+    u8 *pixels;
+    u32 pitch;
+    
+    b32 failed;
+    f64 load_ms;
+    f64 encode_ms;
+} Batch_Job;
+
+typedef struct Batch Batch;
+
+typedef struct {
+    Batch *batch;
+    OS_Thread thread;
+    OS_Semaphore wake;
+    Arena *arena; // @Note: The encoder's, back to empty after every picture
+    Batch_Job jobs[BATCH_WORKER_JOBS];
+} Batch_Worker;
+
+struct Batch {
+    OS_Semaphore wake; // @Note: Main, signaled whenever a worker hands a job back
+    u32 quit;
+    
+    u32 worker_count;
+    Batch_Worker workers[BATCH_MAX_WORKERS];
+};
+
+global Batch batch = {0};
+
+internal usize batch_extension_start(String8 path)
+{
+    // @Note: Where the dot is, the size when there's none in the file name
+    usize result = path.size;
+    for (usize i = path.size; i > 0; --i) {
+        u8 c = path.data[i - 1];
+        if (c == '/' || c == '\\') break;
+        if (c == '.') {
+            result = i - 1;
+            break;
+        }
+    }
+    
+    return(result);
+}
+
+internal b32 batch_format_from_path(String8 path, Image_Format *format, b32 *y4m)
+{
+    usize dot = MIN(batch_extension_start(path) + 1, path.size);
+    
+    u8 lower[8] = {0};
+    usize size = path.size - dot;
+    for (usize i = 0; i < size && i < sizeof(lower); ++i) {
+        u8 c = path.data[dot + i];
+        lower[i] = (u8) (BETWEEN(c, 'Z', 'A') ? c + ('a' - 'A') : c);
+    }
+    
+    String8 extension = str8_make(lower, MIN(size, sizeof(lower)));
+    b32 result = 1;
+    *y4m = 0;
+    if (str8_match(extension, str8("png"))) {
+        *format = IMAGE_FORMAT_PNG;
+    } else if (str8_match(extension, str8("jpg")) || str8_match(extension, str8("jpeg"))) {
+        *format = IMAGE_FORMAT_JPEG;
+    } else if (str8_match(extension, str8("tga"))) {
+        *format = IMAGE_FORMAT_TGA;
+    } else if (str8_match(extension, str8("y4m"))) {
+        *y4m = 1;
+    } else {
+        result = 0;
+    }
+    
+    return(result);
+}
+
+internal String8 batch_frame_path(Arena *arena, String8 path, u32 frame)
+{
+    usize dot = batch_extension_start(path);
+    s32 size = snprintf(0, 0, "%.*s_%05u%.*s", (int) dot, path.data, frame, (int) (path.size - dot), path.data + dot);
+    String8 result = str8_alloc(arena, (usize) size);
+    snprintf((char *) result.data, result.size + 1, "%.*s_%05u%.*s", (int) dot, path.data, frame, (int) (path.size - dot), path.data + dot);
+    return(result);
+}
+
+internal Batch_Item *batch_manifest_read(Arena *arena, String8 path, u32 *count)
+{
+    *count = 0;
+    String8 data = os_file_read(arena, path);
+    if (data.size == 0) {
+        printf("Failed to read manifest %.*s\n", (int) path.size, path.data);
+        return(0);
+    }
+    
+    u32 line_count = 1;
+    for (usize i = 0; i < data.size; ++i) {
+        line_count += (data.data[i] == '\n');
+    }
+    Batch_Item *items = arena_push_array(arena, Batch_Item, line_count);
+    
+    CSV_Reader reader = csv_reader_make(data);
+    String8 field = {0};
+    b32 line_end = 0;
+    
+    // @Note: Which field every column of the manifest is, unknown ones are skipped.
+    s32 columns[BATCH_MANIFEST_MAX_COLUMNS];
+    u32 column_count = 0;
+    while (!line_end && csv_next_field(&reader, &field, &line_end)) {
+        s32 known = -1;
+        for (u32 i = 0; i < BATCH_FIELD_COUNT && known < 0; ++i) {
+            if (str8_match(field, str8_from_cstr(batch_field_names[i]))) {
+                known = (s32) i;
+            }
+        }
+        
+        if (column_count < BATCH_MANIFEST_MAX_COLUMNS) {
+            columns[column_count++] = known;
+        }
+    }
+    
+    u32 line = 1;
+    String8 fields[BATCH_FIELD_COUNT] = {0};
+    u32 column = 0;
+    while (csv_next_field(&reader, &field, &line_end)) {
+        if (column < column_count && columns[column] >= 0) {
+            fields[columns[column]] = field;
+        }
+        column += 1;
+        
+        if (!line_end) {
+            continue;
+        }
+        
+        line += 1;
+        column = 0;
+        if (fields[BATCH_FIELD_INPUT].size == 0 && fields[BATCH_FIELD_OUTPUT].size == 0) {
+            MemoryZero(fields, sizeof(fields));
+            continue;
+        }
+        
+        Batch_Item *item = items + *count;
+        b32 error = 0;
+        if (fields[BATCH_FIELD_INPUT].size == 0 || fields[BATCH_FIELD_OUTPUT].size == 0) {
+            printf("Line %u: needs both an input and an output\n", line);
+            error = 1;
+        } else if (!batch_format_from_path(fields[BATCH_FIELD_OUTPUT], &item->format, &item->y4m)) {
+            printf("Line %u: unknown picture format %.*s\n", line, (int) fields[BATCH_FIELD_OUTPUT].size, fields[BATCH_FIELD_OUTPUT].data);
+            error = 1;
+        }
+        
+        if (!error) {
+            item->input = str8_push_copy(arena, fields[BATCH_FIELD_INPUT]);
+            item->output = str8_push_copy(arena, fields[BATCH_FIELD_OUTPUT]);
+            item->x_column = fields[BATCH_FIELD_X].size ? str8_push_copy(arena, fields[BATCH_FIELD_X]) : str8("0");
+            item->y_column = fields[BATCH_FIELD_Y].size ? str8_push_copy(arena, fields[BATCH_FIELD_Y]) : str8("1");
+            
+            f64 limits[4] = {0};
+            b32 given[4] = {0};
+            for (u32 i = 0; i < 4; ++i) {
+                given[i] = csv_parse_f64(fields[BATCH_FIELD_X_MIN + i], limits + i);
+            }
+            
+            item->fit_x = !(given[0] && given[1] && limits[0] < limits[1]);
+            item->fit_y = !(given[2] && given[3] && limits[2] < limits[3]);
+            item->x_range = { (f32) limits[0], (f32) limits[1] };
+            item->y_range = { (f32) limits[2], (f32) limits[3] };
+            
+            f64 width = BATCH_DEFAULT_WIDTH;
+            f64 height = BATCH_DEFAULT_HEIGHT;
+            f64 show_line = 0.0;
+            f64 frames = 1.0;
+            f64 x_step = 0.0;
+            f64 fps = IMAGE_Y4M_DEFAULT_FPS;
+            csv_parse_f64(fields[BATCH_FIELD_WIDTH], &width);
+            csv_parse_f64(fields[BATCH_FIELD_HEIGHT], &height);
+            csv_parse_f64(fields[BATCH_FIELD_LINE], &show_line);
+            csv_parse_f64(fields[BATCH_FIELD_FRAMES], &frames);
+            item->step_given = csv_parse_f64(fields[BATCH_FIELD_X_STEP], &x_step);
+            csv_parse_f64(fields[BATCH_FIELD_FPS], &fps);
+            item->width = (u32) MAX(1.0, MIN(width, (f64) R_TARGET_MAX_CANVAS));
+            item->height = (u32) MAX(1.0, MIN(height, (f64) R_TARGET_MAX_CANVAS));
+            item->line = (show_line != 0.0);
+            item->frames = (u32) MAX(1.0, MIN(frames, 1e7));
+            item->x_step = (f32) x_step;
+            item->fps = (u32) MAX(1.0, MIN(fps, 1000.0));
+            
+            *count += 1;
+        }
+        
+        MemoryZero(fields, sizeof(fields));
+    }
+    
+    return(items);
+}
+
+internal void batch_load(Batch_Job *job)
+{
+    OPTICK_EVENT();
+    
+    f64 start = os_ticks_now();
+    Batch_Item *item = job->item;
+    
+    String8 data = os_file_read(item->arena, item->input);
+    CSV_Table table = {0};
+    b32 error = (data.size == 0) || !csv_table_read(&table, item->arena, data);
+    
+    s32 x = -1;
+    s32 y = -1;
+    if (!error) {
+        x = csv_table_column(&table, item->x_column);
+        y = csv_table_column(&table, item->y_column);
+        error = (x < 0 || y < 0);
+    }
+    
+    // @Note: Rows missing either value are left out.
+    HMM_Vec2 x_limits = { INFINITY, -INFINITY };
+    HMM_Vec2 y_limits = { INFINITY, -INFINITY };
+    if (!error) {
+        item->xs = (f32 *) arena_push_no_zero(item->arena, sizeof(f32)*table.row_count);
+        item->ys = (f32 *) arena_push_no_zero(item->arena, sizeof(f32)*table.row_count);
+        item->count = 0;
+        for (u32 i = 0; i < table.row_count; ++i) {
+            f32 vx = table.columns[x][i];
+            f32 vy = table.columns[y][i];
+            if (!isnan(vx) && !isnan(vy)) {
+                item->xs[item->count] = vx;
+                item->ys[item->count] = vy;
+                item->count += 1;
+                
+                x_limits = { MIN(x_limits.X, vx), MAX(x_limits.Y, vx) };
+                y_limits = { MIN(y_limits.X, vy), MAX(y_limits.Y, vy) };
+            }
+        }
+        
+        error = (item->count == 0);
+    }
+    
+    if (!error) {
+        // @Note: A little room around the data, so markers on the edge aren't cut in half
+        HMM_Vec2 *limits[2] = { &x_limits, &y_limits };
+        for (u32 i = 0; i < 2; ++i) {
+            f32 pad = (limits[i]->Y - limits[i]->X)*0.05f;
+            pad = (pad > 0.0f) ? pad : 1.0f;
+            limits[i]->X -= pad;
+            limits[i]->Y += pad;
+        }
+        
+        item->window = item->fit_x ? x_limits : item->x_range;
+        if (item->fit_x && item->frames > 1) {
+            item->window.Y = x_limits.X + (x_limits.Y - x_limits.X)*BATCH_SEQUENCE_WINDOW;
+        }
+        item->y_limits = item->fit_y ? y_limits : item->y_range;
+        if (!item->step_given) {
+            item->x_step = (item->frames > 1) ? MAX(x_limits.Y - item->window.Y, 0.0f)/(f32) (item->frames - 1) : 0.0f;
+        }
+    }
+    
+    job->failed = error;
+    job->load_ms = os_ticks_now() - start;
+}
+
+internal b32 batch_draw(Batch_Job *job, Arena *frame_arena)
+{
+    OPTICK_EVENT();
+    
+    Batch_Item *item = job->item;
+    if (job->target == 0 || job->width != item->width || job->height != item->height) {
+        if (job->target) {
+            r_target_destroy(job->target);
+        }
+        
+        job->target = r_target_create(item->width, item->height);
+        job->width = item->width;
+        job->height = item->height;
+    }
+    
+    b32 error = (job->target == 0);
+    if (!error) {
+        HMM_Vec2 size = { (f32) job->width, (f32) job->height };
+        f32 shift = item->x_step*(f32) job->frame;
+        HMM_Vec2 x_range = { item->window.X + shift, item->window.Y + shift };
+        
+        state.graph_data.xs = item->xs;
+        state.graph_data.ys = item->ys;
+        state.graph_data.size = item->count;
+        state.show_line = item->line;
+        graph_view_fit(size, x_range, item->y_limits);
+        graph_fit_limits(size);
+        
+        R_List list = {0};
+        R_Ctx ctx = r_make_context(frame_arena, &list, GRAPH_LAYER_PLOT);
+        R_Ctx ui_ctx = r_make_context(frame_arena, &list, GRAPH_LAYER_UI);
+        
+        r_target_begin(job->target, BATCH_CLEAR_COLOR);
+        r_graph(size, &ctx, &ui_ctx, state.light_mode);
+        r_flush_batches(0, &list);
+        r_target_end(job->target);
+        r_target_read_begin(job->target);
+        
+        font_next_frame(&state.font);
+        arena_clear(frame_arena);
+    }
+    
+    b32 result = !error;
+    return(result);
+}
+
+internal void batch_encode(Batch_Worker *worker, Batch_Job *job)
+{
+    OPTICK_EVENT();
+    
+    f64 start = os_ticks_now();
+    b32 error = 0;
+    if (job->item->y4m) {
+        // @Note: Only converted here, main writes the frames of a stream in order.
+        job->converted = (u8 *) arena_push_no_zero(job->arena, image_y4m_frame_size(job->width, job->height));
+        image_y4m_convert(job->converted, job->pixels, job->width, job->height, job->pitch);
+    } else {
+        Arena_Temp temp = arena_temp_begin(worker->arena);
+        
+        // @Note: Pictures are spread over the workers already, so each one is encoded on one thread.
+        Image_Writer writer = {0};
+        Image_Options options = {GRAPH_EXPORT_QUALITY, IMAGE_SUBSAMPLING_444, 1};
+        error = !image_writer_begin_ex(&writer, temp.arena, job->output, job->item->format,
+                                       job->width, job->height, options);
+        if (!error) {
+            image_writer_rows(&writer, job->pixels, job->height, job->pitch);
+            error = !image_writer_end(&writer);
+        }
+        
+        arena_temp_end(&temp);
+    }
+    
+    job->failed = error;
+    job->encode_ms = os_ticks_now() - start;
+}
+
+internal void batch_item_done(Batch_Item *item, u32 frames)
+{
+    // @Note: The stream is closed and the series dropped once the last frame is through.
+    item->frames_done += frames;
+    if (item->frames_done == item->frames && item->arena) {
+        if (item->streaming && !image_y4m_end(&item->stream)) {
+            item->failed = 1;
+        }
+        
+        arena_release(item->arena);
+        item->arena = 0;
+    }
+}
+
+internal void batch_worker_thread(void *data)
+{
+    OPTICK_THREAD("Batch");
+    
+    Batch_Worker *worker = (Batch_Worker *) data;
+    Batch *owner = worker->batch;
+    for (;;) {
+        os_semaphore_wait(worker->wake);
+        if (AtomicLoadU32(&owner->quit)) break;
+        
+        for (u32 i = 0; i < BATCH_WORKER_JOBS; ++i) {
+            Batch_Job *job = worker->jobs + i;
+            u32 job_state = AtomicLoadU32(&job->state);
+            if (job_state == BATCH_JOB_LOADING) {
+                batch_load(job);
+                AtomicStoreU32(&job->state, job->failed ? BATCH_JOB_DONE : BATCH_JOB_LOADED);
+                os_semaphore_signal(owner->wake);
+            } else if (job_state == BATCH_JOB_ENCODING) {
+                batch_encode(worker, job);
+                AtomicStoreU32(&job->state, BATCH_JOB_DONE);
+                os_semaphore_signal(owner->wake);
+            }
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        printf("usage: batch <manifest> [-workers N] [-warp]\n");
+        return 1;
+    }
+    
+    u32 workers = 0;
+    b32 software = 0;
+    for (int i = 2; i < argc; ++i) {
+        if (strcmp(argv[i], "-warp") == 0) {
+            software = 1;
+        } else if (strcmp(argv[i], "-workers") == 0 && i + 1 < argc) {
+            i += 1;
+            workers = (u32) MAX(atoi(argv[i]), 0);
+        }
+    }
+    
+    if (workers == 0) {
+        workers = os_cpu_count();
+    }
+    workers = MAX(1, MIN(workers, BATCH_MAX_WORKERS));
+    
+    os_main_init();
+    r_backend_init_ex(software);
+    
+    Arena *arena = arena_make();
+    Arena *frame_arena = arena_make();
+    
+    er_accum_start();
+    
+    graph_init(arena, { BATCH_DEFAULT_WIDTH, BATCH_DEFAULT_HEIGHT });
+    if (!font_is_init()) {
+        printf("Failed to load font, run batch from the build directory\n");
+        return 1;
+    }
+    
+    u32 item_count = 0;
+    Batch_Item *items = batch_manifest_read(arena, str8_from_cstr(argv[1]), &item_count);
+    if (item_count == 0) {
+        printf("Nothing to draw\n");
+        return 1;
+    }
+    
+    // @Note: Jobs only go to workers that are running, if none are there's nobody to load and encode.
+    batch.wake = os_semaphore_create(0);
+    for (u32 i = 0; i < workers; ++i) {
+        Batch_Worker *worker = batch.workers + batch.worker_count;
+        worker->batch = &batch;
+        worker->wake = os_semaphore_create(0);
+        worker->arena = arena_make();
+        for (u32 j = 0; j < BATCH_WORKER_JOBS; ++j) {
+            worker->jobs[j].arena = arena_make();
+        }
+        
+        if (!os_thread_start(&worker->thread, batch_worker_thread, worker)) {
+            os_semaphore_destroy(worker->wake);
+            arena_release(worker->arena);
+            for (u32 j = 0; j < BATCH_WORKER_JOBS; ++j) {
+                arena_release(worker->jobs[j].arena);
+            }
+            break;
+        }
+        batch.worker_count += 1;
+    }
+    
+    if (batch.worker_count == 0) {
+        printf("Failed to start workers\n");
+        return 1;
+    }
+    
+    // @Note: Throughput is counted in frames when everything is a sequence, a picture is a frame too.
+    u32 frame_count = 0;
+    b32 sequences = 1;
+    for (u32 i = 0; i < item_count; ++i) {
+        frame_count += items[i].frames;
+        sequences = sequences && (items[i].frames > 1);
+    }
+    const char *unit = sequences ? "frames" : "pictures";
+    
+    printf("%u %s on %u workers%s\n", sequences ? frame_count : item_count, unit, batch.worker_count,
+           software ? ", software rasterizer" : "");
+    
+    u32 next_item = 0;
+    u32 next_frame = 0;
+    u32 finished = 0;
+    u32 failed = 0;
+    f64 load_ms = 0.0;
+    f64 draw_ms = 0.0;
+    f64 encode_ms = 0.0;
+    
+    f64 start = os_ticks_now();
+    f64 last_report = start;
+    while (finished < frame_count) {
+        b32 progress = 0;
+        Batch_Job *waiting = 0;
+        Batch_Worker *waiting_worker = 0;
+        
+        for (u32 i = 0; i < batch.worker_count; ++i) {
+            Batch_Worker *worker = batch.workers + i;
+            for (u32 j = 0; j < BATCH_WORKER_JOBS; ++j) {
+                Batch_Job *job = worker->jobs + j;
+                switch (AtomicLoadU32(&job->state)) {
+                    case BATCH_JOB_FREE: {
+                        // @Note: The first frame of an item loads its series, the rest wait until it's
+                        // there. Once it failed the frames left aren't drawn.
+                        Batch_Item *item = (next_item < item_count) ? items + next_item : 0;
+                        if (item && next_frame > 0 && item->failed) {
+                            u32 skipped = item->frames - next_frame;
+                            finished += skipped;
+                            failed += skipped;
+                            batch_item_done(item, skipped);
+                            next_item += 1;
+                            next_frame = 0;
+                            progress = 1;
+                        } else if (item && (next_frame == 0 || item->loaded)) {
+                            job->item = item;
+                            job->frame = next_frame;
+                            job->failed = 0;
+                            job->converted = 0;
+                            job->output = item->output;
+                            if (item->frames > 1 && !item->y4m) {
+                                job->output = batch_frame_path(job->arena, item->output, next_frame);
+                            }
+                            
+                            u32 next_state = BATCH_JOB_LOADED;
+                            if (next_frame == 0) {
+                                item->arena = arena_make();
+                                next_state = BATCH_JOB_LOADING;
+                            }
+                            
+                            next_frame += 1;
+                            if (next_frame == item->frames) {
+                                next_item += 1;
+                                next_frame = 0;
+                            }
+                            
+                            AtomicStoreU32(&job->state, next_state);
+                            if (next_state == BATCH_JOB_LOADING) {
+                                os_semaphore_signal(worker->wake);
+                            }
+                            progress = 1;
+                        }
+                    } break;
+                    
+                    case BATCH_JOB_LOADED: {
+                        // @Note: The stream is opened once there's something to put in it.
+                        Batch_Item *item = job->item;
+                        if (job->frame == 0 && item->y4m) {
+                            item->streaming = image_y4m_begin(&item->stream, item->arena, item->output,
+                                                              item->width, item->height, item->fps);
+                        }
+                        item->loaded = !item->y4m || item->streaming;
+                        
+                        f64 draw_start = os_ticks_now();
+                        b32 drawn = item->loaded && batch_draw(job, frame_arena);
+                        draw_ms += os_ticks_now() - draw_start;
+                        
+                        job->failed = !drawn;
+                        AtomicStoreU32(&job->state, drawn ? BATCH_JOB_READBACK : BATCH_JOB_DONE);
+                        progress = 1;
+                    } break;
+                    
+                    case BATCH_JOB_READBACK: {
+                        job->pixels = r_target_map(job->target, &job->pitch);
+                        if (job->pixels) {
+                            AtomicStoreU32(&job->state, BATCH_JOB_ENCODING);
+                            os_semaphore_signal(worker->wake);
+                            progress = 1;
+                        } else if (waiting == 0) {
+                            waiting = job;
+                            waiting_worker = worker;
+                        }
+                    } break;
+                    
+                    case BATCH_JOB_DONE: {
+                        Batch_Item *item = job->item;
+                        if (job->pixels) {
+                            r_target_unmap(job->target);
+                            job->pixels = 0;
+                        }
+                        
+                        // @Note: Stream frames can come back out of order, a later one waits for its turn.
+                        if (item->streaming) {
+                            if (job->frame != item->frames_written) break;
+                            
+                            if (!job->failed) {
+                                image_y4m_frame(&item->stream, job->converted);
+                            }
+                            item->frames_written += 1;
+                        }
+                        
+                        if (job->failed) {
+                            if (job->frame == 0 && !item->loaded) {
+                                item->failed = 1;
+                            }
+                            
+                            if (item->frames > 1) {
+                                printf("Failed: %.*s -> %.*s, frame %u\n", (int) item->input.size, item->input.data,
+                                       (int) item->output.size, item->output.data, job->frame);
+                            } else {
+                                printf("Failed: %.*s -> %.*s\n", (int) item->input.size, item->input.data,
+                                       (int) item->output.size, item->output.data);
+                            }
+                            failed += 1;
+                        }
+                        
+                        load_ms += job->load_ms;
+                        encode_ms += job->encode_ms;
+                        job->load_ms = 0.0;
+                        job->encode_ms = 0.0;
+                        arena_clear(job->arena);
+                        batch_item_done(item, 1);
+                        
+                        finished += 1;
+                        AtomicStoreU32(&job->state, BATCH_JOB_FREE);
+                        progress = 1;
+                    } break;
+                }
+            }
+        }
+        
+        // @Note: Nothing to do here, so block on whatever comes first. A copy still in flight can be
+        // waited on directly, otherwise every job is with a worker and one of them will signal.
+        if (!progress) {
+            if (waiting) {
+                waiting->pixels = r_target_map_ex(waiting->target, &waiting->pitch, 1);
+                waiting->failed = (waiting->pixels == 0);
+                AtomicStoreU32(&waiting->state, waiting->pixels ? BATCH_JOB_ENCODING : BATCH_JOB_DONE);
+                os_semaphore_signal(waiting_worker->wake);
+            } else {
+                os_semaphore_wait(batch.wake);
+            }
+        }
+        
+        f64 now = os_ticks_now();
+        if (now - last_report >= BATCH_REPORT_MS) {
+            printf("%u/%u, %.1f %s/s\n", finished, frame_count, finished*1000.0/(now - start), unit);
+            last_report = now;
+        }
+    }
+    f64 total_ms = os_ticks_now() - start;
+    
+    AtomicStoreU32(&batch.quit, 1);
+    for (u32 i = 0; i < batch.worker_count; ++i) {
+        os_semaphore_signal(batch.workers[i].wake);
+    }
+    
+    for (u32 i = 0; i < batch.worker_count; ++i) {
+        Batch_Worker *worker = batch.workers + i;
+        os_thread_join(&worker->thread);
+        os_semaphore_destroy(worker->wake);
+        
+        for (u32 j = 0; j < BATCH_WORKER_JOBS; ++j) {
+            if (worker->jobs[j].target) {
+                r_target_destroy(worker->jobs[j].target);
+            }
+            arena_release(worker->jobs[j].arena);
+        }
+        arena_release(worker->arena);
+    }
+    os_semaphore_destroy(batch.wake);
+    
+    String8 errors = er_accum_end(arena);
+    if (errors.size > 0) {
+        printf("Errors: %.*s\n", (int) errors.size, errors.data);
+    }
+    
+    printf("%u pictures, %u frames, %u failed, %.2f s, %.1f %s/s\n",
+           item_count, frame_count, failed, total_ms/1000.0, frame_count*1000.0/MAX(total_ms, 1e-3), unit);
+    printf("per frame: load %.3f ms, draw %.3f ms, encode %.3f ms\n",
+           load_ms/frame_count, draw_ms/frame_count, encode_ms/frame_count);
+    
+    font_end(&state.font);
+    arena_release(frame_arena);
+    arena_release(arena);
+    
+    r_backend_end();
+    
+    return (failed > 0) ? 1 : 0;
+}
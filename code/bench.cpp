@@ -0,0 +1,427 @@
+#define R_BACKEND_NULL 1
+#define FONT_USE_FREETYPE 1
+
+// @Note: Drives the real frame code (r_graph, font, render helpers) on top of the null
+// render backend, so the numbers are CPU-side cost only, without any driver time.
+
+#define BENCH_WIDTH 1280
+#define BENCH_HEIGHT 720
+#define BENCH_MIN_EXP 3
+#define BENCH_MAX_EXP 8
+#define BENCH_MIN_MS 500.0
+#define BENCH_PACK_COUNT 10000
+#define BENCH_FONT_SIZE 32
+#define BENCH_IMAGE_WIDTH 3840
+#define BENCH_IMAGE_HEIGHT 2160
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <HandmadeMath.h>
+#include <optick.h>
+
+#include <ft2build.h>
+#include <freetype/freetype.h>
+#include <freetype/ftmodapi.h>
+#include <freetype/ftoutln.h>
+
+// @Note: Only here to compare the JPEG and PNG writers against
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+#include "./base/base_inc.h"
+#include "./os/os_inc.h"
+#include "./gfx/gfx_inc.h"
+#include "./render/render_inc.h"
+#include "./font/font_inc.h"
+#include "./image/image_inc.h"
+#include "./graph/graph_inc.h"
+
+#include "./base/base_inc.c"
+#include "./os/os_inc.c"
+#include "./gfx/gfx_inc.c"
+#include "./render/render_inc.c"
+#include "./font/font_inc.c"
+#include "./image/image_inc.c"
+#include "./graph/graph_inc.c"
+
+internal void bench_fill_data(Graph_Data *data, f32 *xs, f32 *ys, u32 size)
+{
+    // @Note: Deterministic spread of points roughly over the default view,
+    // cheap LCG so that every run sees the same data.
+    u32 seed = 0x12345678;
+    for (u32 i = 0; i < size; ++i) {
+        seed = seed*1664525 + 1013904223;
+        f32 t = (f32) (seed >> 8)/(f32) (1 << 24);
+        
+        xs[i] = -8.0f + 16.0f*((f32) i/(f32) size);
+        ys[i] = -4.0f + 8.0f*t;
+    }
+    
+    data->xs = xs;
+    data->ys = ys;
+    data->size = size;
+}
+
+internal void bench_run(Arena *frame_arena, u32 size)
+{
+    HMM_Vec2 window_size = { BENCH_WIDTH, BENCH_HEIGHT };
+    
+    r_null_stats_reset();
+    
+    u32 frames = 0;
+    f64 total_ms = 0.0;
+    while (frames == 0 || (total_ms < BENCH_MIN_MS && frames < 1000)) {
+        arena_clear(frame_arena);
+        
+        f64 start = os_ticks_now();
+        {
+            graph_fit_limits(window_size);
+            
+            R_List list = {0};
+            R_Ctx ctx = r_make_context(frame_arena, &list, GRAPH_LAYER_PLOT);
+            R_Ctx ui_ctx = r_make_context(frame_arena, &list, GRAPH_LAYER_UI);
+            
+            r_frame_begin(0, 0x121212FF);
+            r_graph(window_size, &ctx, &ui_ctx, state.light_mode);
+            r_flush_batches(0, &list);
+            r_frame_end(0);
+            font_next_frame(&state.font);
+        }
+        total_ms += os_ticks_now() - start;
+        frames += 1;
+    }
+    
+    Null_Stats stats = r_null_stats_get();
+    f64 ns_per_point = (total_ms*1e6)/((f64) frames*(f64) size);
+    f64 batches_per_frame = (f64) stats.batch_count/(f64) frames;
+    f64 mb_per_frame = ((f64) stats.bytes/(f64) frames)/(1024.0*1024.0);
+    
+    printf("%12u | %6u | %10.3f | %10.3f | %8.1f | %10.2f\n",
+           size, frames, total_ms/frames, ns_per_point, batches_per_frame, mb_per_frame);
+}
+
+internal void bench_runs(Font *font)
+{
+    // @Note: Every label lookup counts, both from measuring and from drawing.
+    Font_Run_Stats stats = font->run_stats;
+    u64 total = stats.hits + stats.misses + stats.uncached;
+    f64 hit_rate = total ? 100.0*(f64) stats.hits/(f64) total : 0.0;
+    printf("\nText runs: %llu hits, %llu misses, %llu uncached, %llu expired (%.2f%% hit rate)\n",
+           (unsigned long long) stats.hits, (unsigned long long) stats.misses,
+           (unsigned long long) stats.uncached, (unsigned long long) stats.expired, hit_rate);
+    
+    // @Note: Zero when the font came from the cache and nothing past it was needed yet.
+    Font_Memory memory = font_memory(font);
+    printf("Font provider memory: %.1f KB taken, %.1f KB live, %.1f KB peak\n",
+           (f64) memory.used/1024.0, (f64) memory.live/1024.0, (f64) memory.peak/1024.0);
+}
+
+internal void bench_pack(Arena *arena, u32 glyph_size)
+{
+    Arena_Temp temp = arena_temp_begin(arena);
+    u32 *ws = arena_push_array(temp.arena, u32, BENCH_PACK_COUNT);
+    u32 *hs = arena_push_array(temp.arena, u32, BENCH_PACK_COUNT);
+    
+    // @Note: Glyph-like boxes, narrower than tall, same LCG as the point data.
+    u64 area = 0;
+    u32 seed = 0x12345678;
+    for (u32 i = 0; i < BENCH_PACK_COUNT; ++i) {
+        seed = seed*1664525 + 1013904223;
+        ws[i] = 1 + (u32) (glyph_size*(0.3f + 0.4f*(f32) ((seed >> 8) & 0xFF)/255.0f));
+        hs[i] = 1 + (u32) (glyph_size*(0.4f + 0.6f*(f32) ((seed >> 16) & 0xFF)/255.0f));
+        area += (u64) ws[i]*hs[i];
+    }
+    
+    u32 width = 64;
+    while ((u64) width*width < area) width *= 2;
+    
+    R_Skyline sky = {0};
+    R_Skyline_Node *nodes = arena_push_array(temp.arena, R_Skyline_Node, width);
+    r_skyline_init(&sky, nodes, width, width, 0xFFFFFFFF/2);
+    
+    u32 passes = 0;
+    f64 total_ms = 0.0;
+    while (passes == 0 || (total_ms < BENCH_MIN_MS && passes < 100)) {
+        r_skyline_reset(&sky);
+        
+        f64 start = os_ticks_now();
+        for (u32 i = 0; i < BENCH_PACK_COUNT; ++i) {
+            u32 x = 0;
+            u32 y = 0;
+            b32 packed = r_skyline_pack(&sky, ws[i], hs[i], &x, &y);
+            Assert(packed);
+        }
+        total_ms += os_ticks_now() - start;
+        passes += 1;
+    }
+    
+    f64 ns_per_rect = (total_ms*1e6)/((f64) passes*BENCH_PACK_COUNT);
+    printf("%12u | %6u | %5ux%-5u | %10.1f | %9.1f%%\n",
+           glyph_size, BENCH_PACK_COUNT, width, r_skyline_top(&sky), ns_per_rect, 100.0f*r_skyline_efficiency(&sky));
+    
+    arena_temp_end(&temp);
+}
+
+internal void bench_font_build(Arena *arena, String8 prebuilt, u32 glyph_count, u32 workers)
+{
+    Arena_Temp temp = arena_temp_begin(arena);
+    
+    // @Note: Always a full build, the disk cache would turn every run after the first into a load.
+    f64 start = os_ticks_now();
+    Font font = freetype_font_init(temp.arena, str8("./Inconsolata-Regular.ttf"), BENCH_FONT_SIZE, 96, FONT_RASTER_COVERAGE, prebuilt, workers, 0);
+    f64 ms = os_ticks_now() - start;
+    
+    // @Note: The face the build keeps, the workers' own are gone by now.
+    Font_Memory memory = font_memory(&font);
+    printf("%12u | %6u | %7u | %10.2f | %5ux%-5u | %10.1f\n",
+           workers, glyph_count, BENCH_FONT_SIZE, ms, font.atlas.width, font.atlas.height, (f64) memory.peak/1024.0);
+    
+    font_end(&font);
+    arena_temp_end(&temp);
+}
+
+internal void bench_image_fill(u8 *pixels, u32 width, u32 height, b32 noise)
+{
+    // @Note: Something plot-like, a flat background with grid lines and a few thousand markers
+    // along noisy curves, plus a noisy strip at the bottom so there's detail the quantizer has to keep.
+    // The strip is left out for PNG, a lossless plot doesn't have any.
+    u32 *out = (u32 *) pixels;
+    for (u32 y = 0; y < height; ++y) {
+        for (u32 x = 0; x < width; ++x) {
+            b32 grid = (x % 80) == 0 || (y % 80) == 0;
+            out[y*width + x] = grid ? 0xFF3A3A3A : 0xFF121212;
+        }
+    }
+    
+    u32 colors[] = { 0xFF3D8BF0, 0xFF30C060, 0xFF2040E0, 0xFFE0A020 };
+    u32 seed = 0x12345678;
+    for (u32 i = 0; i < 20000; ++i) {
+        seed = seed*1664525 + 1013904223;
+        u32 x = (i*7) % width;
+        f32 t = (f32) (seed >> 8)/(f32) (1 << 24);
+        u32 y = (u32) ((0.5f + 0.3f*HMM_SinF(0.004f*(f32) x + (f32) (i % 4)) + 0.05f*(t - 0.5f))*(f32) height);
+        for (u32 dy = 0; dy < 5; ++dy) {
+            for (u32 dx = 0; dx < 5; ++dx) {
+                if (x + dx < width && y + dy < height) {
+                    out[(y + dy)*width + x + dx] = colors[i % ARRAY_SIZE(colors)];
+                }
+            }
+        }
+    }
+    
+    for (u32 y = height - height/10; noise && y < height; ++y) {
+        for (u32 x = 0; x < width; ++x) {
+            seed = seed*1664525 + 1013904223;
+            out[y*width + x] = 0xFF000000 | (seed >> 8);
+        }
+    }
+}
+
+internal void bench_image_stb_write(void *context, void *data, int size)
+{
+    image_file_write((Image_File *) context, data, (usize) size);
+}
+
+internal void bench_jpeg(Arena *arena, u8 *pixels, u32 quality, Image_Subsampling subsampling, u32 workers, b32 stb, b32 avx2)
+{
+    Arena_Temp temp = arena_temp_begin(arena);
+    
+    // @Note: Both write through an Image_File, so the file side costs the same.
+    String8 path = stb ? str8("./bench_stb.jpg") : str8("./bench.jpg");
+    f64 start = os_ticks_now();
+    u64 bytes = 0;
+    if (stb) {
+        Image_File file = {0};
+        image_file_open(&file, temp.arena, path);
+        stbi_write_jpg_to_func(bench_image_stb_write, &file, BENCH_IMAGE_WIDTH, BENCH_IMAGE_HEIGHT, 4, pixels, (s32) quality);
+        image_file_close(&file);
+        bytes = file.bytes_written;
+    } else {
+        Image_Writer writer = {0};
+        Image_Options options = { quality, subsampling, workers };
+        image_writer_begin_ex(&writer, temp.arena, path, IMAGE_FORMAT_JPEG, BENCH_IMAGE_WIDTH, BENCH_IMAGE_HEIGHT, options);
+        writer.jpeg->avx2 = writer.jpeg->avx2 && avx2; // @Note: Rows haven't started, so the switch is safe
+        image_writer_rows(&writer, pixels, BENCH_IMAGE_HEIGHT, BENCH_IMAGE_WIDTH*4);
+        image_writer_end(&writer);
+        bytes = writer.file.bytes_written;
+    }
+    f64 ms = os_ticks_now() - start;
+    
+    const char *sampling_names[] = { "4:4:4", "4:2:2", "4:2:0" };
+    printf("%12s | %7u | %8s | %7u | %10.2f | %10.1f\n",
+           stb ? "stb" : (avx2 ? "avx2" : "scalar"), quality, sampling_names[subsampling], workers, ms, (f64) bytes/1024.0);
+    
+    arena_temp_end(&temp);
+}
+
+internal void bench_png(Arena *arena, u8 *pixels, u8 *rgb, u32 workers, b32 stb, b32 avx2)
+{
+    Arena_Temp temp = arena_temp_begin(arena);
+    
+    // @Note: stb gets the picture packed to RGB up front, so both write the same 24 bit file.
+    String8 path = stb ? str8("./bench_stb.png") : str8("./bench.png");
+    f64 start = os_ticks_now();
+    u64 bytes = 0;
+    if (stb) {
+        Image_File file = {0};
+        image_file_open(&file, temp.arena, path);
+        stbi_write_png_to_func(bench_image_stb_write, &file, BENCH_IMAGE_WIDTH, BENCH_IMAGE_HEIGHT, 3, rgb, BENCH_IMAGE_WIDTH*3);
+        image_file_close(&file);
+        bytes = file.bytes_written;
+    } else {
+        Image_Writer writer = {0};
+        Image_Options options = { 0, IMAGE_SUBSAMPLING_444, workers };
+        image_writer_begin_ex(&writer, temp.arena, path, IMAGE_FORMAT_PNG, BENCH_IMAGE_WIDTH, BENCH_IMAGE_HEIGHT, options);
+        writer.png->avx2 = writer.png->avx2 && avx2; // @Note: Rows haven't started, so the switch is safe
+        image_writer_rows(&writer, pixels, BENCH_IMAGE_HEIGHT, BENCH_IMAGE_WIDTH*4);
+        image_writer_end(&writer);
+        bytes = writer.file.bytes_written;
+    }
+    f64 ms = os_ticks_now() - start;
+    
+    printf("%12s | %7u | %10.2f | %10.1f\n", stb ? "stb" : (avx2 ? "avx2" : "scalar"), workers, ms, (f64) bytes/1024.0);
+    
+    arena_temp_end(&temp);
+}
+
+int main(int argc, char **argv)
+{
+    u32 max_exp = BENCH_MAX_EXP;
+    if (argc > 1) {
+        max_exp = (u32) atoi(argv[1]);
+        max_exp = MAX(max_exp, BENCH_MIN_EXP);
+        max_exp = MIN(max_exp, 9); // @Note: u32 point count
+    }
+    
+    os_main_init();
+    r_backend_init();
+    
+    Arena *arena = arena_make();
+    Arena *frame_arena = arena_make();
+    
+    graph_init(arena, { BENCH_WIDTH, BENCH_HEIGHT });
+    if (!font_is_init()) {
+        printf("Failed to load font, run the benchmark from the build directory\n");
+        return 1;
+    }
+    
+    printf("%12s | %6s | %10s | %10s | %8s | %10s\n",
+           "points", "frames", "ms/frame", "ns/point", "batches", "MB/frame");
+    
+    u32 size = 1;
+    for (u32 i = 0; i < BENCH_MIN_EXP; ++i) size *= 10;
+    
+    for (u32 e = BENCH_MIN_EXP; e <= max_exp; ++e) {
+        Arena_Temp temp = arena_temp_begin(arena);
+        f32 *xs = arena_push_array(temp.arena, f32, size);
+        f32 *ys = arena_push_array(temp.arena, f32, size);
+        
+        bench_fill_data(&state.graph_data, xs, ys, size);
+        bench_run(frame_arena, size);
+        
+        arena_temp_end(&temp);
+        size *= 10;
+    }
+    
+    bench_runs(&state.font);
+    
+    printf("\n%12s | %6s | %11s | %10s | %10s\n",
+           "glyph size", "rects", "atlas", "ns/rect", "efficiency");
+    
+    u32 glyph_sizes[] = { 8, 16, 32, 64 };
+    for (u32 i = 0; i < ARRAY_SIZE(glyph_sizes); ++i) {
+        bench_pack(arena, glyph_sizes[i]);
+    }
+    
+    font_end(&state.font);
+    
+    printf("\n%12s | %6s | %7s | %10s | %11s | %10s\n",
+           "workers", "glyphs", "size", "build ms", "atlas", "face KB");
+    
+    // @Note: Latin-1 up to Latin Extended-B, Greek and Cyrillic, everything past ASCII that the font has.
+    {
+        Arena_Temp temp = arena_temp_begin(arena);
+        u32 ranges[][2] = { { 0xA0, 0x250 }, { 0x370, 0x400 }, { 0x400, 0x500 } };
+        String8 prebuilt = str8_alloc(temp.arena, 2*0x500);
+        prebuilt.size = 0;
+        
+        u32 glyph_count = FONT_GLYPH_COUNT;
+        for (u32 r = 0; r < ARRAY_SIZE(ranges); ++r) {
+            for (u32 codepoint = ranges[r][0]; codepoint < ranges[r][1]; ++codepoint) {
+                prebuilt.data[prebuilt.size++] = (u8) (0xC0 | (codepoint >> 6));
+                prebuilt.data[prebuilt.size++] = (u8) (0x80 | (codepoint & 0x3F));
+                glyph_count += 1;
+            }
+        }
+        
+        u32 cpus = os_cpu_count();
+        for (u32 workers = 1; workers <= cpus && workers <= FONT_BUILD_MAX_WORKERS; workers *= 2) {
+            bench_font_build(arena, prebuilt, glyph_count, workers);
+        }
+        
+        if (!IS_POW2(cpus) && cpus <= FONT_BUILD_MAX_WORKERS) {
+            bench_font_build(arena, prebuilt, glyph_count, cpus);
+        }
+        
+        arena_temp_end(&temp);
+    }
+    
+    printf("\n%12s | %7s | %8s | %7s | %10s | %10s\n",
+           "jpeg", "quality", "sampling", "workers", "encode ms", "KB");
+    
+    // @Note: stb subsamples to 4:2:0 at quality 90 and below and keeps full color above, each of ours is
+    // run the same way next to it. Scalar and AVX2 should come out the same size, they give the same bits.
+    {
+        Arena_Temp temp = arena_temp_begin(arena);
+        u8 *pixels = arena_push_array(temp.arena, u8, (usize) BENCH_IMAGE_WIDTH*BENCH_IMAGE_HEIGHT*4);
+        bench_image_fill(pixels, BENCH_IMAGE_WIDTH, BENCH_IMAGE_HEIGHT, 1);
+        
+        u32 qualities[] = { 90, 100 };
+        for (u32 q = 0; q < ARRAY_SIZE(qualities); ++q) {
+            u32 quality = qualities[q];
+            Image_Subsampling subsampling = quality <= 90 ? IMAGE_SUBSAMPLING_420 : IMAGE_SUBSAMPLING_444;
+            bench_jpeg(arena, pixels, quality, subsampling, 1, 1, 0);
+            bench_jpeg(arena, pixels, quality, subsampling, 1, 0, 0);
+            bench_jpeg(arena, pixels, quality, subsampling, 1, 0, 1);
+            
+            u32 cpus = MIN(os_cpu_count(), IMAGE_JPEG_MAX_WORKERS);
+            if (cpus > 1) {
+                bench_jpeg(arena, pixels, quality, subsampling, cpus, 0, 1);
+            }
+        }
+        
+        arena_temp_end(&temp);
+    }
+    
+    printf("\n%12s | %7s | %10s | %10s\n", "png", "workers", "encode ms", "KB");
+    
+    {
+        Arena_Temp temp = arena_temp_begin(arena);
+        u8 *pixels = arena_push_array(temp.arena, u8, (usize) BENCH_IMAGE_WIDTH*BENCH_IMAGE_HEIGHT*4);
+        u8 *rgb = arena_push_array(temp.arena, u8, (usize) BENCH_IMAGE_WIDTH*BENCH_IMAGE_HEIGHT*3);
+        bench_image_fill(pixels, BENCH_IMAGE_WIDTH, BENCH_IMAGE_HEIGHT, 0);
+        for (usize i = 0; i < (usize) BENCH_IMAGE_WIDTH*BENCH_IMAGE_HEIGHT; ++i) {
+            rgb[i*3 + 0] = pixels[i*4 + 0];
+            rgb[i*3 + 1] = pixels[i*4 + 1];
+            rgb[i*3 + 2] = pixels[i*4 + 2];
+        }
+        
+        bench_png(arena, pixels, rgb, 1, 1, 0);
+        bench_png(arena, pixels, rgb, 1, 0, 0);
+        bench_png(arena, pixels, rgb, 1, 0, 1);
+        
+        u32 cpus = MIN(os_cpu_count(), IMAGE_PNG_MAX_WORKERS);
+        if (cpus > 1) {
+            bench_png(arena, pixels, rgb, cpus, 0, 1);
+        }
+        
+        arena_temp_end(&temp);
+    }
+    arena_release(frame_arena);
+    arena_release(arena);
+    
+    r_backend_end();
+    
+    return 0;
+}
@@ -0,0 +1,216 @@
+internal CSV_Reader csv_reader_make(String8 data)
+{
+    CSV_Reader result = {0};
+    result.data = data;
+    return(result);
+}
+
+internal b32 csv_next_field(CSV_Reader *reader, String8 *field, b32 *line_end)
+{
+    u8 *data = reader->data.data;
+    usize size = reader->data.size;
+    usize pos = reader->pos;
+    if (pos >= size) {
+        return(0);
+    }
+    
+    usize start = pos;
+    usize end = pos;
+    if (data[pos] == '"') {
+        start = pos + 1;
+        for (pos = start; pos < size; ++pos) {
+            if (data[pos] == '"') {
+                if (pos + 1 < size && data[pos + 1] == '"') {
+                    pos += 1;
+                } else {
+                    break;
+                }
+            }
+        }
+        
+        // @Note: Anything between the closing quote and the separator is dropped.
+        end = pos;
+        while (pos < size && data[pos] != ',' && data[pos] != '\n') {
+            pos += 1;
+        }
+    } else {
+        while (pos < size && data[pos] != ',' && data[pos] != '\n') {
+            pos += 1;
+        }
+        
+        end = pos;
+        if (end > start && data[end - 1] == '\r') {
+            end -= 1;
+        }
+    }
+    
+    *field = str8_make(data + start, end - start);
+    *line_end = (pos >= size || data[pos] == '\n');
+    reader->pos = pos + 1;
+    
+    return(1);
+}
+
+internal b32 csv_parse_f64(String8 str, f64 *out)
+{
+    u8 *at = str.data;
+    u8 *end = str.data + str.size;
+    while (at < end && (*at == ' ' || *at == '\t')) at += 1;
+    while (end > at && (end[-1] == ' ' || end[-1] == '\t')) end -= 1;
+    
+    f64 sign = 1.0;
+    if (at < end && (*at == '-' || *at == '+')) {
+        sign = (*at == '-') ? -1.0 : 1.0;
+        at += 1;
+    }
+    
+    // @Note: Digits past what fits the mantissa only move the exponent.
+    const u64 mantissa_max = 100000000000000000ull;
+    u64 mantissa = 0;
+    s32 exponent = 0;
+    u32 digits = 0;
+    for (; at < end && BETWEEN(*at, '9', '0'); ++at, ++digits) {
+        if (mantissa < mantissa_max) {
+            mantissa = mantissa*10 + (*at - '0');
+        } else {
+            exponent += 1;
+        }
+    }
+    
+    if (at < end && *at == '.') {
+        for (at += 1; at < end && BETWEEN(*at, '9', '0'); ++at, ++digits) {
+            if (mantissa < mantissa_max) {
+                mantissa = mantissa*10 + (*at - '0');
+                exponent -= 1;
+            }
+        }
+    }
+    
+    b32 error = (digits == 0);
+    if (!error && at < end && (*at == 'e' || *at == 'E')) {
+        at += 1;
+        s32 exponent_sign = 1;
+        if (at < end && (*at == '-' || *at == '+')) {
+            exponent_sign = (*at == '-') ? -1 : 1;
+            at += 1;
+        }
+        
+        s32 value = 0;
+        u32 exponent_digits = 0;
+        for (; at < end && BETWEEN(*at, '9', '0'); ++at, ++exponent_digits) {
+            value = MIN(value*10 + (*at - '0'), 1000);
+        }
+        
+        error = (exponent_digits == 0);
+        exponent += exponent_sign*value;
+    }
+    
+    error = error || (at != end);
+    if (!error) {
+        // @Note: Powers of ten are exact up to 1e22, which covers anything written by hand or with %f.
+        // Past that this can be a bit off, it's fine for plotting.
+        f64 scale = 1.0;
+        for (s32 i = 0; i < MIN(exponent < 0 ? -exponent : exponent, 400); ++i) {
+            scale *= 10.0;
+        }
+        
+        f64 value = (f64) mantissa;
+        value = (exponent < 0) ? value/scale : value*scale;
+        *out = sign*value;
+    }
+    
+    b32 result = !error;
+    return(result);
+}
+
+internal b32 csv_table_read(CSV_Table *table, Arena *arena, String8 data)
+{
+    MemoryZero(table, sizeof(*table));
+    
+    // @Note: There are never more records than lines, so the columns can be allocated up front.
+    u32 line_count = 1;
+    for (usize i = 0; i < data.size; ++i) {
+        line_count += (data.data[i] == '\n');
+    }
+    
+    CSV_Reader reader = csv_reader_make(data);
+    String8 field = {0};
+    b32 line_end = 0;
+    
+    // @Note: The header is the first line that isn't empty, read twice to count and then keep the names.
+    CSV_Reader header = reader;
+    u32 column_count = 0;
+    while (column_count == 0 && csv_next_field(&reader, &field, &line_end)) {
+        if (line_end && field.size == 0) {
+            header = reader;
+            continue;
+        }
+        
+        column_count = 1;
+        while (!line_end && csv_next_field(&reader, &field, &line_end)) {
+            column_count += 1;
+        }
+    }
+    
+    b32 error = 0;
+    if (column_count == 0) {
+        er_push(str8("CSV has no header"));
+        error = 1;
+    }
+    
+    if (!error) {
+        table->column_count = column_count;
+        table->names = arena_push_array(arena, String8, column_count);
+        table->columns = arena_push_array(arena, f32 *, column_count);
+        for (u32 i = 0; i < column_count; ++i) {
+            csv_next_field(&header, &field, &line_end);
+            table->names[i] = field;
+            table->columns[i] = (f32 *) arena_push_no_zero(arena, sizeof(f32)*line_count);
+        }
+        
+        u32 row = 0;
+        u32 column = 0;
+        while (csv_next_field(&reader, &field, &line_end)) {
+            if (column == 0 && line_end && field.size == 0) {
+                continue;
+            }
+            
+            if (column < column_count) {
+                f64 value = 0.0;
+                table->columns[column][row] = csv_parse_f64(field, &value) ? (f32) value : NAN;
+            }
+            column += 1;
+            
+            if (line_end) {
+                for (; column < column_count; ++column) {
+                    table->columns[column][row] = NAN;
+                }
+                
+                row += 1;
+                column = 0;
+            }
+        }
+        
+        table->row_count = row;
+    }
+    
+    b32 result = !error;
+    return(result);
+}
+
+internal s32 csv_table_column(CSV_Table *table, String8 name)
+{
+    s32 result = -1;
+    for (u32 i = 0; i < table->column_count && result < 0; ++i) {
+        if (str8_match(table->names[i], name)) {
+            result = (s32) i;
+        }
+    }
+    
+    f64 index = 0.0;
+    if (result < 0 && csv_parse_f64(name, &index) && index >= 0.0 && index < (f64) table->column_count) {
+        result = (s32) index;
+    }
+    
+    return(result);
+}
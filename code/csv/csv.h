@@ -0,0 +1,34 @@
+#ifndef CSV_H
+#define CSV_H
+
+// @Note: Comma separated text, one record a line, \n or \r\n. A field in double quotes can hold commas
+// and line breaks, the quotes are taken off but doubled quotes inside are left as they are. Fields
+// point into the data, nothing is copied.
+typedef struct {
+    String8 data;
+    usize pos;
+} CSV_Reader;
+
+// @Note: A table of numbers under a header line, stored column by column. Fields that aren't numbers
+// (or are missing at the end of a short record) are NaN, empty lines are skipped.
+typedef struct {
+    u32 column_count;
+    u32 row_count;
+    String8 *names;
+    f32 **columns;
+} CSV_Table;
+
+internal CSV_Reader csv_reader_make(String8 data);
+
+// @Note: Returns 0 once the data is used up. 'line_end' is set when the field is the last of its record.
+internal b32 csv_next_field(CSV_Reader *reader, String8 *field, b32 *line_end);
+
+// @Note: Decimal with an optional sign, fraction and exponent, surrounding spaces are fine.
+internal b32 csv_parse_f64(String8 str, f64 *out);
+
+internal b32 csv_table_read(CSV_Table *table, Arena *arena, String8 data);
+
+// @Note: A column by its header name, or by its index when 'name' is a number that isn't a header. -1 when missing.
+internal s32 csv_table_column(CSV_Table *table, String8 name);
+
+#endif // CSV_H
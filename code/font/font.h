@@ -1,8 +1,27 @@
 #ifndef FONT_H
 #define FONT_H
 
-#define FONT_INIT_ATLAS_SIZE 128.0f
-#define FONT_GLYPH_COUNT 128
+#define FONT_GLYPH_COUNT 128 // @Note: ASCII, rasterized up front and pinned in the atlas
+#define FONT_WHITE_SIZE 4.0f
+
+// @Note: Everything past ASCII is rasterized on first use and kept in a fixed pool of glyphs,
+// once the pool or the atlas is full the least recently drawn atlas page gets evicted.
+#define FONT_GLYPH_CACHE_SIZE 1024
+#define FONT_GLYPH_BUCKET_COUNT 256
+
+// @Note: Atlas is sized to hold roughly this many max-sized glyphs per side
+#define FONT_ATLAS_CELLS 12
+#define FONT_ATLAS_MAX_SIZE 4096
+
+// @Note: Distance in pixels an SDF glyph's field reaches past its outline, FreeType's default
+#define FONT_SDF_SPREAD 8
+
+// @Note: Coverage is crisp at the size it was built for. SDF is built once and drawn at any
+// scale through R_SAMPLE_SDF, so a single font can serve several label sizes.
+typedef enum {
+    FONT_RASTER_COVERAGE = 0,
+    FONT_RASTER_SDF,
+} Font_Raster;
 
 typedef struct {
     HMM_Vec2 size;
@@ -12,21 +31,106 @@ typedef struct {
     f32 advance;
 } Font_Glyph_Info;
 
+typedef struct Font_Glyph {
+    struct Font_Glyph *next;
+    
+    u32 codepoint;
+    R_Atlas_Region region; // @Note: Zero width means the glyph takes no space in the atlas
+    Font_Glyph_Info info;
+} Font_Glyph;
+
+// @Note: Laid out strings, so labels drawn every frame are one bulk copy of their quads.
+// Runs are keyed by (string, scale) inside of a font, strings longer than FONT_RUN_MAX_BYTES
+// or with more glyphs than FONT_RUN_MAX_GLYPHS are always laid out on the spot.
+#define FONT_RUN_COUNT 256
+#define FONT_RUN_BUCKET_COUNT 128
+#define FONT_RUN_MAX_BYTES 32
+#define FONT_RUN_MAX_GLYPHS 32
+#define FONT_RUN_EXPIRE_FRAMES 120
+
+typedef struct Font_Run {
+    struct Font_Run *next;
+    
+    u64 hash;
+    f32 scale;
+    u32 size;
+    u8 text[FONT_RUN_MAX_BYTES];
+    
+    u64 last_used;
+    u32 evictions; // @Note: Font's eviction count when laid out, any later eviction may have moved a glyph
+    u32 pages; // @Note: Bit per atlas page the glyphs sit on, those get touched on every draw
+    
+    // @Note: Relative to the (snapped) pen position, color is filled in when drawing
+    f32 width;
+    RectF32 bounds;
+    u32 quad_count;
+    R_Quad quads[FONT_RUN_MAX_GLYPHS];
+} Font_Run;
+
+typedef struct {
+    u64 hits;
+    u64 misses;
+    u64 uncached; // @Note: Too long, or no free run left
+    u64 expired;
+} Font_Run_Stats;
+
+// @Note: What the provider took for its face, blocks it frees are reused but only go back with font_end().
+typedef struct {
+    usize used; // @Note: Taken from its arena
+    usize live; // @Note: Handed out right now
+    usize peak;
+} Font_Memory;
+
 typedef struct {
     R_Texture2D *texture;
     HMM_Vec2 texture_size;
     u32 font_size;
+    u32 dpi;
+    String8 path;
+    Font_Raster raster;
+    
+    // @Note: Solid white block in the atlas, used with r_solid_set() so rects and text share batches.
+    RectF32 white_uv;
+    
+    R_Atlas atlas;
+    void *face; // @Note: Provider's handle, loaded on the first glyph that isn't prebuilt and kept alive
+    void *library;
+    void *heap; // @Note: Where the provider allocates from, see font_memory()
+    
+    // @Note: Big enough for any glyph of the face, so rasterizing never allocates
+    u32 *scratch;
+    u32 scratch_width;
+    u32 scratch_height;
 
-    // @ToDo: Make this a variable sized array?
     Font_Glyph_Info glyphs[FONT_GLYPH_COUNT];
+    
+    Font_Glyph *buckets[FONT_GLYPH_BUCKET_COUNT];
+    Font_Glyph *first_free;
+    u32 evictions;
+    
+    Font_Run *run_buckets[FONT_RUN_BUCKET_COUNT];
+    Font_Run *run_first_free;
+    Font_Run_Stats run_stats;
 } Font;
 
 internal b32 font_is_init(void);
 internal void font_end(Font *font);
 internal Font font_init(Arena *arena, String8 font_name, u32 font_size, u32 dpi);
+// @Note: Glyphs of 'prebuilt' (UTF-8, ASCII is always in) are rasterized up front and pinned like ASCII.
+internal Font font_init_ex(Arena *arena, String8 font_name, u32 font_size, u32 dpi, Font_Raster raster, String8 prebuilt);
+internal Font_Glyph_Info *font_glyph_get(Font *font, u32 codepoint);
+internal void font_next_frame(Font *font);
+internal Font_Memory font_memory(Font *font);
+internal void font_run_init(Font *font, Arena *arena);
+internal Font_Run *font_run_get(Font *font, String8 text, f32 scale);
+internal void font_run_expire(Font *font);
 internal f32 font_text_width_ex(Font *font, String8 text, f32 scale);
 internal f32 font_text_width(Font *font, String8 text);
 internal void font_r_text_ex(R_Ctx *ctx, Font *font, HMM_Vec2 pos, String8 text, u32 col, f32 scale);
 internal void font_r_text(R_Ctx *ctx, Font *font, HMM_Vec2 pos, u32 col, String8 text);
 
+// @Note: Outline of the glyph that sits at 'uv' in the atlas, as SVG path data in pixels of the glyph's
+// quad (top left is 0,0, y down) drawn at font size. 'size' is that quad's size. Empty if no glyph is there.
+internal String8 font_glyph_path(Font *font, Arena *arena, RectF32 uv, HMM_Vec2 *size);
+
 #endif // FONT_H
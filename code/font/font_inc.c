@@ -1,7 +1,7 @@
 #ifndef FONT_INC_C
 #define FONT_INC_C
 
-#include "./font/font_helper.c"
+#include "./font/font_run.c"
 
 #ifdef FONT_USE_FREETYPE
 # include "./font/freetype/freetype_font_impl.c"
@@ -2,7 +2,6 @@
 #define FONT_INC_H
 
 #include "./font/font.h"
-#include "./font/font_helper.h"
 
 #ifdef FONT_USE_FREETYPE
 # include "./font/freetype/freetype_font_impl.h"
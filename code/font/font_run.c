@@ -0,0 +1,146 @@
+internal void font_run_init(Font *font, Arena *arena)
+{
+    Font_Run *pool = arena_push_array(arena, Font_Run, FONT_RUN_COUNT);
+    for (u32 i = 0; i < FONT_RUN_COUNT; ++i) {
+        pool[i].next = font->run_first_free;
+        font->run_first_free = pool + i;
+    }
+}
+
+internal b32 font_run_layout(Font *font, Font_Run *run, String8 text, f32 scale)
+{
+    run->width = 0.0f;
+    run->quad_count = 0;
+    run->pages = 0;
+    run->evictions = font->evictions;
+    
+    b32 first = 1;
+    RectF32 bounds = {0};
+    HMM_Vec2 pos = {0};
+    
+    b32 fits = 1;
+    for (usize i = 0; i < text.size;) {
+        Str8_Decode decode = str8_decode_utf8(text.data + i, text.size - i);
+        i += decode.size;
+        
+        Font_Glyph_Info *glyph = font_glyph_get(font, decode.codepoint);
+        
+        // @Note: Blanks have nothing to draw, they only move the pen
+        if (glyph->size.X > 0.0f && glyph->size.Y > 0.0f) {
+            if (run->quad_count == FONT_RUN_MAX_GLYPHS) {
+                fits = 0;
+                break;
+            }
+            
+            RectF32 rect = {
+                pos.X + glyph->offset.X*scale, pos.Y - glyph->offset.Y*scale,
+                pos.X + (glyph->offset.X + glyph->size.X)*scale, pos.Y + (glyph->size.Y - glyph->offset.Y)*scale
+            };
+            
+            R_Quad *quad = run->quads + run->quad_count++;
+            MemoryZero(quad, sizeof(R_Quad));
+            quad->pos = rect;
+            quad->uv = glyph->uv;
+            
+            u32 page = (u32) glyph->origin.Y/font->atlas.page_height;
+            run->pages |= 1u << page;
+            
+            if (first) {
+                bounds = rect;
+                first = 0;
+            } else {
+                bounds.x0 = MIN(bounds.x0, rect.x0);
+                bounds.y0 = MIN(bounds.y0, rect.y0);
+                bounds.x1 = MAX(bounds.x1, rect.x1);
+                bounds.y1 = MAX(bounds.y1, rect.y1);
+            }
+        }
+        
+        pos.X += glyph->advance*scale;
+    }
+    
+    run->width = pos.X;
+    run->bounds = bounds;
+    
+    return(fits);
+}
+
+internal Font_Run *font_run_get(Font *font, String8 text, f32 scale)
+{
+    if (text.size > FONT_RUN_MAX_BYTES) {
+        font->run_stats.uncached += 1;
+        return(0);
+    }
+    
+    u64 hash = str8_hash(STR8_HASH_SEED, text);
+    hash = str8_hash(hash, str8_make((u8 *) &scale, sizeof(scale)));
+    u32 bucket = (u32) (hash % FONT_RUN_BUCKET_COUNT);
+    
+    Font_Run *run = 0;
+    for (Font_Run *it = font->run_buckets[bucket]; it != 0; it = it->next) {
+        if (it->hash == hash && it->scale == scale && it->size == text.size && MemoryMatch(it->text, text.data, text.size)) {
+            run = it;
+            break;
+        }
+    }
+    
+    if (run && run->evictions == font->evictions) {
+        font->run_stats.hits += 1;
+        
+        // @Note: Glyphs past ASCII have to look used, or their page could go while the quads are in flight
+        R_Atlas_Region region = {0};
+        for (u32 page = 0; page < font->atlas.page_count; ++page) {
+            if (run->pages & (1u << page)) {
+                region.page = page;
+                r_atlas_touch(&font->atlas, region);
+            }
+        }
+    } else if (run) {
+        font->run_stats.misses += 1;
+        font_run_layout(font, run, text, scale);
+    } else if (font->run_first_free) {
+        font->run_stats.misses += 1;
+        
+        run = font->run_first_free;
+        if (font_run_layout(font, run, text, scale)) {
+            font->run_first_free = run->next;
+            
+            run->hash = hash;
+            run->scale = scale;
+            run->size = (u32) text.size;
+            MemoryCopy(run->text, text.data, text.size);
+            
+            run->next = font->run_buckets[bucket];
+            font->run_buckets[bucket] = run;
+        } else {
+            font->run_stats.uncached += 1;
+            run = 0;
+        }
+    } else {
+        font->run_stats.uncached += 1;
+    }
+    
+    if (run) {
+        run->last_used = font->atlas.frame;
+    }
+    
+    return(run);
+}
+
+internal void font_run_expire(Font *font)
+{
+    for (u32 i = 0; i < FONT_RUN_BUCKET_COUNT; ++i) {
+        Font_Run **link = &font->run_buckets[i];
+        while (*link != 0) {
+            Font_Run *run = *link;
+            if (font->atlas.frame - run->last_used > FONT_RUN_EXPIRE_FRAMES) {
+                *link = run->next;
+                run->next = font->run_first_free;
+                font->run_first_free = run;
+                font->run_stats.expired += 1;
+            } else {
+                link = &run->next;
+            }
+        }
+    }
+}
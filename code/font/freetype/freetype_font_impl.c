@@ -1,96 +1,877 @@
-global b32 freetype_is_init = 0;
+// @Note: Counts the fonts that are up, a print font built next to the screen one must not take it down with it.
+global u32 freetype_init_count = 0;
 
 internal b32 font_is_init(void)
 {
-    return(freetype_is_init);
+    return(freetype_init_count > 0);
 }
 
-internal Font font_init(Arena *arena, String8 font_name, u32 font_size, u32 dpi)
+internal void freetype_glyph_evict(void *user, R_Atlas_Region region)
 {
-    Arena_Temp scratch = arena_temp_begin(arena);
-    b32 error = 0;
+    Font *font = (Font *) user;
+    font->evictions += 1;
     
-    Font_Rect_Node *root = arena_push_array(scratch.arena, Font_Rect_Node, 1);
-    root->size.X = FLT_MAX;
-    root->size.Y = FLT_MAX;
+    for (u32 i = 0; i < FONT_GLYPH_BUCKET_COUNT; ++i) {
+        Font_Glyph **link = &font->buckets[i];
+        while (*link != 0) {
+            Font_Glyph *glyph = *link;
+            if (glyph->region.width != 0 && glyph->region.page == region.page) {
+                *link = glyph->next;
+                glyph->next = font->first_free;
+                font->first_free = glyph;
+            } else {
+                link = &glyph->next;
+            }
+        }
+    }
+}
 
-    FT_Library ft = {0};
-    if (FT_Init_FreeType(&ft) != 0) {
-        error = 1;
+internal Freetype_Heap *freetype_heap_make(void)
+{
+    Arena *arena = arena_make();
+    
+    Freetype_Heap *result = arena_push_array(arena, Freetype_Heap, 1);
+    result->arena = arena;
+    result->memory.user = result;
+    result->memory.alloc = freetype_heap_alloc;
+    result->memory.free = freetype_heap_free;
+    result->memory.realloc = freetype_heap_realloc;
+    
+    return(result);
+}
+
+internal void freetype_heap_release(Freetype_Heap *heap)
+{
+    arena_release(heap->arena);
+}
+
+internal void *freetype_heap_alloc(FT_Memory memory, long size)
+{
+    Freetype_Heap *heap = (Freetype_Heap *) memory->user;
+    
+    u64 size_class = FREETYPE_HEAP_MIN_CLASS;
+    while (size_class < FREETYPE_HEAP_CLASS_COUNT && ((u64) 1 << size_class) < (u64) size) {
+        size_class += 1;
+    }
+    
+    void *result = 0;
+    if (size > 0 && size_class < FREETYPE_HEAP_CLASS_COUNT) {
+        Freetype_Block *block = heap->free[size_class];
+        if (block) {
+            heap->free[size_class] = block->next;
+        } else {
+            Freetype_Block_Header *header = (Freetype_Block_Header *) arena_push_no_zero(heap->arena, sizeof(Freetype_Block_Header) + ((usize) 1 << size_class));
+            if (header) {
+                header->size_class = size_class;
+                block = (Freetype_Block *) (header + 1);
+            }
+        }
+        
+        if (block) {
+            heap->live_bytes += (usize) 1 << size_class;
+            heap->peak_bytes = MAX(heap->peak_bytes, heap->live_bytes);
+        }
+        
+        result = block;
     }
+    
+    return(result);
+}
 
-    FT_Face face = {0};
+internal void freetype_heap_free(FT_Memory memory, void *block)
+{
+    Freetype_Heap *heap = (Freetype_Heap *) memory->user;
+    if (block) {
+        Freetype_Block_Header *header = (Freetype_Block_Header *) block - 1;
+        Freetype_Block *free_block = (Freetype_Block *) block;
+        free_block->next = heap->free[header->size_class];
+        heap->free[header->size_class] = free_block;
+        heap->live_bytes -= (usize) 1 << header->size_class;
+    }
+}
+
+internal void *freetype_heap_realloc(FT_Memory memory, long cur_size, long new_size, void *block)
+{
+    void *result = 0;
+    if (block == 0) {
+        result = freetype_heap_alloc(memory, new_size);
+    } else {
+        Freetype_Block_Header *header = (Freetype_Block_Header *) block - 1;
+        if ((u64) new_size <= ((u64) 1 << header->size_class)) {
+            result = block;
+        } else {
+            result = freetype_heap_alloc(memory, new_size);
+            if (result) {
+                MemoryCopy(result, block, MIN(cur_size, new_size));
+                freetype_heap_free(memory, block);
+            }
+        }
+    }
+    
+    return(result);
+}
+
+internal b32 freetype_face_open(Freetype_Face *face, String8 path, u32 font_size, u32 dpi)
+{
+    MemoryZero(face, sizeof(Freetype_Face));
+    
+    // @Note: Library per face instead of one for the process, so its memory goes away with the face.
+    b32 error = 0;
+    face->heap = freetype_heap_make();
+    if (FT_New_Library(&face->heap->memory, &face->library) != 0) {
+        face->library = 0;
+        error = 1;
+    }
+    
+    if (!error) {
+        FT_Add_Default_Modules(face->library);
+        FT_Set_Default_Properties(face->library);
+    }
+    
     if (!error) {
-        b32 init_face = FT_New_Face(ft, (const char *) font_name.data, 0, &face) == 0;
-        b32 set_size = FT_Set_Char_Size(face, 0, (font_size << 6), dpi, dpi) == 0;
+        b32 init_face = FT_New_Face(face->library, (const char *) path.data, 0, &face->face) == 0;
+        b32 set_size = init_face && FT_Set_Char_Size(face->face, 0, (font_size << 6), dpi, dpi) == 0;
+        
+        if (!init_face) {
+            face->face = 0;
+        }
         
         if (!init_face || !set_size) {
             error = 1;
         }
     }
+    
+    if (error) {
+        freetype_face_close(face);
+    }
+    
+    b32 result = !error;
+    return(result);
+}
 
-    Font result = {0};
-    result.texture_size = { FONT_INIT_ATLAS_SIZE, FONT_INIT_ATLAS_SIZE };
-    result.font_size = font_size;
+internal void freetype_face_close(Freetype_Face *face)
+{
+    // @Note: The face has the font file open and the library runs its modules' shutdown, after
+    // that everything left is memory and goes with the arena.
+    if (face->face) {
+        FT_Done_Face(face->face);
+    }
+    
+    if (face->library) {
+        FT_Done_Library(face->library);
+    }
+    
+    if (face->heap) {
+        freetype_heap_release(face->heap);
+    }
+    
+    MemoryZero(face, sizeof(Freetype_Face));
+}
+
+internal b32 freetype_face_load(Font *font)
+{
+    Freetype_Face face = {0};
+    b32 result = freetype_face_open(&face, font->path, font->font_size, font->dpi);
+    if (result) {
+        font->face = face.face;
+        font->library = face.library;
+        font->heap = face.heap;
+    }
+    
+    return(result);
+}
+
+internal void freetype_face_release(Font *font)
+{
+    Freetype_Face face = {0};
+    face.face = (FT_Face) font->face;
+    face.library = (FT_Library) font->library;
+    face.heap = (Freetype_Heap *) font->heap;
+    freetype_face_close(&face);
+    
+    font->face = 0;
+    font->library = 0;
+    font->heap = 0;
+}
+
+internal b32 freetype_glyph_render(FT_Face face, Font_Raster raster, u32 codepoint, u32 max_width, u32 max_height)
+{
+    b32 error = 0;
+    if (raster == FONT_RASTER_SDF) {
+        // @Note: Hinting is for one pixel grid, the field gets drawn at any scale
+        if (FT_Load_Char(face, codepoint, FT_LOAD_NO_HINTING) != 0 ||
+            FT_Render_Glyph(face->glyph, FT_RENDER_MODE_SDF) != 0) {
+            error = 1;
+        }
+    } else if (FT_Load_Char(face, codepoint, FT_LOAD_RENDER | FT_LOAD_FORCE_AUTOHINT | FT_LOAD_TARGET_LIGHT) != 0) {
+        error = 1;
+    }
+    
+    FT_Bitmap *bmp = &face->glyph->bitmap;
+    if (!error && (bmp->width > max_width || bmp->rows > max_height)) {
+        error = 1;
+    }
+    
+    b32 result = !error;
+    return(result);
+}
+
+internal void freetype_glyph_store(FT_GlyphSlot slot, Font_Raster raster, u32 *dst, u32 pitch)
+{
+    FT_Bitmap *bmp = &slot->bitmap;
+    for (u32 row = 0; row < bmp->rows; ++row) {
+        for (u32 col = 0; col < bmp->width; ++col) {
+            u8 pixel = bmp->buffer[row*bmp->pitch + col];
+            if (raster == FONT_RASTER_SDF) {
+                dst[row*pitch + col] = 0xFFFFFF00 | pixel;
+            } else {
+                dst[row*pitch + col] = pixel ? (0xFFFFFF00 | pixel) : 0;
+            }
+        }
+    }
+}
+
+internal void freetype_glyph_metrics(FT_GlyphSlot slot, Font_Glyph_Info *info)
+{
+    info->size = { (f32) slot->bitmap.width, (f32) slot->bitmap.rows };
+    info->offset = { (f32) slot->bitmap_left, (f32) slot->bitmap_top };
+    info->advance = (f32) (slot->advance.x >> 6);
+}
+
+internal b32 freetype_glyph_rasterize(Font *font, u32 codepoint, Font_Glyph_Info *info, R_Atlas_Region *region)
+{
+    FT_Face face = (FT_Face) font->face;
+    b32 error = !freetype_glyph_render(face, font->raster, codepoint, font->scratch_width, font->scratch_height);
+    
+    FT_Bitmap *bmp = &face->glyph->bitmap;
+    MemoryZero(region, sizeof(R_Atlas_Region));
+    if (!error && bmp->width > 0 && bmp->rows > 0) {
+        if (!r_atlas_alloc(&font->atlas, bmp->width, bmp->rows, region)) {
+            error = 1;
+        }
+    }
+    
     if (!error) {
-        // @Note: First populate basic metrics and calculate texture size.
-        for (u32 i = 0; i < FONT_GLYPH_COUNT; ++i) {
-            FT_Load_Char(face, i, FT_LOAD_BITMAP_METRICS_ONLY | FT_LOAD_FORCE_AUTOHINT | FT_LOAD_TARGET_LIGHT);
-            FT_Bitmap *bmp = &face->glyph->bitmap;
-            HMM_Vec2 glyph_size = { (f32) bmp->width, (f32) bmp->rows };
-                
-            Font_Rect_Node *node = font_rect_pack(scratch.arena, root, glyph_size, result.texture_size);
-            while (node == 0) {
-                // @Note: We have to ask for a bigger texture.
-                result.texture_size.X *= 2.0f;
-                result.texture_size.Y *= 2.0f;            
-                node = font_rect_pack(scratch.arena, root, glyph_size, result.texture_size);
-            }
-
-            result.glyphs[i].size = glyph_size;
-            result.glyphs[i].origin = node->origin;
-            result.glyphs[i].offset = { (f32) face->glyph->bitmap_left, (f32) face->glyph->bitmap_top };
-            result.glyphs[i].advance = (f32) (face->glyph->advance.x >> 6);
-        }
-
-        // @Note: Then render the actual glyphs onto atlas.
-        u32 *pixels = arena_push_array(scratch.arena, u32, (usize) (result.texture_size.X*result.texture_size.Y));
-        for (u32 i = 0; i < FONT_GLYPH_COUNT; ++i) {
-            FT_Load_Char(face, i, FT_LOAD_RENDER | FT_LOAD_FORCE_AUTOHINT | FT_LOAD_TARGET_LIGHT);
-            FT_Bitmap *bmp = &face->glyph->bitmap;
-            Font_Glyph_Info glyph = result.glyphs[i];
-        
-            for (u32 row = 0; row < bmp->rows; ++row) {
-                for (u32 col = 0; col < bmp->width; ++col) {
-                    u8 pixel = bmp->buffer[row*bmp->pitch + col];
-
-                    if (pixel) {
-                        u32 x = (u32) (glyph.origin.X + col);
-                        u32 y = (u32) (glyph.origin.Y + row);
-                        usize index = (usize) (y*result.texture_size.X + x);
-                        pixels[index] = 0xFFFFFF00 | pixel;
-                    }
+        if (region->width != 0) {
+            freetype_glyph_store(face->glyph, font->raster, font->scratch, bmp->width);
+            r_atlas_upload(&font->atlas, *region, font->scratch, sizeof(u32)*bmp->width);
+        }
+        
+        freetype_glyph_metrics(face->glyph, info);
+        info->origin = { (f32) region->x, (f32) region->y };
+        
+        RectF32 uv = {0};
+        if (region->width != 0) {
+            uv = r_atlas_uv(&font->atlas, *region);
+        }
+        info->uv = uv;
+    }
+    
+    b32 result = !error;
+    return(result);
+}
+
+internal u32 *freetype_pack_order(Arena *arena, Freetype_Build_Glyph *glyphs, u32 glyph_count, u32 max_height)
+{
+    // @Note: Tallest first, counting sort so equal heights keep codepoint order. Rows of equal
+    // height merge into one skyline segment, in codepoint order the skyline runs out of segments
+    // long before it runs out of space.
+    u32 *counts = arena_push_array(arena, u32, max_height + 2);
+    for (u32 i = 0; i < glyph_count; ++i) {
+        counts[max_height - (u32) glyphs[i].info.size.Y + 1] += 1;
+    }
+    
+    for (u32 i = 1; i <= max_height + 1; ++i) {
+        counts[i] += counts[i - 1];
+    }
+    
+    u32 *result = arena_push_array(arena, u32, glyph_count);
+    for (u32 i = 0; i < glyph_count; ++i) {
+        result[counts[max_height - (u32) glyphs[i].info.size.Y]++] = i;
+    }
+    
+    return(result);
+}
+
+internal b32 freetype_atlas_fits(Freetype_Build_Glyph *glyphs, u32 *order, u32 glyph_count, u32 size, u32 pages)
+{
+    // @Note: Same first fit over the same skylines as r_atlas_alloc(), so this is exactly what the real packing does.
+    R_Skyline skies[R_ATLAS_INIT_PAGES];
+    R_Skyline_Node nodes[R_ATLAS_INIT_PAGES][R_ATLAS_MAX_SKYLINE];
+    for (u32 i = 0; i < pages; ++i) {
+        r_skyline_init(skies + i, nodes[i], R_ATLAS_MAX_SKYLINE, size, size/R_ATLAS_INIT_PAGES);
+    }
+    
+    b32 fits = 1;
+    for (u32 i = 0; i <= glyph_count && fits; ++i) {
+        // @Note: One past the glyphs is the white block, which goes first
+        u32 width = (u32) FONT_WHITE_SIZE;
+        u32 height = (u32) FONT_WHITE_SIZE;
+        if (i > 0) {
+            width = (u32) glyphs[order[i - 1]].info.size.X;
+            height = (u32) glyphs[order[i - 1]].info.size.Y;
+        }
+        
+        if (width > 0 && height > 0) {
+            b32 found = 0;
+            for (u32 page = 0; page < pages && !found; ++page) {
+                u32 index = 0;
+                u32 y = 0;
+                if (r_skyline_find(skies + page, width + R_ATLAS_PADDING, height + R_ATLAS_PADDING, &index, &y)) {
+                    r_skyline_place(skies + page, index, y, width + R_ATLAS_PADDING, height + R_ATLAS_PADDING);
+                    found = 1;
                 }
             }
+            
+            fits = found;
+        }
+    }
+    
+    return(fits);
+}
+
+internal u32 freetype_atlas_size(Font *font, Freetype_Build_Glyph *glyphs, u32 *order, u32 glyph_count)
+{
+    // @Note: The atlas never grows, glyph infos, the white block and the disk cache keep UVs
+    // relative to the size they were built at, growing would change it under them. Eviction
+    // only ever takes pages that weren't drawn from this frame, so it's safe at any point.
+    // Prebuilt glyphs are pinned, so they get at most half of the pages, the rest is for the cache.
+    u32 result = 64;
+    u32 wanted = FONT_ATLAS_CELLS*MAX(font->scratch_width, font->scratch_height);
+    while (result < wanted && result < FONT_ATLAS_MAX_SIZE) result *= 2;
+    while (result < FONT_ATLAS_MAX_SIZE && !freetype_atlas_fits(glyphs, order, glyph_count, result, R_ATLAS_INIT_PAGES/2)) result *= 2;
+    return(result);
+}
+
+internal void freetype_build_worker(void *data)
+{
+    Freetype_Build_Worker *worker = (Freetype_Build_Worker *) data;
+    Font *font = worker->font;
+    FT_Face face = worker->face.face;
+    
+    for (u32 i = worker->first; i < worker->glyph_count && !worker->error; i += worker->stride) {
+        Freetype_Build_Glyph *glyph = worker->glyphs + i;
         
-            result.glyphs[i].uv = {
-                (glyph.origin.X)/result.texture_size.X,
-                (glyph.origin.Y)/result.texture_size.Y,
-                (glyph.origin.X + glyph.size.X)/result.texture_size.X,
-                (glyph.origin.Y + glyph.size.Y)/result.texture_size.Y
-            };
+        if (worker->image == 0) {
+            // @Note: First pass, every glyph into memory of its own worker
+            if (!freetype_glyph_render(face, font->raster, glyph->codepoint, font->scratch_width, font->scratch_height)) {
+                worker->error = 1;
+            } else {
+                FT_Bitmap *bmp = &face->glyph->bitmap;
+                freetype_glyph_metrics(face->glyph, &glyph->info);
+                if (bmp->width > 0 && bmp->rows > 0) {
+                    glyph->pixels = arena_push_array(worker->arena, u32, bmp->width*bmp->rows);
+                    freetype_glyph_store(face->glyph, font->raster, glyph->pixels, bmp->width);
+                }
+            }
+        } else if (glyph->region.width != 0) {
+            // @Note: Second pass, regions are disjoint so nothing here needs a lock
+            u32 *dst = worker->image + glyph->region.y*worker->image_pitch + glyph->region.x;
+            for (u32 row = 0; row < glyph->region.height; ++row) {
+                MemoryCopy(dst + row*worker->image_pitch, glyph->pixels + row*glyph->region.width, sizeof(u32)*glyph->region.width);
+            }
         }
+    }
+}
 
-        // @Note: Finally create the texture.
-        result.texture = r_texture_create(pixels, (u32) result.texture_size.X, (u32) result.texture_size.Y);
+internal void freetype_build_thread(void *data)
+{
+    OPTICK_THREAD("Font build");
+    freetype_build_worker(data);
+}
+
+internal b32 freetype_build_run(Freetype_Build_Worker *workers, u32 worker_count)
+{
+    OPTICK_EVENT();
+    
+    // @Note: Worker 0 is the calling thread, a worker that fails to start is done on it too.
+    OS_Thread threads[FONT_BUILD_MAX_WORKERS] = {0};
+    b32 started[FONT_BUILD_MAX_WORKERS] = {0};
+    for (u32 i = 1; i < worker_count; ++i) {
+        started[i] = os_thread_start(threads + i, freetype_build_thread, workers + i);
     }
+    
+    freetype_build_worker(workers);
+    
+    b32 error = workers[0].error;
+    for (u32 i = 1; i < worker_count; ++i) {
+        if (started[i]) {
+            os_thread_join(threads + i);
+        } else {
+            freetype_build_worker(workers + i);
+        }
+        
+        error = error || workers[i].error;
+    }
+    
+    b32 result = !error;
+    return(result);
+}
 
+internal b32 freetype_font_build(Font *font, Arena *arena, String8 cache_path, u32 *codepoints, u32 codepoint_count, u32 worker_count)
+{
+    OPTICK_EVENT();
+    
+    b32 error = !freetype_face_load(font);
+    
     if (!error) {
-        FT_Done_FreeType(ft);
+        FT_Face face = (FT_Face) font->face;
+        
+        // @Note: Bounding box of the face is an upper bound for every glyph in it.
+        FT_Size_Metrics *metrics = &face->size->metrics;
+        font->scratch_width = (u32) (FT_MulFix(face->bbox.xMax - face->bbox.xMin, metrics->x_scale) >> 6) + 2;
+        font->scratch_height = (u32) (FT_MulFix(face->bbox.yMax - face->bbox.yMin, metrics->y_scale) >> 6) + 2;
+        if (font->raster == FONT_RASTER_SDF) {
+            font->scratch_width += 2*FONT_SDF_SPREAD;
+            font->scratch_height += 2*FONT_SDF_SPREAD;
+        }
+        
+        font->scratch_width = MAX(font->scratch_width, (u32) FONT_WHITE_SIZE);
+        font->scratch_height = MAX(font->scratch_height, (u32) FONT_WHITE_SIZE);
+        font->scratch = arena_push_array(arena, u32, font->scratch_width*font->scratch_height);
+    }
+    
+    // @Note: ASCII is what nearly all text is made of, so it's never evicted and never hashed,
+    // whatever else is prebuilt goes after it and is pinned the same way.
+    Arena_Temp scratch = arena_temp_begin(arena);
+    u32 glyph_count = FONT_GLYPH_COUNT + codepoint_count;
+    Freetype_Build_Glyph *glyphs = arena_push_array(scratch.arena, Freetype_Build_Glyph, glyph_count);
+    for (u32 i = 0; i < glyph_count; ++i) {
+        glyphs[i].codepoint = i < FONT_GLYPH_COUNT ? i : codepoints[i - FONT_GLYPH_COUNT];
+    }
+    
+    // @Note: One face per worker, FreeType objects can't be shared between threads. Glyphs
+    // are dealt out round robin, neighbouring codepoints tend to cost about the same.
+    worker_count = MIN(worker_count, (glyph_count + FONT_BUILD_MIN_GLYPHS - 1)/FONT_BUILD_MIN_GLYPHS);
+    worker_count = MAX(MIN(worker_count, FONT_BUILD_MAX_WORKERS), 1);
+    
+    Freetype_Build_Worker *workers = arena_push_array(scratch.arena, Freetype_Build_Worker, worker_count);
+    for (u32 i = 0; i < worker_count && !error; ++i) {
+        Freetype_Build_Worker *worker = workers + i;
+        worker->font = font;
+        worker->glyphs = glyphs;
+        worker->glyph_count = glyph_count;
+        worker->first = i;
+        worker->stride = worker_count;
+        worker->arena = i == 0 ? scratch.arena : arena_make();
+        
+        if (i == 0) {
+            worker->face.face = (FT_Face) font->face;
+        } else if (!freetype_face_open(&worker->face, font->path, font->font_size, font->dpi)) {
+            error = 1;
+        }
+    }
+    
+    if (!error) {
+        error = !freetype_build_run(workers, worker_count);
+    }
+    
+    // @Note: Everything is rasterized by now, so the sizes are exact and packing is a single pass.
+    u32 *order = 0;
+    if (!error) {
+        order = freetype_pack_order(scratch.arena, glyphs, glyph_count, font->scratch_height);
+        
+        u32 atlas_size = freetype_atlas_size(font, glyphs, order, glyph_count);
+        if (!r_atlas_init(&font->atlas, atlas_size, atlas_size, atlas_size, freetype_glyph_evict, 0)) {
+            error = 1;
+        }
+    }
+    
+    R_Atlas_Region white = {0};
+    if (!error) {
+        // @Note: Reserve the white block first, so it always ends up in the same corner.
+        error = !r_atlas_alloc(&font->atlas, (u32) FONT_WHITE_SIZE, (u32) FONT_WHITE_SIZE, &white);
+        
+        for (u32 i = 0; i < glyph_count && !error; ++i) {
+            Freetype_Build_Glyph *glyph = glyphs + order[i];
+            u32 width = (u32) glyph->info.size.X;
+            u32 height = (u32) glyph->info.size.Y;
+            if (width > 0 && height > 0) {
+                error = !r_atlas_alloc(&font->atlas, width, height, &glyph->region);
+            }
+        }
+    }
+    
+    u32 *image = 0;
+    if (!error) {
+        image = arena_push_array(scratch.arena, u32, font->atlas.width*font->atlas.height);
+        MemoryZero(image, sizeof(u32)*font->atlas.width*font->atlas.height);
+        
+        for (u32 row = 0; row < (u32) FONT_WHITE_SIZE; ++row) {
+            for (u32 col = 0; col < (u32) FONT_WHITE_SIZE; ++col) {
+                image[(white.y + row)*font->atlas.width + white.x + col] = 0xFFFFFFFF;
+            }
+        }
+        
+        r_atlas_pin(&font->atlas, white);
+        
+        // @Note: Degenerate UV in the middle of the block, every fragment samples the same white texel.
+        f32 white_u = (white.x + FONT_WHITE_SIZE*.5f)/(f32) font->atlas.width;
+        f32 white_v = (white.y + FONT_WHITE_SIZE*.5f)/(f32) font->atlas.height;
+        font->white_uv = { white_u, white_v, white_u, white_v };
+        
+        for (u32 i = 0; i < worker_count; ++i) {
+            workers[i].image = image;
+            workers[i].image_pitch = font->atlas.width;
+        }
+        
+        error = !freetype_build_run(workers, worker_count);
+    }
+    
+    if (!error) {
+        for (u32 i = 0; i < glyph_count; ++i) {
+            Freetype_Build_Glyph *glyph = glyphs + i;
+            glyph->info.origin = { (f32) glyph->region.x, (f32) glyph->region.y };
+            if (glyph->region.width != 0) {
+                glyph->info.uv = r_atlas_uv(&font->atlas, glyph->region);
+                r_atlas_pin(&font->atlas, glyph->region);
+            }
+            
+            if (i < FONT_GLYPH_COUNT) {
+                font->glyphs[i] = glyph->info;
+            } else {
+                freetype_glyph_insert(font, glyph->codepoint, glyph->region, &glyph->info);
+            }
+        }
+    }
+    
+    for (u32 i = 1; i < worker_count; ++i) {
+        if (workers[i].arena) arena_release(workers[i].arena);
+        freetype_face_close(&workers[i].face);
+    }
+    
+    if (!error) {
+        u32 pages = 0;
+        while (pages < font->atlas.page_count && font->atlas.pages[pages].pinned) pages += 1;
+        
+        u32 rows = pages*font->atlas.page_height;
+        r_texture_update_region(font->atlas.texture, image, 0, 0, font->atlas.width, rows, sizeof(u32)*font->atlas.width);
+        
+        // @Note: A failed save just means the next start builds again
+        if (cache_path.size != 0) {
+            freetype_cache_save(font, scratch.arena, cache_path, image, pages, glyphs + FONT_GLYPH_COUNT, codepoint_count);
+        }
     }
     
     arena_temp_end(&scratch);
-    freetype_is_init = !error;
+    
+    b32 result = !error;
+    return(result);
+}
+
+internal String8 freetype_cache_path(char *buffer, usize size, String8 font_name, u32 font_size, u32 dpi, Font_Raster raster, u32 *codepoints, u32 codepoint_count)
+{
+    u32 key[4] = { font_size, dpi, (u32) raster, FONT_CACHE_FREETYPE_VERSION };
+    u64 hash = str8_hash(STR8_HASH_SEED, font_name);
+    hash = str8_hash(hash, str8_make((u8 *) key, sizeof(key)));
+    hash = str8_hash(hash, str8_make((u8 *) codepoints, sizeof(u32)*codepoint_count));
+    
+    snprintf(buffer, size, FONT_CACHE_DIR "font_%016llx.cache", (unsigned long long) hash);
+    String8 result = str8_from_cstr(buffer);
+    return(result);
+}
+
+internal void freetype_cache_save(Font *font, Arena *arena, String8 cache_path, u32 *image, u32 pages, Freetype_Build_Glyph *prebuilt, u32 prebuilt_count)
+{
+    OPTICK_EVENT();
+    
+    usize path_size = ALIGN_POW2(font->path.size, 8);
+    usize pixel_count = (usize) font->atlas.width*pages*font->atlas.page_height;
+    usize size = sizeof(Font_Cache_Header) + path_size + pages*sizeof(Font_Cache_Page) + prebuilt_count*sizeof(Font_Cache_Glyph) + pixel_count*sizeof(u32);
+    
+    String8 data = str8_alloc(arena, size);
+    MemoryZero(data.data, data.size);
+    
+    Font_Cache_Header *header = (Font_Cache_Header *) data.data;
+    header->magic = FONT_CACHE_MAGIC;
+    header->version = FONT_CACHE_VERSION;
+    header->freetype_version = FONT_CACHE_FREETYPE_VERSION;
+    header->font_size = font->font_size;
+    header->dpi = font->dpi;
+    header->raster = (u32) font->raster;
+    header->path_size = (u32) font->path.size;
+    header->atlas_width = font->atlas.width;
+    header->atlas_height = font->atlas.height;
+    header->scratch_width = font->scratch_width;
+    header->scratch_height = font->scratch_height;
+    header->page_count = pages;
+    header->skyline_cap = R_ATLAS_MAX_SKYLINE;
+    header->prebuilt_count = prebuilt_count;
+    header->white_uv = font->white_uv;
+    MemoryCopy(header->glyphs, font->glyphs, sizeof(font->glyphs));
+    
+    u8 *at = data.data + sizeof(Font_Cache_Header);
+    MemoryCopy(at, font->path.data, font->path.size);
+    at += path_size;
+    
+    for (u32 i = 0; i < pages; ++i) {
+        R_Skyline *sky = r_atlas_sky(&font->atlas, i);
+        Font_Cache_Page *page = (Font_Cache_Page *) at;
+        page->node_count = sky->count;
+        page->used_area = sky->used_area;
+        MemoryCopy(page->nodes, sky->nodes, sizeof(R_Skyline_Node)*sky->count);
+        at += sizeof(Font_Cache_Page);
+    }
+    
+    for (u32 i = 0; i < prebuilt_count; ++i) {
+        Font_Cache_Glyph *glyph = (Font_Cache_Glyph *) at;
+        glyph->codepoint = prebuilt[i].codepoint;
+        glyph->region = prebuilt[i].region;
+        glyph->info = prebuilt[i].info;
+        at += sizeof(Font_Cache_Glyph);
+    }
+    
+    MemoryCopy(at, image, pixel_count*sizeof(u32));
+    
+    os_file_write(cache_path, data);
+}
+
+internal b32 freetype_cache_load(Font *font, Arena *arena, String8 data, u32 *codepoints, u32 codepoint_count)
+{
+    OPTICK_EVENT();
+    
+    // @Note: Anything that doesn't match exactly is a miss, never an error
+    Font_Cache_Header *header = (Font_Cache_Header *) data.data;
+    b32 valid = data.size >= sizeof(Font_Cache_Header);
+    valid = valid && header->magic == FONT_CACHE_MAGIC && header->version == FONT_CACHE_VERSION;
+    valid = valid && header->freetype_version == FONT_CACHE_FREETYPE_VERSION && header->skyline_cap == R_ATLAS_MAX_SKYLINE;
+    valid = valid && header->font_size == font->font_size && header->dpi == font->dpi && header->raster == (u32) font->raster;
+    valid = valid && header->path_size == font->path.size && header->atlas_width == header->atlas_height;
+    valid = valid && header->atlas_width >= 64 && header->atlas_width <= FONT_ATLAS_MAX_SIZE;
+    valid = valid && header->page_count <= R_ATLAS_INIT_PAGES && header->prebuilt_count == codepoint_count;
+    valid = valid && header->scratch_width <= header->atlas_width && header->scratch_height <= header->atlas_height;
+    
+    usize path_size = 0;
+    usize pixel_count = 0;
+    if (valid) {
+        path_size = ALIGN_POW2(header->path_size, 8);
+        pixel_count = (usize) header->atlas_width*header->page_count*(header->atlas_height/R_ATLAS_INIT_PAGES);
+        usize size = sizeof(Font_Cache_Header) + path_size + header->page_count*sizeof(Font_Cache_Page) + codepoint_count*sizeof(Font_Cache_Glyph) + pixel_count*sizeof(u32);
+        
+        valid = data.size == size && MemoryMatch(data.data + sizeof(Font_Cache_Header), font->path.data, font->path.size);
+    }
+    
+    Font_Cache_Page *pages = 0;
+    if (valid) {
+        pages = (Font_Cache_Page *) (data.data + sizeof(Font_Cache_Header) + path_size);
+        for (u32 i = 0; i < header->page_count; ++i) {
+            valid = valid && pages[i].node_count > 0 && pages[i].node_count <= R_ATLAS_MAX_SKYLINE;
+        }
+    }
+    
+    // @Note: Prebuilt glyphs have to sit on the pages that are in the file, those are the pinned ones.
+    Font_Cache_Glyph *glyphs = 0;
+    if (valid) {
+        glyphs = (Font_Cache_Glyph *) (pages + header->page_count);
+        u32 page_height = header->atlas_height/R_ATLAS_INIT_PAGES;
+        for (u32 i = 0; i < codepoint_count; ++i) {
+            valid = valid && glyphs[i].codepoint == codepoints[i];
+            valid = valid && (glyphs[i].region.width == 0 || (glyphs[i].region.page < header->page_count &&
+                                                             glyphs[i].region.y + glyphs[i].region.height <= header->page_count*page_height));
+        }
+    }
+    
+    if (valid) {
+        valid = r_atlas_init(&font->atlas, header->atlas_width, header->atlas_height, header->atlas_width, freetype_glyph_evict, 0);
+    }
+    
+    if (valid) {
+        u32 *pixels = (u32 *) (glyphs + codepoint_count);
+        u32 rows = header->page_count*font->atlas.page_height;
+        r_texture_update_region(font->atlas.texture, pixels, 0, 0, font->atlas.width, rows, sizeof(u32)*font->atlas.width);
+        
+        for (u32 i = 0; i < header->page_count; ++i) {
+            R_Atlas_Page *page = font->atlas.pages + i;
+            MemoryCopy(page->nodes, pages[i].nodes, sizeof(R_Skyline_Node)*pages[i].node_count);
+            page->sky.count = pages[i].node_count;
+            page->sky.used_area = pages[i].used_area;
+            page->pinned = 1;
+        }
+        
+        font->scratch_width = header->scratch_width;
+        font->scratch_height = header->scratch_height;
+        font->scratch = arena_push_array(arena, u32, font->scratch_width*font->scratch_height);
+        font->white_uv = header->white_uv;
+        MemoryCopy(font->glyphs, header->glyphs, sizeof(font->glyphs));
+        
+        for (u32 i = 0; i < codepoint_count; ++i) {
+            freetype_glyph_insert(font, glyphs[i].codepoint, glyphs[i].region, &glyphs[i].info);
+        }
+    }
+    
+    return(valid);
+}
+
+internal Font font_init(Arena *arena, String8 font_name, u32 font_size, u32 dpi)
+{
+    return(font_init_ex(arena, font_name, font_size, dpi, FONT_RASTER_COVERAGE, str8("")));
+}
+
+internal u32 *freetype_prebuilt_codepoints(Arena *arena, String8 text, u32 *count)
+{
+    // @Note: Worst case every byte is a codepoint, the table is just for dropping duplicates.
+    u32 cap = (u32) text.size;
+    u32 table_size = 16;
+    while (table_size < 2*cap) table_size *= 2;
+    
+    u32 *result = arena_push_array(arena, u32, cap);
+    u32 *table = arena_push_array(arena, u32, table_size);
+    
+    *count = 0;
+    for (usize i = 0; i < text.size;) {
+        Str8_Decode decode = str8_decode_utf8(text.data + i, text.size - i);
+        i += decode.size;
+        
+        u32 codepoint = decode.codepoint;
+        if (codepoint < FONT_GLYPH_COUNT || codepoint == STR8_REPLACEMENT_CHAR) continue;
+        
+        u32 slot = (codepoint*2654435761u) & (table_size - 1);
+        while (table[slot] != 0 && table[slot] != codepoint) slot = (slot + 1) & (table_size - 1);
+        
+        if (table[slot] == 0) {
+            table[slot] = codepoint;
+            result[(*count)++] = codepoint;
+        }
+    }
+    
+    return(result);
+}
+
+internal Font font_init_ex(Arena *arena, String8 font_name, u32 font_size, u32 dpi, Font_Raster raster, String8 prebuilt)
+{
+    return(freetype_font_init(arena, font_name, font_size, dpi, raster, prebuilt, os_cpu_count(), 1));
+}
+
+internal Font freetype_font_init(Arena *arena, String8 font_name, u32 font_size, u32 dpi, Font_Raster raster, String8 prebuilt, u32 worker_count, b32 use_cache)
+{
+    OPTICK_EVENT();
+    
+    Font result = {0};
+    result.font_size = font_size;
+    result.dpi = dpi;
+    result.raster = raster;
+    result.path = str8_push_copy(arena, font_name);
+    
+    u32 prebuilt_count = 0;
+    u32 *codepoints = freetype_prebuilt_codepoints(arena, prebuilt, &prebuilt_count);
+    
+    // @Note: Prebuilt glyphs take entries of their own, they are never given back.
+    u32 pool_size = FONT_GLYPH_CACHE_SIZE + prebuilt_count;
+    Font_Glyph *pool = arena_push_array(arena, Font_Glyph, pool_size);
+    for (u32 i = 0; i < pool_size; ++i) {
+        pool[i].next = result.first_free;
+        result.first_free = pool + i;
+    }
+    
+    char cache_buffer[256] = {0};
+    String8 cache_path = {0};
+    if (use_cache) {
+        cache_path = freetype_cache_path(cache_buffer, sizeof(cache_buffer), font_name, font_size, dpi, raster, codepoints, prebuilt_count);
+    }
+    
+    // @Note: On a hit FreeType isn't touched at all, the face gets loaded with the first glyph that isn't prebuilt.
+    OS_File_Map cache = {0};
+    if (use_cache) {
+        cache = os_file_map(cache_path);
+    }
+    
+    b32 error = 0;
+    if (!freetype_cache_load(&result, arena, cache.data, codepoints, prebuilt_count)) {
+        r_atlas_release(&result.atlas);
+        error = !freetype_font_build(&result, arena, cache_path, codepoints, prebuilt_count, worker_count);
+    }
+    os_file_unmap(&cache);
+    
+    if (!error) {
+        result.texture = result.atlas.texture;
+        result.texture_size = { (f32) result.atlas.width, (f32) result.atlas.height };
+        
+        font_run_init(&result, arena);
+    }
+    
+    if (error) {
+        r_atlas_release(&result.atlas);
+        freetype_face_release(&result);
+        
+        result.texture = 0;
+    } else {
+        ++freetype_init_count;
+    }
+    
+    return(result);
+}
+
+internal void freetype_glyph_insert(Font *font, u32 codepoint, R_Atlas_Region region, Font_Glyph_Info *info)
+{
+    u32 bucket = (codepoint*2654435761u) % FONT_GLYPH_BUCKET_COUNT;
+    
+    Font_Glyph *glyph = font->first_free;
+    font->first_free = glyph->next;
+    
+    glyph->codepoint = codepoint;
+    glyph->region = region;
+    glyph->info = *info;
+    glyph->next = font->buckets[bucket];
+    font->buckets[bucket] = glyph;
+}
+
+internal Font_Glyph_Info *font_glyph_get(Font *font, u32 codepoint)
+{
+    if (codepoint < FONT_GLYPH_COUNT) {
+        return(&font->glyphs[codepoint]);
+    }
+    
+    u32 bucket = (codepoint*2654435761u) % FONT_GLYPH_BUCKET_COUNT;
+    for (Font_Glyph *glyph = font->buckets[bucket]; glyph != 0; glyph = glyph->next) {
+        if (glyph->codepoint == codepoint) {
+            if (glyph->region.width != 0) {
+                r_atlas_touch(&font->atlas, glyph->region);
+            }
+            
+            return(&glyph->info);
+        }
+    }
+    
+    // @Note: Font is returned by value from font_init(), so the callback has to be pointed at wherever it lives now.
+    // The atlas itself doesn't mind being moved, see r_atlas_sky().
+    font->atlas.evict_user = font;
+    
+    // @Note: Out of glyphs, free up the ones on the least recently used pages.
+    for (u32 i = 0; i < font->atlas.page_count && font->first_free == 0; ++i) {
+        u32 page = 0;
+        if (!r_atlas_evict(&font->atlas, &page)) break;
+    }
+    
+    if (font->face == 0 && !freetype_face_load(font)) {
+        return(&font->glyphs['?']);
+    }
+    
+    Font_Glyph_Info info = {0};
+    R_Atlas_Region region = {0};
+    if (font->first_free == 0 || !freetype_glyph_rasterize(font, codepoint, &info, &region)) {
+        return(&font->glyphs['?']);
+    }
+    
+    freetype_glyph_insert(font, codepoint, region, &info);
+    
+    return(&font->buckets[bucket]->info);
+}
+
+internal void font_next_frame(Font *font)
+{
+    font_run_expire(font);
+    r_atlas_next_frame(&font->atlas);
+}
+
+internal Font_Memory font_memory(Font *font)
+{
+    Font_Memory result = {0};
+    if (font->heap) {
+        Freetype_Heap *heap = (Freetype_Heap *) font->heap;
+        result.used = arena_pos(heap->arena);
+        result.live = heap->live_bytes;
+        result.peak = heap->peak_bytes;
+    }
     
     return(result);
 }
@@ -99,9 +880,18 @@ internal f32 font_text_width_ex(Font *font, String8 text, f32 scale)
 {
     f32 result = 0.0f;
     if (font_is_init()) {
-        for (u32 i = 0; i < text.size; ++i) {
-            Font_Glyph_Info glyph = font->glyphs[text.data[i]];
-            result += glyph.advance*scale;
+        // @Note: Labels are usually measured right before being drawn, so this lays out the run the draw then hits
+        Font_Run *run = font_run_get(font, text, scale);
+        if (run) {
+            result = run->width;
+        } else {
+            for (usize i = 0; i < text.size;) {
+                Str8_Decode decode = str8_decode_utf8(text.data + i, text.size - i);
+                i += decode.size;
+                
+                Font_Glyph_Info *glyph = font_glyph_get(font, decode.codepoint);
+                result += glyph->advance*scale;
+            }
         }
     } else {
         er_push(str8("font not initialized"));
@@ -123,22 +913,56 @@ internal void font_r_text_ex(R_Ctx *ctx, Font *font, HMM_Vec2 pos, String8 text,
         // @Hack(?): This is here because UV coordinates get messed up for pos = something.5f
         pos.X = (f32) ((s32) (pos.X));
         pos.Y = (f32) ((s32) (pos.Y));
-
-        for (u32 i = 0; i < text.size; ++i) {
-            Font_Glyph_Info glyph = font->glyphs[text.data[i]];
         
-            HMM_Vec2 glyph_pos = {
-                pos.X + glyph.offset.X*scale,
-                pos.Y - glyph.offset.Y*scale
-            };
+        R_Sample sample = font->raster == FONT_RASTER_SDF ? R_SAMPLE_SDF : R_SAMPLE_COLOR;
         
-            RectF32 glyph_rect = {
-                glyph_pos.X, glyph_pos.Y,
-                glyph_pos.X + glyph.size.X*scale, glyph_pos.Y + glyph.size.Y*scale
+        Font_Run *run = font_run_get(font, text, scale);
+        if (run) {
+            // @Note: Whole run at once, a label that's partially visible is left to the backend's scissor
+            f32 pad = 2.0f;
+            RectF32 bounds = {
+                pos.X + run->bounds.x0 - pad, pos.Y + run->bounds.y0 - pad,
+                pos.X + run->bounds.x1 + pad, pos.Y + run->bounds.y1 + pad
             };
+            
+            b32 visible = run->quad_count > 0 && !r_ctx_clip_rejects(ctx, bounds);
+            if (visible) {
+                R_Quad *quads = r_quads_reserve_ex(ctx, font->texture, run->quad_count, sample);
+                for (u32 i = 0; i < run->quad_count; ++i) {
+                    R_Quad *quad = quads + i;
+                    MemoryCopyStruct(quad, run->quads + i);
+                    quad->pos.x0 += pos.X;
+                    quad->pos.y0 += pos.Y;
+                    quad->pos.x1 += pos.X;
+                    quad->pos.y1 += pos.Y;
+                    quad->col = col;
+                }
+                r_quads_commit(ctx, run->quad_count);
+            }
+        } else {
+            for (usize i = 0; i < text.size;) {
+                Str8_Decode decode = str8_decode_utf8(text.data + i, text.size - i);
+                i += decode.size;
+                
+                Font_Glyph_Info glyph = *font_glyph_get(font, decode.codepoint);
+            
+                HMM_Vec2 glyph_pos = {
+                    pos.X + glyph.offset.X*scale,
+                    pos.Y - glyph.offset.Y*scale
+                };
+            
+                RectF32 glyph_rect = {
+                    glyph_pos.X, glyph_pos.Y,
+                    glyph_pos.X + glyph.size.X*scale, glyph_pos.Y + glyph.size.Y*scale
+                };
 
-            r_rect_tex_ex(ctx, glyph_rect, col, 0.0f, 0.0f, glyph.uv, font->texture);
-            pos.X += glyph.advance*scale;
+                R_Quad quad = {0};
+                quad.pos = glyph_rect;
+                quad.uv = glyph.uv;
+                quad.col = col;
+                r_push_quad_ex(ctx, font->texture, &quad, sample);
+                pos.X += glyph.advance*scale;
+            }
         }
     } else {
         er_push(str8("font not initialized"));
@@ -150,11 +974,136 @@ internal void font_r_text(R_Ctx *ctx, Font *font, HMM_Vec2 pos, u32 col, String8
     font_r_text_ex(ctx, font, pos, text, col, 1.0f);
 }
 
+internal void freetype_path_push(Freetype_Path *path, char op, const FT_Vector **points, u32 count)
+{
+    char buffer[128];
+    s32 size = snprintf(buffer, sizeof(buffer), "%c", op);
+    for (u32 i = 0; i < count; ++i) {
+        f32 x = (f32) points[i]->x/64.0f - path->offset.X;
+        f32 y = path->offset.Y - (f32) points[i]->y/64.0f;
+        size += snprintf(buffer + size, sizeof(buffer) - size, "%.2f %.2f ", x, y);
+    }
+    
+    if (path->size + size <= FREETYPE_PATH_SIZE) {
+        MemoryCopy(path->data + path->size, buffer, size);
+        path->size += size;
+    } else {
+        path->full = 1;
+    }
+}
+
+internal int freetype_path_move(const FT_Vector *to, void *user)
+{
+    Freetype_Path *path = (Freetype_Path *) user;
+    
+    // @Note: Every contour but the last is closed here, the last one after decomposing
+    if (path->open && path->size < FREETYPE_PATH_SIZE) {
+        path->data[path->size++] = 'Z';
+    }
+    
+    const FT_Vector *points[] = { to };
+    freetype_path_push(path, 'M', points, 1);
+    path->open = 1;
+    return(0);
+}
+
+internal int freetype_path_line(const FT_Vector *to, void *user)
+{
+    const FT_Vector *points[] = { to };
+    freetype_path_push((Freetype_Path *) user, 'L', points, 1);
+    return(0);
+}
+
+internal int freetype_path_conic(const FT_Vector *control, const FT_Vector *to, void *user)
+{
+    const FT_Vector *points[] = { control, to };
+    freetype_path_push((Freetype_Path *) user, 'Q', points, 2);
+    return(0);
+}
+
+internal int freetype_path_cubic(const FT_Vector *control0, const FT_Vector *control1, const FT_Vector *to, void *user)
+{
+    const FT_Vector *points[] = { control0, control1, to };
+    freetype_path_push((Freetype_Path *) user, 'C', points, 3);
+    return(0);
+}
+
+internal String8 font_glyph_path(Font *font, Arena *arena, RectF32 uv, HMM_Vec2 *size)
+{
+    OPTICK_EVENT();
+    
+    // @Note: Quads only remember where in the atlas they sample from, so go back from there to the glyph.
+    u32 codepoint = 0;
+    Font_Glyph_Info *info = 0;
+    for (u32 i = 0; i < FONT_GLYPH_COUNT && info == 0; ++i) {
+        if (font->glyphs[i].size.X > 0.0f && MemoryMatch(&font->glyphs[i].uv, &uv, sizeof(RectF32))) {
+            codepoint = i;
+            info = font->glyphs + i;
+        }
+    }
+    
+    for (u32 i = 0; i < FONT_GLYPH_BUCKET_COUNT && info == 0; ++i) {
+        for (Font_Glyph *glyph = font->buckets[i]; glyph != 0 && info == 0; glyph = glyph->next) {
+            if (glyph->region.width != 0 && MemoryMatch(&glyph->info.uv, &uv, sizeof(RectF32))) {
+                codepoint = glyph->codepoint;
+                info = &glyph->info;
+            }
+        }
+    }
+    
+    b32 error = info == 0;
+    if (!error && font->face == 0) {
+        error = !freetype_face_load(font);
+    }
+    
+    // @Note: Loaded the same way the bitmap was, so the outline lines up with it.
+    FT_Face face = (FT_Face) font->face;
+    if (!error) {
+        s32 flags = FT_LOAD_NO_BITMAP;
+        flags |= (font->raster == FONT_RASTER_SDF) ? FT_LOAD_NO_HINTING : (FT_LOAD_FORCE_AUTOHINT | FT_LOAD_TARGET_LIGHT);
+        error = FT_Load_Char(face, codepoint, flags) != 0 || face->glyph->format != FT_GLYPH_FORMAT_OUTLINE;
+    }
+    
+    String8 result = {0};
+    if (!error) {
+        FT_Outline_Funcs funcs = {0};
+        funcs.move_to = freetype_path_move;
+        funcs.line_to = freetype_path_line;
+        funcs.conic_to = freetype_path_conic;
+        funcs.cubic_to = freetype_path_cubic;
+        
+        Freetype_Path path;
+        path.size = 0;
+        path.offset = info->offset;
+        path.open = 0;
+        path.full = 0;
+        if (FT_Outline_Decompose(&face->glyph->outline, &funcs, &path) == 0 && !path.full) {
+            if (path.open && path.size < FREETYPE_PATH_SIZE) {
+                path.data[path.size++] = 'Z';
+            }
+            
+            result = str8_push_copy(arena, str8_make(path.data, path.size));
+            *size = info->size;
+        }
+    }
+    
+    return(result);
+}
+
 internal void font_end(Font *font)
 {
     if (font->texture) {
-        r_texture_destroy(font->texture);
+        if (r_solid_get().texture == font->texture) {
+            RectF32 uv = { 0.0f, 0.0f, 1.0f, 1.0f };
+            r_solid_set(0, uv);
+        }
+        
+        r_atlas_release(&font->atlas);
+        
+        --freetype_init_count;
     }
+    
+    freetype_face_release(font);
 
     MemoryZero(font, sizeof(Font));
 }
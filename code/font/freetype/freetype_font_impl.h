@@ -1,4 +1,145 @@
 #ifndef FREETYPE_FONT_IMPL_H
 #define FREETYPE_FONT_IMPL_H
 
+// @Note: What font_init() builds (the pinned atlas pages with the white block, ASCII and the
+// prebuilt glyphs, plus their glyph tables) is cached on disk, keyed by font path, size, dpi,
+// raster mode, prebuilt glyphs and FreeType version. A cache file is:
+//
+// | Font_Cache_Header | font path padded to 8 | Font_Cache_Page[page_count] |
+// | Font_Cache_Glyph[prebuilt_count] | u32 pixels[atlas_width*page_count*page_height] |
+//
+// Pixels are the top 'page_count' pages of the atlas, in the in-memory layout of the types.
+
+#ifndef FONT_CACHE_DIR
+# define FONT_CACHE_DIR "./"
+#endif
+
+#define FONT_CACHE_MAGIC 0x43544E46u // @Note: 'FNTC'
+#define FONT_CACHE_VERSION 3
+#define FONT_CACHE_FREETYPE_VERSION (FREETYPE_MAJOR*10000 + FREETYPE_MINOR*100 + FREETYPE_PATCH)
+
+typedef struct {
+    u32 magic;
+    u32 version;
+    u32 freetype_version;
+    u32 font_size;
+    u32 dpi;
+    u32 raster;
+    u32 path_size;
+    
+    u32 atlas_width;
+    u32 atlas_height;
+    u32 scratch_width;
+    u32 scratch_height;
+    u32 page_count;
+    u32 skyline_cap;
+    u32 prebuilt_count;
+    
+    RectF32 white_uv;
+    Font_Glyph_Info glyphs[FONT_GLYPH_COUNT];
+} Font_Cache_Header;
+
+typedef struct {
+    u32 node_count;
+    u32 reserved;
+    u64 used_area;
+    R_Skyline_Node nodes[R_ATLAS_MAX_SKYLINE];
+} Font_Cache_Page;
+
+typedef struct {
+    u32 codepoint;
+    R_Atlas_Region region;
+    Font_Glyph_Info info;
+} Font_Cache_Glyph;
+
+// @Note: Everything FreeType allocates for a font (library, modules, face, glyph slots) comes out of
+// one arena owned by the font, so font_end() hands it all back at once. Blocks are power of two
+// size classes with a free list each, FreeType frees and reallocs a lot while loading a face.
+#define FREETYPE_HEAP_MIN_CLASS 4 // @Note: 16 bytes
+#define FREETYPE_HEAP_CLASS_COUNT 32
+
+typedef struct Freetype_Block {
+    struct Freetype_Block *next;
+} Freetype_Block;
+
+// @Note: In front of every block, 16 bytes so that blocks stay aligned for anything FreeType stores.
+typedef struct {
+    u64 size_class;
+    u64 reserved;
+} Freetype_Block_Header;
+
+typedef struct {
+    struct FT_MemoryRec_ memory; // @Note: FreeType keeps a pointer to this, so the heap lives inside of its own arena
+    Arena *arena;
+    Freetype_Block *free[FREETYPE_HEAP_CLASS_COUNT];
+    
+    usize live_bytes;
+    usize peak_bytes;
+} Freetype_Heap;
+
+typedef struct {
+    Freetype_Heap *heap;
+    FT_Library library;
+    FT_Face face;
+} Freetype_Face;
+
+// @Note: font_init() rasterizes everything it prebuilds on up to FONT_BUILD_MAX_WORKERS threads,
+// each with a face of its own, then packs on the calling thread and has the workers copy their
+// glyphs into the (disjoint) packed regions. Fewer than FONT_BUILD_MIN_GLYPHS glyphs per worker
+// isn't worth opening another face for.
+#define FONT_BUILD_MAX_WORKERS 16
+#define FONT_BUILD_MIN_GLYPHS 64
+
+typedef struct {
+    u32 codepoint;
+    Font_Glyph_Info info;
+    R_Atlas_Region region;
+    u32 *pixels; // @Note: Tightly packed, in the arena of the worker that rasterized it
+} Freetype_Build_Glyph;
+
+typedef struct {
+    Font *font; // @Note: Read only while the workers run
+    Freetype_Face face;
+    Arena *arena;
+    
+    Freetype_Build_Glyph *glyphs;
+    u32 glyph_count;
+    u32 first;
+    u32 stride;
+    
+    // @Note: Zero while rasterizing, the atlas image while copying into it
+    u32 *image;
+    u32 image_pitch;
+    
+    b32 error;
+} Freetype_Build_Worker;
+
+// @Note: Outlines are written out through this while FT_Outline_Decompose() walks them
+#define FREETYPE_PATH_SIZE KB(16)
+
+typedef struct {
+    u8 data[FREETYPE_PATH_SIZE];
+    usize size;
+    HMM_Vec2 offset; // @Note: Glyph's bitmap offset, moves the pen origin to the top left of its quad
+    b32 open;
+    b32 full;
+} Freetype_Path;
+
+internal Freetype_Heap *freetype_heap_make(void);
+internal void freetype_heap_release(Freetype_Heap *heap);
+internal void *freetype_heap_alloc(FT_Memory memory, long size);
+internal void freetype_heap_free(FT_Memory memory, void *block);
+internal void *freetype_heap_realloc(FT_Memory memory, long cur_size, long new_size, void *block);
+
+internal b32 freetype_face_open(Freetype_Face *face, String8 path, u32 font_size, u32 dpi);
+internal void freetype_face_close(Freetype_Face *face);
+internal b32 freetype_face_load(Font *font);
+internal void freetype_face_release(Font *font);
+internal Font freetype_font_init(Arena *arena, String8 font_name, u32 font_size, u32 dpi, Font_Raster raster, String8 prebuilt, u32 worker_count, b32 use_cache);
+internal void freetype_glyph_insert(Font *font, u32 codepoint, R_Atlas_Region region, Font_Glyph_Info *info);
+internal b32 freetype_font_build(Font *font, Arena *arena, String8 cache_path, u32 *codepoints, u32 codepoint_count, u32 worker_count);
+internal String8 freetype_cache_path(char *buffer, usize size, String8 font_name, u32 font_size, u32 dpi, Font_Raster raster, u32 *codepoints, u32 codepoint_count);
+internal void freetype_cache_save(Font *font, Arena *arena, String8 cache_path, u32 *image, u32 pages, Freetype_Build_Glyph *prebuilt, u32 prebuilt_count);
+internal b32 freetype_cache_load(Font *font, Arena *arena, String8 data, u32 *codepoints, u32 codepoint_count);
+
 #endif // FREETYPE_FONT_IMPL_H
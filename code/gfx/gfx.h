@@ -53,7 +53,7 @@ typedef struct GFX_Event {
     u64 character;
     
     HMM_Vec2 mouse;
-    f32 mouse_wheel;
+    f32 mouse_wheel; // @Note: WHEEL_DELTA (120) a notch, a coalesced event holds the sum
 
     HMM_Vec2 window_size;
 } GFX_Event;
@@ -70,6 +70,9 @@ internal b32 gfx_is_init(void);
 internal GFX_Event *gfx_events_push(GFX_Event_Kind kind, GFX_Window *window);
 internal void gfx_events_eat(GFX_Event_List *list);
 internal GFX_Event_List gfx_process_input(Arena *arena);
+// @Note: By default runs of mouse moves, and of wheel turns with their deltas summed, on the same window
+// come out as one event each, carrying the latest position. 'raw' keeps every event the OS sent.
+internal GFX_Event_List gfx_process_input_ex(Arena *arena, b32 raw);
 
 internal GFX_Window *gfx_window_create(String8 title, s32 width, s32 height);
 internal void gfx_window_destroy(GFX_Window *window);
@@ -92,6 +95,9 @@ internal void gfx_mouse_set_cursor(GFX_Window *window, GFX_Cursor_Kind kind);
 internal void gfx_mouse_set_capture(GFX_Window *window, b32 capture);
 
 internal void gfx_error_display(GFX_Window *window, String8 text, String8 caption);
-internal b32 gfx_open_save_dialog(GFX_Window *window, String8 *out);
+
+// @Note: 'out' is filled with a null terminated path. Only files ending in 'extension' (without the dot)
+// are offered, and it's appended to names typed without one. 'name' is what the filter is called.
+internal b32 gfx_open_save_dialog(GFX_Window *window, String8 *out, String8 name, String8 extension);
 
 #endif // GFX_H
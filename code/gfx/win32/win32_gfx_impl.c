@@ -396,6 +396,12 @@ internal void gfx_events_eat(GFX_Event_List *list)
 }
 
 internal GFX_Event_List gfx_process_input(Arena *arena)
+{
+    GFX_Event_List result = gfx_process_input_ex(arena, 0);
+    return(result);
+}
+
+internal GFX_Event_List gfx_process_input_ex(Arena *arena, b32 raw)
 {
     win32_arena = arena;
     MemoryZero(&win32_event_list, sizeof(GFX_Event_List));
@@ -406,6 +412,25 @@ internal GFX_Event_List gfx_process_input(Arena *arena)
         DispatchMessage(&msg);
     }
     
+    // @Note: A fast drag sends hundreds of moves a frame. Only neighbours are merged, so moves never
+    // jump over a click or a key, and the dropped events stay in the frame arena until it's cleared.
+    if (!raw) {
+        for (GFX_Event *event = win32_event_list.first; event != 0; event = event->next) {
+            while (event->next != 0 && event->next->kind == event->kind && event->next->window == event->window &&
+                   (event->kind == GFX_EVENT_MOUSEMOVE || event->kind == GFX_EVENT_MOUSEWHEEL)) {
+                GFX_Event *merged = event->next;
+                event->mouse = merged->mouse;
+                event->mouse_wheel += merged->mouse_wheel;
+                
+                event->next = merged->next;
+                if (win32_event_list.last == merged) {
+                    win32_event_list.last = event;
+                }
+                win32_event_list.count -= 1;
+            }
+        }
+    }
+    
     return(win32_event_list);
 }
 
@@ -578,26 +603,39 @@ internal void gfx_error_display(GFX_Window *window, String8 text, String8 captio
     }
 }
 
-internal b32 gfx_open_save_dialog(GFX_Window *window, String8 *out)
+internal b32 gfx_open_save_dialog(GFX_Window *window, String8 *out, String8 name, String8 extension)
 {
     b32 result = 0;
     if (!gfx_is_init()) {
         er_push(str8("GFX layer not initialized"));
+    } else if (name.size + extension.size + 8 > 256) {
+        er_push(str8("Save dialog filter is too long"));
     } else {
         if (win32_window_is_valid(window)) {
             Win32_Window *w = win32_window_from_opaque(window);
             
+            // @Note: "name\0*.ext\0\0" and "ext\0", the dialog wants double null terminated pairs
+            char filter[256] = {0};
+            char default_ext[256] = {0};
+            usize at = 0;
+            MemoryCopy(filter + at, name.data, name.size);
+            at += name.size + 1;
+            MemoryCopy(filter + at, "*.", 2);
+            at += 2;
+            MemoryCopy(filter + at, extension.data, extension.size);
+            MemoryCopy(default_ext, extension.data, extension.size);
+            
             OPENFILENAME ofn = {0};
             MemoryZero(&ofn, sizeof(OPENFILENAME));
             MemoryZero(out->data, out->size);
             
             ofn.lStructSize = sizeof(OPENFILENAME);
             ofn.hwndOwner = w->handle;
-            ofn.lpstrFilter = "Image file (*.jpg;*jpeg;*jpe;*jfif)\0*.jpg;*.jpeg;*.jpe;*.jfif\0\0";
+            ofn.lpstrFilter = filter;
             ofn.lpstrTitle = "Select a file";
             ofn.lpstrFile = (LPSTR) out->data;
             ofn.nMaxFile = (DWORD) out->size;
-            ofn.lpstrDefExt = "jpg";
+            ofn.lpstrDefExt = default_ext;
             ofn.Flags = OFN_EXPLORER | OFN_OVERWRITEPROMPT | OFN_HIDEREADONLY;
             
             result = GetSaveFileName(&ofn);
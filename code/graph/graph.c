@@ -0,0 +1,223 @@
+global State state = {0};
+global u32 graph_palette[GRAPH_PALETTE_COUNT] = {
+    0xFF0000FF, // GRAPH_PALETTE_POINT
+};
+
+internal void screen_to_camera(Camera *camera, f32 x, f32 y, f32 *ox, f32 *oy)
+{
+    *ox = (x + camera->offset.X) * camera->scale;
+    *oy = (y + camera->offset.Y) * camera->scale;
+}
+
+internal void camera_to_screen(Camera *camera, f32 x, f32 y, f32 *ox, f32 *oy)
+{
+    *ox = (x/camera->scale) - camera->offset.X;
+    *oy = (y/camera->scale) - camera->offset.Y;
+}
+
+internal void graph_palette_init(void)
+{
+    r_marker_palette_set(graph_palette, GRAPH_PALETTE_COUNT);
+}
+
+internal void graph_init(Arena *arena, HMM_Vec2 size)
+{
+    state.font = font_init(arena, str8("./Inconsolata-Regular.ttf"), 16, 96);
+    r_solid_set(state.font.texture, state.font.white_uv);
+    graph_palette_init();
+    state.light_mode = 0;
+    state.auto_scale = 1;
+    state.show_slider_control = 0;
+    state.ui_scale = 1.0f;
+    state.text_font = 0;
+    state.mouse_wheel = 0.0f;
+    
+    state.camera.scale = 1.0f;
+    state.camera.scale_step = 0.1f;
+    state.camera.scale_max = 100.0f;
+    state.camera.scale_min = 0.001f;
+    state.camera.offset = { 0.0f, 0.0f };
+    
+    state.graph_step = { 1.0f, 1.0f };
+    state.pixels_per_unit = { 80.0f, 80.0f };
+    state.graph_origin = { size.X*.5f, size.Y*.5f };
+}
+
+internal void graph_view_fit(HMM_Vec2 size, HMM_Vec2 x_range, HMM_Vec2 y_range)
+{
+    state.camera.scale = 1.0f;
+    state.camera.offset = { 0.0f, 0.0f };
+    state.graph_step = { 1.0f, 1.0f };
+    
+    state.pixels_per_unit.X = size.X/MAX(x_range.Y - x_range.X, 1e-6f);
+    state.pixels_per_unit.Y = size.Y/MAX(y_range.Y - y_range.X, 1e-6f);
+    state.graph_origin.X = -x_range.X*state.pixels_per_unit.X;
+    state.graph_origin.Y = y_range.Y*state.pixels_per_unit.Y;
+}
+
+internal void graph_fit_limits(HMM_Vec2 window_size)
+{
+    if (window_size.X > 0.0f && window_size.Y > 0.0f) {    
+        HMM_Vec2 origin_point = {0};
+        HMM_Vec2 top_left = {0};
+        HMM_Vec2 bottom_right = { window_size.X, window_size.Y };
+        screen_to_camera(&state.camera, state.graph_origin.X, state.graph_origin.Y, &origin_point.X, &origin_point.Y);
+        camera_to_screen(&state.camera, top_left.X, top_left.Y, &top_left.X, &top_left.Y);
+        camera_to_screen(&state.camera, bottom_right.X, bottom_right.Y, &bottom_right.X, &bottom_right.Y);
+    
+        state.x_range.X = (top_left.X - state.graph_origin.X)/state.pixels_per_unit.X;
+        state.x_range.Y = (bottom_right.X - state.graph_origin.X)/state.pixels_per_unit.X;
+        state.y_range.X = (state.graph_origin.Y - bottom_right.Y)/state.pixels_per_unit.Y;
+        state.y_range.Y = (state.graph_origin.Y - top_left.Y)/state.pixels_per_unit.Y;
+
+        if (state.auto_scale) {
+            f32 current_x_fit = (state.x_range.Y - state.x_range.X) / state.graph_step.X;
+            f32 current_y_fit = (state.y_range.Y - state.y_range.X) / state.graph_step.Y;
+            
+            while (current_x_fit > 12.0f) {
+                state.graph_step.X *= 2.0f;
+                current_x_fit = (state.x_range.Y - state.x_range.X) / state.graph_step.X;
+            }
+            while (current_x_fit < 4.0f) {
+                state.graph_step.X /= 2.0f;
+                current_x_fit = (state.x_range.Y - state.x_range.X) / state.graph_step.X;
+            }
+            while (current_y_fit > 12.0f) {
+                state.graph_step.Y *= 2.0f;
+                current_y_fit = (state.y_range.Y - state.y_range.X) / state.graph_step.Y;
+            }
+            while (current_y_fit < 4.0f) {
+                state.graph_step.Y /= 2.0f;
+                current_y_fit = (state.y_range.Y - state.y_range.X) / state.graph_step.Y;
+            }
+            
+            state.x_range.Y /= state.graph_step.X;
+            state.x_range.X /= state.graph_step.X;
+            state.y_range.Y /= state.graph_step.Y;
+            state.y_range.X /= state.graph_step.Y;
+        }
+    }
+}
+    
+internal void r_graph(HMM_Vec2 window_size, R_Ctx *ctx, R_Ctx *ui_ctx, b32 light_mode)
+{
+    OPTICK_EVENT();
+
+    const u32 text_col[] = { 0xFFFFFFFF, 0x121212FF };
+    const u32 grid_col[] = { 0x262626FF, 0xBFBFBFFF };
+    const u32 line_col[] = { 0x4A4A4AFF, 0x0F0F0FFF };
+
+    HMM_Vec2 origin_point = {0};
+    screen_to_camera(&state.camera, state.graph_origin.X, state.graph_origin.Y, &origin_point.X, &origin_point.Y);
+ 
+    // @Note: Pictures bigger than the window scale everything that has a size on screen, their text
+    // comes from an SDF font handed in through 'text_font' so it stays sharp at that size.
+    const f32 ui_scale = state.ui_scale;
+    Font *font = state.text_font ? state.text_font : &state.font;
+    const f32 font_size = ui_scale*state.font.font_size;
+    const f32 text_scale = font_size/(f32) font->font_size;
+    const f32 line_width = 2.0f*ui_scale;
+    const f32 padding = 10.0f*ui_scale;
+    const HMM_Vec2 ppu = {
+        state.camera.scale*state.graph_step.X*state.pixels_per_unit.X,
+        state.camera.scale*state.graph_step.Y*state.pixels_per_unit.Y
+    };
+
+    for (s32 i = (s32) state.x_range.X; i <= (s32) state.x_range.Y; ++i) {
+        if (i == 0) continue;
+
+        HMM_Vec2 start = {
+            origin_point.X + i*ppu.X,
+            0.0f
+        };
+
+        RectF32 rect = {
+            start.X - line_width*.5f, 0.0f,
+            start.X + line_width*.5f, window_size.Y
+        };
+        
+        // @ToDo: Find a better way to create a string
+        char buff[32] = {0};
+        snprintf(buff, 32, "%.2f", i * state.graph_step.X);
+        String8 str = str8_from_cstr(buff);
+        
+        f32 w = font_text_width_ex(font, str, text_scale);
+        HMM_Vec2 text_pos = { start.X - w*.5f, origin_point.Y + font_size + padding };
+        
+        // @ToDo: font->font_size*2.0f is hardcoded for now because of the bar at the top.
+        f32 offset = light_mode ? 0.0f : font_size*2.0f;
+        if (text_pos.Y <= 2.0f*padding + offset) { 
+            text_pos.Y = 2.0f*padding + offset;
+        } else if (text_pos.Y + padding >= window_size.Y) {
+            text_pos.Y = window_size.Y - padding;
+        }
+        
+        r_rect(ctx, rect, grid_col[light_mode], 0.0f);
+        font_r_text_ex(ui_ctx, font, text_pos, str, text_col[light_mode], text_scale);
+    }
+
+    for (s32 i = (s32) state.y_range.X; i <= (s32) state.y_range.Y; ++i) {
+        if (i == 0) continue;
+
+        HMM_Vec2 start = {
+            0.0f,
+            origin_point.Y - i*ppu.Y
+        };
+
+        RectF32 rect = {
+            0.0f, start.Y - line_width*.5f,
+            window_size.X, start.Y + line_width*.5f
+        };
+
+        // @ToDo: Find a better way to create a string
+        char buff[32] = {0};
+        snprintf(buff, 32, "%.2f", i * state.graph_step.Y);
+        String8 str = str8_from_cstr(buff);
+        
+        f32 w = font_text_width_ex(font, str, text_scale);
+        HMM_Vec2 text_pos = { origin_point.X - w - padding, start.Y - line_width + font_size*.5f};
+        
+        if (text_pos.X <= padding) {
+            text_pos.X = padding;
+        } else if (text_pos.X + w + padding >= window_size.X) {
+            text_pos.X = window_size.X - w - padding;
+        }
+        
+        r_rect(ctx, rect, grid_col[light_mode], 0.0f);
+        font_r_text_ex(ui_ctx, font, text_pos, str, text_col[light_mode], text_scale);
+    }
+    
+    RectF32 axis_x = {
+        0.0f, origin_point.Y - line_width, 
+        window_size.X, origin_point.Y + line_width
+    };
+            
+    RectF32 axis_y = {
+        origin_point.X - line_width, 0.0f,
+        origin_point.X + line_width, window_size.Y
+    };
+    
+    r_rect(ctx, axis_y, line_col[light_mode], 0.0f);
+    r_rect(ctx, axis_x, line_col[light_mode], 0.0f);
+
+    const HMM_Vec2 scale = {
+        state.camera.scale*state.pixels_per_unit.X,
+        state.camera.scale*state.pixels_per_unit.Y
+    };     
+    
+    // @Note: Draw points, optionally with a dashed line connecting them
+    {
+        HMM_Vec2 point_scale = { scale.X, -scale.Y };
+        if (state.show_line) {
+            R_Line_Style style = {0};
+            style.col = 0xFF0000AA;
+            style.width = 2.0f*ui_scale;
+            style.dash = 10.0f*ui_scale;
+            style.gap = 6.0f*ui_scale;
+            style.join = R_JOIN_MITER;
+            r_polyline(ctx, state.graph_data.xs, state.graph_data.ys, state.graph_data.size, origin_point, point_scale, style);
+        }
+        
+        r_markers(ctx, state.graph_data.xs, state.graph_data.ys, state.graph_data.size, origin_point, point_scale, 8.0f*ui_scale, R_MARKER_CIRCLE, GRAPH_PALETTE_POINT);
+    }
+}
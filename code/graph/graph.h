@@ -0,0 +1,76 @@
+#ifndef GRAPH_H
+#define GRAPH_H
+
+// @Note: Plot goes first, labels and controls are drawn on top of it.
+enum {
+    GRAPH_LAYER_PLOT = 0,
+    GRAPH_LAYER_UI,
+};
+
+// @Note: Marker palette entries, uploaded by graph_palette_init().
+enum {
+    GRAPH_PALETTE_POINT = 0,
+    GRAPH_PALETTE_COUNT,
+};
+
+typedef struct Graph_Data Graph_Data;
+struct Graph_Data
+{
+    f32 *xs;
+    f32 *ys;
+    u32 size;
+};
+
+typedef struct Camera Camera;
+struct Camera
+{
+    HMM_Vec2 offset;
+    f32 scale;    
+    
+    f32 scale_step;
+    f32 scale_min;
+    f32 scale_max;
+};
+
+typedef struct State State;
+struct State
+{
+    Font font;
+    b32 light_mode;
+    b32 auto_scale;
+    b32 show_slider_control;
+    b32 show_line;
+    Graph_Data graph_data;
+    
+    HMM_Vec2 x_range;
+    HMM_Vec2 y_range;
+    HMM_Vec2 graph_step;
+    HMM_Vec2 pixels_per_unit;
+    HMM_Vec2 graph_origin;
+
+    b32 track_mouse;
+    HMM_Vec2 mouse;
+    f32 mouse_wheel; // @Note: Turned but short of a whole notch
+
+    Camera camera;
+    
+    // @Note: Text, grid lines and markers are drawn this many times their screen size, with 'text_font'
+    // when it's set. 1 and none on screen, exports bigger than the window set them while they draw.
+    f32 ui_scale;
+    Font *text_font;
+};
+
+internal void screen_to_camera(Camera *camera, f32 x, f32 y, f32 *ox, f32 *oy);
+internal void camera_to_screen(Camera *camera, f32 x, f32 y, f32 *ox, f32 *oy);
+internal void graph_palette_init(void);
+
+// @Note: Font, palette and a view with the origin in the middle of 'size'. Shared by the app and the
+// batch tool, the render backend has to be up.
+internal void graph_init(Arena *arena, HMM_Vec2 size);
+
+// @Note: Sets the camera so the given ranges of the data fill 'size', the grid step starts over.
+internal void graph_view_fit(HMM_Vec2 size, HMM_Vec2 x_range, HMM_Vec2 y_range);
+internal void graph_fit_limits(HMM_Vec2 window_size);
+internal void r_graph(HMM_Vec2 window_size, R_Ctx *ctx, R_Ctx *ui_ctx, b32 light_mode);
+
+#endif // GRAPH_H
@@ -0,0 +1,591 @@
+internal void graph_export_encode(Graph_Export *exporter, Graph_Export_Slot *slot)
+{
+    OPTICK_EVENT();
+    
+    Arena_Temp temp = arena_temp_begin(exporter->arena);
+    
+    // @Note: Rows of a mapped texture can be padded, the writer takes the pitch as it is.
+    Image_Options options = {GRAPH_EXPORT_QUALITY, IMAGE_SUBSAMPLING_444, 0};
+    b32 error = !image_writer_begin_ex(&slot->image, temp.arena, str8_from_cstr(slot->path), slot->format,
+                                       slot->width, slot->height, options);
+    if (!error) {
+        image_writer_rows(&slot->image, slot->pixels, slot->height, slot->pitch);
+        error = !image_writer_end(&slot->image);
+    }
+    slot->failed = error;
+    
+    arena_temp_end(&temp);
+}
+
+internal String8 graph_export_glyph_path(void *user, Arena *arena, R_Texture2D *texture, RectF32 uv, HMM_Vec2 *size)
+{
+    Font *font = (Font *) user;
+    String8 result = {0};
+    if (texture == font->texture) {
+        result = font_glyph_path(font, arena, uv, size);
+    }
+    
+    return(result);
+}
+
+internal void graph_export_encode_vector(Graph_Export *exporter)
+{
+    OPTICK_EVENT();
+    
+    Graph_Export_Vector *vector = &exporter->vector;
+    vector->failed = !image_svg_write(&vector->svg, &vector->list, str8_from_cstr(vector->path));
+}
+
+internal void graph_export_encode_strips(Graph_Export *exporter)
+{
+    OPTICK_EVENT();
+    
+    Graph_Export_Tiled *tiled = &exporter->tiled;
+    while (tiled->next_row < tiled->rows) {
+        Graph_Export_Strip *strip = tiled->strips + tiled->next_row % GRAPH_EXPORT_STRIP_COUNT;
+        if (AtomicLoadU32(&strip->state) != GRAPH_EXPORT_STRIP_ENCODING) {
+            break;
+        }
+        
+        if (tiled->next_row == 0) {
+            tiled->image_temp = arena_temp_begin(exporter->arena);
+            tiled->failed = !image_writer_begin(&tiled->image, tiled->image_temp.arena, str8_from_cstr(tiled->path),
+                                                IMAGE_FORMAT_TGA, tiled->width, tiled->height);
+        }
+        
+        // @Note: Strips still have to be taken after a failed start, or the tiles would wait on them forever.
+        if (!tiled->failed) {
+            image_writer_rows(&tiled->image, strip->pixels, strip->height, tiled->width*4);
+        }
+        
+        tiled->next_row += 1;
+        AtomicStoreU32(&strip->state, GRAPH_EXPORT_STRIP_FREE);
+        
+        if (tiled->next_row == tiled->rows) {
+            if (!tiled->failed) {
+                tiled->failed = !image_writer_end(&tiled->image);
+            }
+            arena_temp_end(&tiled->image_temp);
+            AtomicStoreU32(&tiled->done, 1);
+        }
+    }
+}
+
+internal void graph_export_worker(void *data)
+{
+    OPTICK_THREAD("Export");
+    
+    Graph_Export *exporter = (Graph_Export *) data;
+    for (;;) {
+        os_semaphore_wait(exporter->wake);
+        if (AtomicLoadU32(&exporter->quit)) break;
+        
+        for (u32 i = 0; i < GRAPH_EXPORT_SLOT_COUNT; ++i) {
+            Graph_Export_Slot *slot = exporter->slots + i;
+            if (AtomicLoadU32(&slot->state) == GRAPH_EXPORT_SLOT_ENCODING) {
+                graph_export_encode(exporter, slot);
+                AtomicStoreU32(&slot->state, GRAPH_EXPORT_SLOT_DONE);
+            }
+        }
+        
+        if (AtomicLoadU32(&exporter->vector.state) == GRAPH_EXPORT_SLOT_ENCODING) {
+            graph_export_encode_vector(exporter);
+            AtomicStoreU32(&exporter->vector.state, GRAPH_EXPORT_SLOT_DONE);
+        }
+        
+        if (AtomicLoadU32(&exporter->tiled.active) && !AtomicLoadU32(&exporter->tiled.done)) {
+            graph_export_encode_strips(exporter);
+        }
+    }
+}
+
+internal b32 graph_export_init(Graph_Export *exporter, GFX_Window *window)
+{
+    MemoryZero(exporter, sizeof(Graph_Export));
+    exporter->window = window;
+    exporter->arena = arena_make();
+    exporter->wake = os_semaphore_create(0);
+    
+    b32 error = 0;
+    if (exporter->wake.handle == 0) {
+        er_push(str8("Failed to create export semaphore"));
+        error = 1;
+    }
+    
+    if (!error && !os_thread_start(&exporter->thread, graph_export_worker, exporter)) {
+        er_push(str8("Failed to start export thread"));
+        error = 1;
+    }
+    
+    if (error) {
+        os_semaphore_destroy(exporter->wake);
+        arena_release(exporter->arena);
+        MemoryZero(exporter, sizeof(Graph_Export));
+    }
+    
+    b32 result = !error;
+    return(result);
+}
+
+internal void graph_export_end(Graph_Export *exporter)
+{
+    if (exporter->arena) {
+        // @Note: Whatever is encoding gets finished first, a half written file is worse than a late exit.
+        // A tiled export that is still being drawn can't be, its tiles need frames, so its file is deleted.
+        AtomicStoreU32(&exporter->quit, 1);
+        os_semaphore_signal(exporter->wake);
+        os_thread_join(&exporter->thread);
+        
+        for (u32 i = 0; i < GRAPH_EXPORT_SLOT_COUNT; ++i) {
+            Graph_Export_Slot *slot = exporter->slots + i;
+            u32 slot_state = AtomicLoadU32(&slot->state);
+            if (slot_state == GRAPH_EXPORT_SLOT_ENCODING) {
+                graph_export_encode(exporter, slot);
+                slot_state = GRAPH_EXPORT_SLOT_DONE;
+            }
+            
+            if (slot_state == GRAPH_EXPORT_SLOT_DONE) {
+                r_target_unmap(slot->target);
+            }
+            
+            if (slot->target) {
+                r_target_destroy(slot->target);
+            }
+        }
+        
+        Graph_Export_Vector *vector = &exporter->vector;
+        if (AtomicLoadU32(&vector->state) == GRAPH_EXPORT_SLOT_ENCODING) {
+            graph_export_encode_vector(exporter);
+        }
+        
+        if (vector->arena) {
+            arena_release(vector->arena);
+        }
+        
+        Graph_Export_Tiled *tiled = &exporter->tiled;
+        if (AtomicLoadU32(&tiled->active) && !AtomicLoadU32(&tiled->done) && tiled->next_row > 0) {
+            os_file_delete(tiled->image.file.path);
+        }
+        
+        for (u32 i = 0; i < GRAPH_EXPORT_TILE_TARGETS; ++i) {
+            if (tiled->tiles[i].target) {
+                r_target_destroy(tiled->tiles[i].target);
+            }
+        }
+        
+        if (tiled->arena) {
+            arena_release(tiled->arena);
+        }
+        
+        if (tiled->font_arena) {
+            font_end(&tiled->font);
+            arena_release(tiled->font_arena);
+        }
+        
+        os_semaphore_destroy(exporter->wake);
+        arena_release(exporter->arena);
+    }
+    
+    MemoryZero(exporter, sizeof(Graph_Export));
+}
+
+internal void graph_export_request(Graph_Export *exporter, Graph_Export_Kind kind, u32 width, u32 height)
+{
+    if (exporter->arena && exporter->dialog == GRAPH_EXPORT_DIALOG_IDLE) {
+        exporter->dialog_kind = kind;
+        exporter->dialog_width = MIN(width, GRAPH_EXPORT_PRINT_SIZE);
+        exporter->dialog_height = MIN(height, GRAPH_EXPORT_PRINT_SIZE);
+        if (kind == GRAPH_EXPORT_TGA && (exporter->dialog_width == 0 || exporter->dialog_height == 0)) {
+            exporter->dialog_kind = GRAPH_EXPORT_JPEG;
+        }
+        
+        // @Note: The dialog is owned by the window, so it runs on the window's thread. Opening it from
+        // another one ties both input queues together while this one keeps pumping, which can deadlock.
+        // It's modal, frames stop while it's up but whatever is encoding keeps going on the worker.
+        String8 out = str8_make((u8 *) exporter->dialog_path, sizeof(exporter->dialog_path));
+        b32 picked = 0;
+        switch (exporter->dialog_kind) {
+            case GRAPH_EXPORT_JPEG: picked = gfx_open_save_dialog(exporter->window, &out, str8("JPEG image (*.jpg)"), str8("jpg")); break;
+            case GRAPH_EXPORT_TGA: picked = gfx_open_save_dialog(exporter->window, &out, str8("TGA image (*.tga)"), str8("tga")); break;
+            case GRAPH_EXPORT_SVG: picked = gfx_open_save_dialog(exporter->window, &out, str8("SVG image (*.svg)"), str8("svg")); break;
+            case GRAPH_EXPORT_PNG: picked = gfx_open_save_dialog(exporter->window, &out, str8("PNG image (*.png)"), str8("png")); break;
+        }
+        
+        exporter->dialog = picked ? GRAPH_EXPORT_DIALOG_PICKED : GRAPH_EXPORT_DIALOG_IDLE;
+    }
+}
+
+internal void graph_export_view_save(Graph_Export_View *view)
+{
+    view->camera = state.camera;
+    view->graph_step = state.graph_step;
+    view->pixels_per_unit = state.pixels_per_unit;
+    view->graph_origin = state.graph_origin;
+    view->x_range = state.x_range;
+    view->y_range = state.y_range;
+    view->ui_scale = state.ui_scale;
+    view->text_font = state.text_font;
+}
+
+internal void graph_export_view_load(Graph_Export_View *view)
+{
+    state.camera = view->camera;
+    state.graph_step = view->graph_step;
+    state.pixels_per_unit = view->pixels_per_unit;
+    state.graph_origin = view->graph_origin;
+    state.x_range = view->x_range;
+    state.y_range = view->y_range;
+    state.ui_scale = view->ui_scale;
+    state.text_font = view->text_font;
+}
+
+internal b32 graph_export_tiled_start(Graph_Export *exporter, HMM_Vec2 window_size)
+{
+    Graph_Export_Tiled *tiled = &exporter->tiled;
+    
+    b32 error = 0;
+    for (u32 i = 0; i < GRAPH_EXPORT_TILE_TARGETS && !error; ++i) {
+        Graph_Export_Tile *tile = tiled->tiles + i;
+        if (tile->target == 0) {
+            tile->target = r_target_create(GRAPH_EXPORT_TILE_SIZE, GRAPH_EXPORT_TILE_SIZE);
+            error = tile->target == 0;
+        }
+    }
+    
+    if (error) {
+        b32 result = !error;
+        return(result);
+    }
+    
+    tiled->width = exporter->dialog_width;
+    tiled->height = exporter->dialog_height;
+    tiled->columns = (tiled->width + GRAPH_EXPORT_TILE_SIZE - 1)/GRAPH_EXPORT_TILE_SIZE;
+    tiled->rows = (tiled->height + GRAPH_EXPORT_TILE_SIZE - 1)/GRAPH_EXPORT_TILE_SIZE;
+    tiled->next_tile = 0;
+    tiled->tiles_done = 0;
+    tiled->next_row = 0;
+    tiled->failed = 0;
+    MemoryCopy(tiled->path, exporter->dialog_path, sizeof(tiled->path));
+    
+    // @Note: Screen positions scale by kx and ky. The camera scale takes kx, the y axis gets the rest
+    // of the way through the origin and pixels per unit, so the picture covers the same ranges.
+    f32 kx = (f32) tiled->width/window_size.X;
+    f32 ky = (f32) tiled->height/window_size.Y;
+    graph_export_view_save(&tiled->view);
+    tiled->view.camera.scale *= kx;
+    tiled->view.graph_origin.Y = (ky/kx)*(state.graph_origin.Y + state.camera.offset.Y) - state.camera.offset.Y;
+    tiled->view.pixels_per_unit.Y *= ky/kx;
+    tiled->view.ui_scale *= kx;
+    
+    if (tiled->font.texture == 0) {
+        if (tiled->font_arena == 0) {
+            tiled->font_arena = arena_make();
+        }
+        
+        tiled->font = font_init_ex(tiled->font_arena, state.font.path, GRAPH_EXPORT_PRINT_FONT_SIZE, state.font.dpi,
+                                   FONT_RASTER_SDF, str8(""));
+    }
+    
+    // @Note: Without it the labels are still scaled, just blurry.
+    tiled->view.text_font = tiled->font.texture ? &tiled->font : 0;
+    
+    if (tiled->arena == 0) {
+        tiled->arena = arena_make();
+    }
+    
+    usize strip_bytes = (usize) tiled->width*GRAPH_EXPORT_TILE_SIZE*4;
+    for (u32 i = 0; i < GRAPH_EXPORT_STRIP_COUNT; ++i) {
+        Graph_Export_Strip *strip = tiled->strips + i;
+        strip->pixels = arena_push_array(tiled->arena, u8, strip_bytes);
+        strip->state = GRAPH_EXPORT_STRIP_FREE;
+    }
+    
+    AtomicStoreU32(&tiled->done, 0);
+    AtomicStoreU32(&tiled->active, 1);
+    
+    b32 result = !error;
+    return(result);
+}
+
+internal void graph_export_tiled_draw(Graph_Export *exporter, Arena *frame_arena, Graph_Export_Tile *tile)
+{
+    OPTICK_EVENT();
+    
+    Graph_Export_Tiled *tiled = &exporter->tiled;
+    HMM_Vec2 canvas = { (f32) tiled->width, (f32) tiled->height };
+    HMM_Vec2 offset = { (f32) tile->x, (f32) tile->y };
+    RectF32 bounds = {
+        offset.X, offset.Y,
+        offset.X + GRAPH_EXPORT_TILE_SIZE, offset.Y + GRAPH_EXPORT_TILE_SIZE
+    };
+    
+    Graph_Export_View current = {0};
+    graph_export_view_save(&current);
+    graph_export_view_load(&tiled->view);
+    graph_fit_limits(canvas);
+    
+    // @Note: Clipped to the tile, so everything that can't land in it is dropped before the backend.
+    R_List list = {0};
+    R_Ctx ctx = r_make_context(frame_arena, &list, GRAPH_LAYER_PLOT);
+    R_Ctx ui_ctx = r_make_context(frame_arena, &list, GRAPH_LAYER_UI);
+    r_push_clip(&ctx, bounds);
+    r_push_clip(&ui_ctx, bounds);
+    
+    r_target_begin_ex(tile->target, 0xFFFFFFFF, offset, canvas);
+    r_graph(canvas, &ctx, &ui_ctx, 1);
+    r_flush_batches(0, &list);
+    r_target_end(tile->target);
+    r_target_read_begin(tile->target);
+    
+    graph_export_view_load(&current);
+}
+
+internal void graph_export_tiled_update(Graph_Export *exporter, Arena *frame_arena)
+{
+    OPTICK_EVENT();
+    
+    Graph_Export_Tiled *tiled = &exporter->tiled;
+    u32 tile_count = tiled->columns*tiled->rows;
+    
+    // @Note: Tiles finish in the order they were drawn, so this only ever waits on the oldest one.
+    while (tiled->tiles_done < tiled->next_tile) {
+        Graph_Export_Tile *tile = tiled->tiles + tiled->tiles_done % GRAPH_EXPORT_TILE_TARGETS;
+        
+        u32 pitch = 0;
+        u8 *pixels = r_target_map(tile->target, &pitch);
+        if (pixels == 0) {
+            break;
+        }
+        
+        Graph_Export_Strip *strip = tiled->strips + (tile->y/GRAPH_EXPORT_TILE_SIZE) % GRAPH_EXPORT_STRIP_COUNT;
+        u32 width = MIN(GRAPH_EXPORT_TILE_SIZE, tiled->width - tile->x);
+        usize strip_pitch = (usize) tiled->width*4;
+        u8 *dst = strip->pixels + (usize) tile->x*4;
+        for (u32 row = 0; row < strip->height; ++row) {
+            MemoryCopy(dst + row*strip_pitch, pixels + (usize) row*pitch, (usize) width*4);
+        }
+        
+        r_target_unmap(tile->target);
+        tile->busy = 0;
+        tiled->tiles_done += 1;
+        
+        strip->tiles_left -= 1;
+        if (strip->tiles_left == 0) {
+            AtomicStoreU32(&strip->state, GRAPH_EXPORT_STRIP_ENCODING);
+            os_semaphore_signal(exporter->wake);
+        }
+    }
+    
+    f64 start = os_ticks_now();
+    while (tiled->next_tile < tile_count && os_ticks_now() - start < GRAPH_EXPORT_TILE_BUDGET_MS) {
+        Graph_Export_Tile *tile = tiled->tiles + tiled->next_tile % GRAPH_EXPORT_TILE_TARGETS;
+        if (tile->busy) {
+            break;
+        }
+        
+        u32 column = tiled->next_tile % tiled->columns;
+        u32 row = tiled->next_tile/tiled->columns;
+        
+        // @Note: First tile of a row takes a strip, which waits until the worker is done with it.
+        Graph_Export_Strip *strip = tiled->strips + row % GRAPH_EXPORT_STRIP_COUNT;
+        if (column == 0) {
+            if (AtomicLoadU32(&strip->state) != GRAPH_EXPORT_STRIP_FREE) {
+                break;
+            }
+            
+            strip->row = row*GRAPH_EXPORT_TILE_SIZE;
+            strip->height = MIN(GRAPH_EXPORT_TILE_SIZE, tiled->height - strip->row);
+            strip->tiles_left = tiled->columns;
+            AtomicStoreU32(&strip->state, GRAPH_EXPORT_STRIP_FILLING);
+        }
+        
+        tile->x = column*GRAPH_EXPORT_TILE_SIZE;
+        tile->y = strip->row;
+        graph_export_tiled_draw(exporter, frame_arena, tile);
+        tile->busy = 1;
+        tiled->next_tile += 1;
+    }
+    
+    // @Note: The print font only draws here, its cached runs and glyphs age with the tiles.
+    if (tiled->font.texture) {
+        font_next_frame(&tiled->font);
+    }
+    
+    if (AtomicLoadU32(&tiled->done)) {
+        exporter->last_failed = tiled->failed;
+        exporter->last_finished = os_ticks_now();
+        
+        // @Note: Strips only live as long as the job, at print size they are the biggest thing around.
+        arena_release(tiled->arena);
+        tiled->arena = 0;
+        AtomicStoreU32(&tiled->active, 0);
+    }
+}
+
+internal void graph_export_vector_start(Graph_Export *exporter, HMM_Vec2 window_size)
+{
+    OPTICK_EVENT();
+    
+    Graph_Export_Vector *vector = &exporter->vector;
+    if (vector->arena == 0) {
+        vector->arena = arena_make();
+    }
+    arena_clear(vector->arena);
+    
+    // @Note: Its own arena and not the frame's, the worker reads the list after this frame is gone.
+    MemoryZero(&vector->list, sizeof(R_List));
+    R_Ctx ctx = r_make_context(vector->arena, &vector->list, GRAPH_LAYER_PLOT);
+    R_Ctx ui_ctx = r_make_context(vector->arena, &vector->list, GRAPH_LAYER_UI);
+    r_graph(window_size, &ctx, &ui_ctx, 1);
+    
+    // @Note: The outlines come from the font, which only the main thread may touch.
+    image_svg_init(&vector->svg, vector->arena, (u32) window_size.X, (u32) window_size.Y, 0xFFFFFFFF, graph_palette, GRAPH_PALETTE_COUNT);
+    image_svg_resolve(&vector->svg, &vector->list, graph_export_glyph_path, &state.font);
+    
+    MemoryCopy(vector->path, exporter->dialog_path, sizeof(vector->path));
+    vector->failed = 0;
+    AtomicStoreU32(&vector->state, GRAPH_EXPORT_SLOT_ENCODING);
+    os_semaphore_signal(exporter->wake);
+}
+
+internal void graph_export_update(Graph_Export *exporter, Arena *frame_arena, HMM_Vec2 window_size)
+{
+    OPTICK_EVENT();
+    
+    if (exporter->arena == 0) {
+        return;
+    }
+    
+    for (u32 i = 0; i < GRAPH_EXPORT_SLOT_COUNT; ++i) {
+        Graph_Export_Slot *slot = exporter->slots + i;
+        u32 slot_state = AtomicLoadU32(&slot->state);
+        
+        if (slot_state == GRAPH_EXPORT_SLOT_DONE) {
+            r_target_unmap(slot->target);
+            exporter->last_failed = slot->failed;
+            exporter->last_finished = os_ticks_now();
+            AtomicStoreU32(&slot->state, GRAPH_EXPORT_SLOT_FREE);
+        } else if (slot_state == GRAPH_EXPORT_SLOT_READBACK) {
+            u32 pitch = 0;
+            u8 *pixels = r_target_map(slot->target, &pitch);
+            if (pixels) {
+                slot->pixels = pixels;
+                slot->pitch = pitch;
+                AtomicStoreU32(&slot->state, GRAPH_EXPORT_SLOT_ENCODING);
+                os_semaphore_signal(exporter->wake);
+            }
+        }
+    }
+    
+    if (AtomicLoadU32(&exporter->vector.state) == GRAPH_EXPORT_SLOT_DONE) {
+        exporter->last_failed = exporter->vector.failed;
+        exporter->last_finished = os_ticks_now();
+        AtomicStoreU32(&exporter->vector.state, GRAPH_EXPORT_SLOT_FREE);
+    }
+    
+    if (AtomicLoadU32(&exporter->tiled.active)) {
+        graph_export_tiled_update(exporter, frame_arena);
+    }
+    
+    // @Note: The picture is taken once there's a path for it and something free to take it.
+    u32 width = (u32) window_size.X;
+    u32 height = (u32) window_size.Y;
+    if (exporter->dialog == GRAPH_EXPORT_DIALOG_PICKED && width > 0 && height > 0) {
+        if (exporter->dialog_kind == GRAPH_EXPORT_SVG) {
+            if (AtomicLoadU32(&exporter->vector.state) == GRAPH_EXPORT_SLOT_FREE) {
+                graph_export_vector_start(exporter, window_size);
+                exporter->dialog = GRAPH_EXPORT_DIALOG_IDLE;
+            }
+        } else if (exporter->dialog_kind == GRAPH_EXPORT_TGA) {
+            if (!AtomicLoadU32(&exporter->tiled.active)) {
+                if (!graph_export_tiled_start(exporter, window_size)) {
+                    exporter->last_failed = 1;
+                    exporter->last_finished = os_ticks_now();
+                }
+                
+                exporter->dialog = GRAPH_EXPORT_DIALOG_IDLE;
+            }
+        } else {
+            Graph_Export_Slot *slot = 0;
+            for (u32 i = 0; i < GRAPH_EXPORT_SLOT_COUNT && slot == 0; ++i) {
+                if (AtomicLoadU32(&exporter->slots[i].state) == GRAPH_EXPORT_SLOT_FREE) {
+                    slot = exporter->slots + i;
+                }
+            }
+            
+            if (slot) {
+                if (slot->target == 0 || slot->width != width || slot->height != height) {
+                    if (slot->target) {
+                        r_target_destroy(slot->target);
+                    }
+                    
+                    slot->target = r_target_create(width, height);
+                    slot->width = width;
+                    slot->height = height;
+                }
+                
+                if (slot->target) {
+                    R_List list = {0};
+                    R_Ctx ctx = r_make_context(frame_arena, &list, GRAPH_LAYER_PLOT);
+                    R_Ctx ui_ctx = r_make_context(frame_arena, &list, GRAPH_LAYER_UI);
+                    
+                    r_target_begin(slot->target, 0xFFFFFFFF);
+                    r_graph(window_size, &ctx, &ui_ctx, 1);
+                    r_flush_batches(0, &list);
+                    r_target_end(slot->target);
+                    r_target_read_begin(slot->target);
+                    
+                    MemoryCopy(slot->path, exporter->dialog_path, sizeof(slot->path));
+                    slot->format = exporter->dialog_kind == GRAPH_EXPORT_PNG ? IMAGE_FORMAT_PNG : IMAGE_FORMAT_JPEG;
+                    slot->image.file.bytes_written = 0;
+                    slot->failed = 0;
+                    AtomicStoreU32(&slot->state, GRAPH_EXPORT_SLOT_READBACK);
+                } else {
+                    exporter->last_failed = 1;
+                    exporter->last_finished = os_ticks_now();
+                }
+                
+                exporter->dialog = GRAPH_EXPORT_DIALOG_IDLE;
+            }
+        }
+    }
+}
+
+internal String8 graph_export_status(Graph_Export *exporter, Arena *arena)
+{
+    String8 result = {0};
+    if (exporter->arena == 0) {
+        return(result);
+    }
+    
+    u64 bytes = 0;
+    b32 busy = exporter->dialog == GRAPH_EXPORT_DIALOG_PICKED;
+    for (u32 i = 0; i < GRAPH_EXPORT_SLOT_COUNT; ++i) {
+        Graph_Export_Slot *slot = exporter->slots + i;
+        u32 slot_state = AtomicLoadU32(&slot->state);
+        if (slot_state != GRAPH_EXPORT_SLOT_FREE) {
+            busy = 1;
+            bytes += AtomicLoadU64(&slot->image.file.bytes_written);
+        }
+    }
+    
+    if (AtomicLoadU32(&exporter->vector.state) != GRAPH_EXPORT_SLOT_FREE) {
+        busy = 1;
+        bytes += AtomicLoadU64(&exporter->vector.svg.file.bytes_written);
+    }
+    
+    Graph_Export_Tiled *tiled = &exporter->tiled;
+    if (AtomicLoadU32(&tiled->active)) {
+        // @Note: Drawing is the slow part, the worker keeps up with it
+        f64 done = 100.0*(f64) tiled->tiles_done/(f64) (tiled->columns*tiled->rows);
+        result = str8_alloc(arena, 32);
+        result.size = (usize) snprintf((char *) result.data, result.size, "Saving... %.0f%%", done);
+    } else if (busy) {
+        result = str8_alloc(arena, 32);
+        result.size = (usize) snprintf((char *) result.data, result.size, "Saving... %.1f MB", (f64) bytes/(1024.0*1024.0));
+    } else if (exporter->last_finished != 0.0 && os_ticks_now() - exporter->last_finished < GRAPH_EXPORT_STATUS_MS) {
+        result = exporter->last_failed ? str8("Save failed") : str8("Saved");
+    }
+    
+    return(result);
+}
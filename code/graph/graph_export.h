@@ -0,0 +1,169 @@
+#ifndef GRAPH_EXPORT_H
+#define GRAPH_EXPORT_H
+
+// @Note: Saving a picture of the graph without holding up frames. The save dialog is up on the
+// main thread (it belongs to the window), the encoding runs on a worker thread. The main thread
+// only draws the picture into a target and starts the readback. Once the copy is done the mapped pixels go to the worker as they are.
+// With two slots one export can be encoding while the next one is being read back.
+#define GRAPH_EXPORT_SLOT_COUNT 2
+#define GRAPH_EXPORT_PATH_SIZE 260
+#define GRAPH_EXPORT_STATUS_MS 2000.0
+#define GRAPH_EXPORT_QUALITY 100
+
+// @Note: Pictures bigger than the window are drawn in tiles through r_target_begin_ex(), a few
+// tiles a frame. Finished tiles are copied into a strip as tall as a tile and as wide as the
+// picture, full strips go to the worker which streams their rows into the file. Two strips,
+// so memory is bounded by the picture's width and not by its size.
+#define GRAPH_EXPORT_TILE_SIZE 512
+#define GRAPH_EXPORT_TILE_TARGETS 4
+#define GRAPH_EXPORT_STRIP_COUNT 2
+#define GRAPH_EXPORT_TILE_BUDGET_MS 4.0
+#define GRAPH_EXPORT_PRINT_SIZE R_TARGET_MAX_CANVAS
+
+// @Note: Text, lines and markers of a tiled picture grow with it, labels come from an SDF font built
+// at this size the first time one is drawn, so they stay sharp however far they're scaled.
+#define GRAPH_EXPORT_PRINT_FONT_SIZE 64
+
+typedef enum {
+    GRAPH_EXPORT_JPEG = 0, // @Note: What's in the window
+    GRAPH_EXPORT_TGA,      // @Note: Drawn in tiles at the requested size
+    GRAPH_EXPORT_SVG,      // @Note: What's in the window, as shapes
+    GRAPH_EXPORT_PNG,      // @Note: What's in the window, lossless
+    GRAPH_EXPORT_KIND_COUNT,
+} Graph_Export_Kind;
+
+// @Note: Who owns a slot is in the comment, only the owner touches anything but 'state'.
+typedef enum {
+    GRAPH_EXPORT_SLOT_FREE = 0, // @Note: Main
+    GRAPH_EXPORT_SLOT_READBACK, // @Note: Main, waiting on the copy out of the target
+    GRAPH_EXPORT_SLOT_ENCODING, // @Note: Worker, reads the mapped pixels
+    GRAPH_EXPORT_SLOT_DONE,     // @Note: Main, unmaps and reports
+} Graph_Export_Slot_State;
+
+// @Note: Main only
+typedef enum {
+    GRAPH_EXPORT_DIALOG_IDLE = 0,
+    GRAPH_EXPORT_DIALOG_PICKED, // @Note: Path waits for a free slot
+} Graph_Export_Dialog_State;
+
+typedef enum {
+    GRAPH_EXPORT_STRIP_FREE = 0, // @Note: Main
+    GRAPH_EXPORT_STRIP_FILLING,  // @Note: Main, tiles are still landing
+    GRAPH_EXPORT_STRIP_ENCODING, // @Note: Worker
+} Graph_Export_Strip_State;
+
+typedef struct {
+    u32 state;
+    
+    R_Target *target; // @Note: Kept between exports, re-created when the size changes
+    u32 width;
+    u32 height;
+    
+    u8 *pixels;
+    u32 pitch;
+    char path[GRAPH_EXPORT_PATH_SIZE];
+    Image_Format format; // @Note: JPEG or PNG
+    
+    Image_Writer image; // @Note: Its file's 'bytes_written' is the progress
+    b32 failed;
+} Graph_Export_Slot;
+
+// @Note: What r_graph() draws from, taken when a tiled export starts and scaled up to the picture.
+typedef struct {
+    Camera camera;
+    HMM_Vec2 graph_step;
+    HMM_Vec2 pixels_per_unit;
+    HMM_Vec2 graph_origin;
+    HMM_Vec2 x_range;
+    HMM_Vec2 y_range;
+    f32 ui_scale;
+    Font *text_font;
+} Graph_Export_View;
+
+typedef struct {
+    R_Target *target;
+    b32 busy; // @Note: Waiting on the readback
+    u32 x;
+    u32 y;
+} Graph_Export_Tile;
+
+typedef struct {
+    u32 state;
+    u8 *pixels; // @Note: Tightly packed rows, picture width wide
+    u32 row;    // @Note: First row of the picture in here
+    u32 height;
+    u32 tiles_left;
+} Graph_Export_Strip;
+
+typedef struct {
+    u32 active; // @Note: Set by main when a job starts, cleared by main once the worker is done
+    u32 done;   // @Note: Set by the worker after the file is closed
+    
+    u32 width;
+    u32 height;
+    u32 columns;
+    u32 rows;
+    char path[GRAPH_EXPORT_PATH_SIZE];
+    Graph_Export_View view;
+    
+    // @Note: Main only
+    Arena *arena;
+    Arena *font_arena;
+    Font font; // @Note: SDF, kept once built
+    u32 next_tile;
+    u32 tiles_done;
+    Graph_Export_Tile tiles[GRAPH_EXPORT_TILE_TARGETS];
+    
+    Graph_Export_Strip strips[GRAPH_EXPORT_STRIP_COUNT];
+    
+    // @Note: Worker only
+    Image_Writer image;
+    Arena_Temp image_temp;
+    u32 next_row; // @Note: Strips are encoded in order, this is the next one
+    b32 failed;
+} Graph_Export_Tiled;
+
+// @Note: Vector pictures come from the same draw list the window gets, see image_svg.h. The list is
+// built on the main thread and written out by the worker, one at a time. States and owners are the
+// same as a slot's, without the readback.
+typedef struct {
+    u32 state;
+    Arena *arena; // @Note: The list, its outlines and the file buffer, cleared for every picture
+    R_List list;
+    Image_Svg svg;
+    char path[GRAPH_EXPORT_PATH_SIZE];
+    b32 failed;
+} Graph_Export_Vector;
+
+typedef struct {
+    GFX_Window *window;
+    OS_Thread thread;
+    OS_Semaphore wake;
+    u32 quit;
+    Arena *arena; // @Note: Worker only
+    
+    u32 dialog;
+    char dialog_path[GRAPH_EXPORT_PATH_SIZE];
+    u32 dialog_kind;
+    u32 dialog_width; // @Note: Only for GRAPH_EXPORT_TGA
+    u32 dialog_height;
+    
+    Graph_Export_Slot slots[GRAPH_EXPORT_SLOT_COUNT];
+    Graph_Export_Tiled tiled;
+    Graph_Export_Vector vector;
+    
+    // @Note: Main only, for the status line
+    b32 last_failed;
+    f64 last_finished;
+} Graph_Export;
+
+internal b32 graph_export_init(Graph_Export *exporter, GFX_Window *window);
+internal void graph_export_end(Graph_Export *exporter);
+
+// @Note: Width and height are only for GRAPH_EXPORT_TGA, which draws at that size (up to
+// GRAPH_EXPORT_PRINT_SIZE a side) showing what the window shows, stretched if the aspect differs.
+internal void graph_export_request(Graph_Export *exporter, Graph_Export_Kind kind, u32 width, u32 height);
+internal void graph_export_update(Graph_Export *exporter, Arena *frame_arena, HMM_Vec2 window_size);
+internal String8 graph_export_status(Graph_Export *exporter, Arena *arena);
+
+#endif // GRAPH_EXPORT_H
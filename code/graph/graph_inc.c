@@ -0,0 +1,7 @@
+#ifndef GRAPH_INC_C
+#define GRAPH_INC_C
+
+#include "./graph/graph.c"
+#include "./graph/graph_export.c"
+
+#endif // GRAPH_INC_C
@@ -0,0 +1,7 @@
+#ifndef GRAPH_INC_H
+#define GRAPH_INC_H
+
+#include "./graph/graph.h"
+#include "./graph/graph_export.h"
+
+#endif // GRAPH_INC_H
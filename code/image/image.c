@@ -0,0 +1,220 @@
+internal void image_file_flush(Image_File *file)
+{
+    if (file->size > 0 && !file->failed) {
+        file->failed = !os_file_append(file->path, str8_make(file->buffer, file->size));
+    }
+    
+    file->size = 0;
+}
+
+internal b32 image_file_open(Image_File *file, Arena *arena, String8 path)
+{
+    file->path = str8_push_copy(arena, path);
+    file->buffer = arena_push_array(arena, u8, IMAGE_FILE_BUFFER_SIZE);
+    file->size = 0;
+    
+    // @Note: Everything after this is appended, so start from an empty file.
+    file->failed = !os_file_write(file->path, str8_make(file->buffer, 0));
+    
+    b32 result = !file->failed;
+    return(result);
+}
+
+internal void image_file_write(Image_File *file, void *data, usize size)
+{
+    u8 *at = (u8 *) data;
+    usize left = size;
+    while (left > 0) {
+        usize take = MIN(left, IMAGE_FILE_BUFFER_SIZE - file->size);
+        MemoryCopy(file->buffer + file->size, at, take);
+        file->size += take;
+        at += take;
+        left -= take;
+        
+        if (file->size == IMAGE_FILE_BUFFER_SIZE) {
+            image_file_flush(file);
+        }
+    }
+    
+    AtomicAddU64(&file->bytes_written, size);
+}
+
+internal b32 image_file_close(Image_File *file)
+{
+    image_file_flush(file);
+    
+    b32 result = !file->failed;
+    return(result);
+}
+
+//
+// @Note: TGA
+//
+
+internal void image_tga_header(Image_Writer *writer)
+{
+    // @Note: Type 10 is run-length encoded true-color, descriptor bit 5 puts the first row at the top.
+    u8 header[18] = {0};
+    header[2] = 10;
+    header[12] = (u8) (writer->width & 0xFF);
+    header[13] = (u8) (writer->width >> 8);
+    header[14] = (u8) (writer->height & 0xFF);
+    header[15] = (u8) (writer->height >> 8);
+    header[16] = 24;
+    header[17] = 0x20;
+    
+    image_file_write(&writer->file, header, sizeof(header));
+}
+
+internal usize image_tga_row(u8 *out, u32 *row, u32 width)
+{
+    // @Note: Packets never cross rows. Runs of two or more equal pixels become one run packet,
+    // everything in between goes out as raw packets of up to 128 pixels.
+    const u32 rgb_mask = 0x00FFFFFF;
+    
+    u8 *at = out;
+    u32 i = 0;
+    while (i < width) {
+        u32 pixel = row[i] & rgb_mask;
+        
+        u32 run = 1;
+        while (i + run < width && run < 128 && (row[i + run] & rgb_mask) == pixel) {
+            run += 1;
+        }
+        
+        if (run >= 2) {
+            *at++ = (u8) (0x80 | (run - 1));
+            *at++ = (u8) ((pixel >> 16) & 0xFF);
+            *at++ = (u8) ((pixel >> 8) & 0xFF);
+            *at++ = (u8) (pixel & 0xFF);
+            i += run;
+        } else {
+            u32 count = 1;
+            while (i + count < width && count < 128 &&
+                   (i + count + 1 >= width || (row[i + count] & rgb_mask) != (row[i + count + 1] & rgb_mask))) {
+                count += 1;
+            }
+            
+            *at++ = (u8) (count - 1);
+            for (u32 j = 0; j < count; ++j) {
+                u32 raw = row[i + j];
+                *at++ = (u8) ((raw >> 16) & 0xFF);
+                *at++ = (u8) ((raw >> 8) & 0xFF);
+                *at++ = (u8) (raw & 0xFF);
+            }
+            i += count;
+        }
+    }
+    
+    usize result = (usize) (at - out);
+    return(result);
+}
+
+//
+// @Note: Writer
+//
+
+internal b32 image_writer_begin(Image_Writer *writer, Arena *arena, String8 path, Image_Format format, u32 width, u32 height)
+{
+    Image_Options options = {IMAGE_DEFAULT_QUALITY, IMAGE_SUBSAMPLING_444, 0};
+    b32 result = image_writer_begin_ex(writer, arena, path, format, width, height, options);
+    return(result);
+}
+
+internal b32 image_writer_begin_ex(Image_Writer *writer, Arena *arena, String8 path, Image_Format format, u32 width, u32 height, Image_Options options)
+{
+    writer->format = format;
+    writer->width = width;
+    writer->height = height;
+    writer->row = 0;
+    writer->scratch = 0;
+    writer->jpeg = 0;
+    writer->png = 0;
+    writer->file.failed = 0;
+    
+    b32 error = 0;
+    if (width == 0 || height == 0 || width > IMAGE_MAX_SIZE || height > IMAGE_MAX_SIZE) {
+        er_push(str8("Image size is out of range"));
+        error = 1;
+    }
+    
+    if (format >= IMAGE_FORMAT_COUNT) {
+        er_push(str8("Unknown image format"));
+        error = 1;
+    }
+    
+    if (!error && !image_file_open(&writer->file, arena, path)) {
+        er_push(str8("Failed to open image file"));
+        error = 1;
+    }
+    
+    if (!error) {
+        switch (format) {
+            case IMAGE_FORMAT_TGA: {
+                // @Note: Worst case for a TGA row is all raw packets, 3 bytes a pixel and a byte every 128.
+                writer->scratch = arena_push_array(arena, u8, (usize) width*3 + width/128 + 1);
+                image_tga_header(writer);
+            } break;
+            
+            case IMAGE_FORMAT_JPEG: {
+                writer->jpeg = arena_push_array(arena, Image_Jpeg, 1);
+                image_jpeg_begin(writer->jpeg, arena, &writer->file, width, height, options);
+            } break;
+            
+            case IMAGE_FORMAT_PNG: {
+                writer->png = arena_push_array(arena, Image_Png, 1);
+                image_png_begin(writer->png, arena, &writer->file, width, height, options);
+            } break;
+            
+            default: break;
+        }
+    }
+    
+    writer->file.failed = writer->file.failed || error;
+    
+    b32 result = !error;
+    return(result);
+}
+
+internal void image_writer_rows(Image_Writer *writer, u8 *pixels, u32 count, u32 pitch)
+{
+    count = MIN(count, writer->height - writer->row);
+    
+    if (!writer->file.failed && writer->format == IMAGE_FORMAT_JPEG) {
+        image_jpeg_rows(writer->jpeg, &writer->file, pixels, count, pitch);
+    } else if (!writer->file.failed && writer->format == IMAGE_FORMAT_PNG) {
+        image_png_rows(writer->png, &writer->file, pixels, count, pitch);
+    } else if (!writer->file.failed) {
+        for (u32 i = 0; i < count; ++i) {
+            u32 *row = (u32 *) (pixels + (usize) i*pitch);
+            usize size = image_tga_row(writer->scratch, row, writer->width);
+            image_file_write(&writer->file, writer->scratch, size);
+        }
+    }
+    
+    writer->row += count;
+}
+
+internal b32 image_writer_end(Image_Writer *writer)
+{
+    b32 error = 0;
+    if (writer->row != writer->height) {
+        er_push(str8("Image was closed before all rows were written"));
+        error = 1;
+    }
+    
+    if (writer->jpeg != 0) {
+        image_jpeg_end(writer->jpeg, &writer->file);
+    }
+    
+    if (writer->png != 0) {
+        image_png_end(writer->png, &writer->file);
+    }
+    
+    if (!image_file_close(&writer->file)) {
+        error = 1;
+    }
+    
+    b32 result = !error;
+    return(result);
+}
@@ -0,0 +1,69 @@
+#ifndef IMAGE_H
+#define IMAGE_H
+
+// @Note: Writing pictures without ever holding a whole one. Rows are handed in top to bottom as they
+// become available and the encoded bytes go out through a fixed-size buffer, so memory stays the same
+// no matter how big the picture is. Pixels are always RGBA, 8 bits per channel.
+#define IMAGE_FILE_BUFFER_SIZE MB(1)
+#define IMAGE_MAX_SIZE 65535
+
+typedef enum {
+    IMAGE_FORMAT_TGA = 0, // @Note: 24 bit, run-length encoded, alpha is dropped
+    IMAGE_FORMAT_JPEG,    // @Note: Baseline, see image_jpeg.h, alpha is dropped
+    IMAGE_FORMAT_PNG,     // @Note: 24 bit, see image_png.h, alpha is dropped
+    IMAGE_FORMAT_COUNT,
+} Image_Format;
+
+// @Note: How much of the color resolution is kept, luma is always full.
+typedef enum {
+    IMAGE_SUBSAMPLING_444 = 0, // @Note: None
+    IMAGE_SUBSAMPLING_422,     // @Note: Half the width
+    IMAGE_SUBSAMPLING_420,     // @Note: Half the width and height
+    IMAGE_SUBSAMPLING_COUNT,
+} Image_Subsampling;
+
+// @Note: Quality and subsampling are only for lossy formats, workers for JPEG and PNG. Zero workers
+// is one per CPU.
+typedef struct {
+    u32 quality; // @Note: 1 to 100
+    Image_Subsampling subsampling;
+    u32 workers;
+} Image_Options;
+
+#define IMAGE_DEFAULT_QUALITY 90
+
+typedef struct Image_Jpeg Image_Jpeg;
+typedef struct Image_Png Image_Png;
+
+// @Note: Buffered output, the first failed write sticks. 'bytes_written' counts everything handed in and
+// may be read from other threads for progress, opening doesn't reset it so readers never see it go back.
+typedef struct {
+    String8 path;
+    u8 *buffer;
+    usize size;
+    u64 bytes_written;
+    b32 failed;
+} Image_File;
+
+typedef struct {
+    Image_File file;
+    Image_Format format;
+    u32 width;
+    u32 height;
+    u32 row; // @Note: Rows written so far
+    
+    u8 *scratch; // @Note: One encoded row
+    Image_Jpeg *jpeg;
+    Image_Png *png;
+} Image_Writer;
+
+internal b32 image_file_open(Image_File *file, Arena *arena, String8 path);
+internal void image_file_write(Image_File *file, void *data, usize size);
+internal b32 image_file_close(Image_File *file);
+
+internal b32 image_writer_begin(Image_Writer *writer, Arena *arena, String8 path, Image_Format format, u32 width, u32 height);
+internal b32 image_writer_begin_ex(Image_Writer *writer, Arena *arena, String8 path, Image_Format format, u32 width, u32 height, Image_Options options);
+internal void image_writer_rows(Image_Writer *writer, u8 *pixels, u32 count, u32 pitch);
+internal b32 image_writer_end(Image_Writer *writer);
+
+#endif // IMAGE_H
@@ -0,0 +1,10 @@
+#ifndef IMAGE_INC_C
+#define IMAGE_INC_C
+
+#include "./image/image.c"
+#include "./image/image_jpeg.c"
+#include "./image/image_png.c"
+#include "./image/image_svg.c"
+#include "./image/image_y4m.c"
+
+#endif // IMAGE_INC_C
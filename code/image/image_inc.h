@@ -0,0 +1,10 @@
+#ifndef IMAGE_INC_H
+#define IMAGE_INC_H
+
+#include "./image/image.h"
+#include "./image/image_jpeg.h"
+#include "./image/image_png.h"
+#include "./image/image_svg.h"
+#include "./image/image_y4m.h"
+
+#endif // IMAGE_INC_H
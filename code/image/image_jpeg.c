@@ -0,0 +1,789 @@
+//
+// @Note: Tables, the quantizers are the ones from Annex K of the spec in natural order
+//
+
+global const u8 image_jpeg_natural[64] = {
+     0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63,
+};
+
+global const u8 image_jpeg_luma_quant[64] = {
+    16, 11, 10, 16,  24,  40,  51,  61, 12, 12, 14, 19,  26,  58,  60,  55,
+    14, 13, 16, 24,  40,  57,  69,  56, 14, 17, 22, 29,  51,  87,  80,  62,
+    18, 22, 37, 56,  68, 109, 103,  77, 24, 35, 55, 64,  81, 104, 113,  92,
+    49, 64, 78, 87, 103, 121, 120, 101, 72, 92, 95, 98, 112, 100, 103,  99,
+};
+
+global const u8 image_jpeg_chroma_quant[64] = {
+    17, 18, 24, 47, 99, 99, 99, 99, 18, 21, 26, 66, 99, 99, 99, 99,
+    24, 26, 56, 99, 99, 99, 99, 99, 47, 66, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99,
+};
+
+// @Note: Code counts for lengths 1 to 16, then the symbols, in the order of Image_Jpeg::huffman
+global const u8 image_jpeg_huffman_counts[4][16] = {
+    {0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0},
+    {0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7D},
+    {0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0},
+    {0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77},
+};
+
+global const u8 image_jpeg_dc_symbols[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+
+global const u8 image_jpeg_luma_ac_symbols[162] = {
+    0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+    0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xA1, 0x08, 0x23, 0x42, 0xB1, 0xC1, 0x15, 0x52, 0xD1, 0xF0,
+    0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0A, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2A, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+    0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+    0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+    0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7,
+    0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3, 0xC4, 0xC5,
+    0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xE1, 0xE2,
+    0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8,
+    0xF9, 0xFA,
+};
+
+global const u8 image_jpeg_chroma_ac_symbols[162] = {
+    0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+    0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xA1, 0xB1, 0xC1, 0x09, 0x23, 0x33, 0x52, 0xF0,
+    0x15, 0x62, 0x72, 0xD1, 0x0A, 0x16, 0x24, 0x34, 0xE1, 0x25, 0xF1, 0x17, 0x18, 0x19, 0x1A, 0x26,
+    0x27, 0x28, 0x29, 0x2A, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+    0x49, 0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+    0x69, 0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+    0x88, 0x89, 0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5,
+    0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3,
+    0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA,
+    0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8,
+    0xF9, 0xFA,
+};
+
+global const u8 *image_jpeg_huffman_symbols[4] = {
+    image_jpeg_dc_symbols, image_jpeg_luma_ac_symbols, image_jpeg_dc_symbols, image_jpeg_chroma_ac_symbols,
+};
+
+//
+// @Note: Forward DCT, jfdctint.c from libjpeg. The output is 8 times the real DCT.
+//
+
+#define IMAGE_JPEG_CONST_BITS 13
+#define IMAGE_JPEG_PASS1_BITS 2
+
+#define IMAGE_JPEG_FIX_0_298631336 2446
+#define IMAGE_JPEG_FIX_0_390180644 3196
+#define IMAGE_JPEG_FIX_0_541196100 4433
+#define IMAGE_JPEG_FIX_0_765366865 6270
+#define IMAGE_JPEG_FIX_0_899976223 7373
+#define IMAGE_JPEG_FIX_1_175875602 9633
+#define IMAGE_JPEG_FIX_1_501321110 12299
+#define IMAGE_JPEG_FIX_1_847759065 15137
+#define IMAGE_JPEG_FIX_1_961570560 16069
+#define IMAGE_JPEG_FIX_2_053119869 16819
+#define IMAGE_JPEG_FIX_2_562915447 20995
+#define IMAGE_JPEG_FIX_3_072711026 25172
+
+#define IMAGE_JPEG_DESCALE(x, n) (((x) + (1 << ((n) - 1))) >> (n))
+
+// @Note: One 1D pass over 8 values 'stride' apart, 'second' picks the scaling of the column pass.
+internal void image_jpeg_dct_pass(s32 *data, u32 stride, b32 second)
+{
+    s32 shift_even = second ? IMAGE_JPEG_PASS1_BITS : 0;
+    s32 shift_odd = second ? IMAGE_JPEG_CONST_BITS + IMAGE_JPEG_PASS1_BITS : IMAGE_JPEG_CONST_BITS - IMAGE_JPEG_PASS1_BITS;
+    
+    s32 tmp0 = data[0*stride] + data[7*stride];
+    s32 tmp7 = data[0*stride] - data[7*stride];
+    s32 tmp1 = data[1*stride] + data[6*stride];
+    s32 tmp6 = data[1*stride] - data[6*stride];
+    s32 tmp2 = data[2*stride] + data[5*stride];
+    s32 tmp5 = data[2*stride] - data[5*stride];
+    s32 tmp3 = data[3*stride] + data[4*stride];
+    s32 tmp4 = data[3*stride] - data[4*stride];
+    
+    s32 tmp10 = tmp0 + tmp3;
+    s32 tmp13 = tmp0 - tmp3;
+    s32 tmp11 = tmp1 + tmp2;
+    s32 tmp12 = tmp1 - tmp2;
+    
+    if (second) {
+        data[0*stride] = IMAGE_JPEG_DESCALE(tmp10 + tmp11, shift_even);
+        data[4*stride] = IMAGE_JPEG_DESCALE(tmp10 - tmp11, shift_even);
+    } else {
+        data[0*stride] = (tmp10 + tmp11) << IMAGE_JPEG_PASS1_BITS;
+        data[4*stride] = (tmp10 - tmp11) << IMAGE_JPEG_PASS1_BITS;
+    }
+    
+    s32 z1 = (tmp12 + tmp13)*IMAGE_JPEG_FIX_0_541196100;
+    data[2*stride] = IMAGE_JPEG_DESCALE(z1 + tmp13*IMAGE_JPEG_FIX_0_765366865, shift_odd);
+    data[6*stride] = IMAGE_JPEG_DESCALE(z1 - tmp12*IMAGE_JPEG_FIX_1_847759065, shift_odd);
+    
+    z1 = tmp4 + tmp7;
+    s32 z2 = tmp5 + tmp6;
+    s32 z3 = tmp4 + tmp6;
+    s32 z4 = tmp5 + tmp7;
+    s32 z5 = (z3 + z4)*IMAGE_JPEG_FIX_1_175875602;
+    
+    tmp4 = tmp4*IMAGE_JPEG_FIX_0_298631336;
+    tmp5 = tmp5*IMAGE_JPEG_FIX_2_053119869;
+    tmp6 = tmp6*IMAGE_JPEG_FIX_3_072711026;
+    tmp7 = tmp7*IMAGE_JPEG_FIX_1_501321110;
+    z1 = -z1*IMAGE_JPEG_FIX_0_899976223;
+    z2 = -z2*IMAGE_JPEG_FIX_2_562915447;
+    z3 = -z3*IMAGE_JPEG_FIX_1_961570560 + z5;
+    z4 = -z4*IMAGE_JPEG_FIX_0_390180644 + z5;
+    
+    data[7*stride] = IMAGE_JPEG_DESCALE(tmp4 + z1 + z3, shift_odd);
+    data[5*stride] = IMAGE_JPEG_DESCALE(tmp5 + z2 + z4, shift_odd);
+    data[3*stride] = IMAGE_JPEG_DESCALE(tmp6 + z2 + z3, shift_odd);
+    data[1*stride] = IMAGE_JPEG_DESCALE(tmp7 + z1 + z4, shift_odd);
+}
+
+// @Note: DCT and quantization of the 8x8 block at 'src', coefficients come out in natural order.
+internal void image_jpeg_block_scalar(s16 *src, u32 pitch, u32 *reciprocal, s16 *out)
+{
+    s32 data[64];
+    for (u32 y = 0; y < 8; ++y) {
+        for (u32 x = 0; x < 8; ++x) {
+            data[y*8 + x] = src[y*pitch + x];
+        }
+    }
+    
+    for (u32 y = 0; y < 8; ++y) {
+        image_jpeg_dct_pass(data + y*8, 1, 0);
+    }
+    
+    for (u32 x = 0; x < 8; ++x) {
+        image_jpeg_dct_pass(data + x, 8, 1);
+    }
+    
+    const u32 round = 1 << (IMAGE_JPEG_QUANT_SHIFT - 1);
+    for (u32 i = 0; i < 64; ++i) {
+        s32 coefficient = data[i];
+        u32 magnitude = (u32) (coefficient < 0 ? -coefficient : coefficient);
+        s32 quantized = (s32) ((magnitude*reciprocal[i] + round) >> IMAGE_JPEG_QUANT_SHIFT);
+        out[i] = (s16) (coefficient < 0 ? -quantized : quantized);
+    }
+}
+
+// @Note: Rows of the block are in the lanes of 'rows', afterwards its columns are.
+internal void image_jpeg_transpose_avx2(__m256i *rows)
+{
+    __m256i t0 = _mm256_unpacklo_epi32(rows[0], rows[1]);
+    __m256i t1 = _mm256_unpackhi_epi32(rows[0], rows[1]);
+    __m256i t2 = _mm256_unpacklo_epi32(rows[2], rows[3]);
+    __m256i t3 = _mm256_unpackhi_epi32(rows[2], rows[3]);
+    __m256i t4 = _mm256_unpacklo_epi32(rows[4], rows[5]);
+    __m256i t5 = _mm256_unpackhi_epi32(rows[4], rows[5]);
+    __m256i t6 = _mm256_unpacklo_epi32(rows[6], rows[7]);
+    __m256i t7 = _mm256_unpackhi_epi32(rows[6], rows[7]);
+    
+    __m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+    __m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+    __m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+    __m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+    __m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+    __m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+    __m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+    __m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+    
+    rows[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+    rows[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+    rows[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+    rows[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+    rows[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+    rows[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+    rows[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+    rows[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+}
+
+// @Note: image_jpeg_dct_pass() on all 8 lanes at once, 'data[i]' holds the i-th input of each.
+internal void image_jpeg_dct_pass_avx2(__m256i *data, b32 second)
+{
+    __m256i tmp0 = _mm256_add_epi32(data[0], data[7]);
+    __m256i tmp7 = _mm256_sub_epi32(data[0], data[7]);
+    __m256i tmp1 = _mm256_add_epi32(data[1], data[6]);
+    __m256i tmp6 = _mm256_sub_epi32(data[1], data[6]);
+    __m256i tmp2 = _mm256_add_epi32(data[2], data[5]);
+    __m256i tmp5 = _mm256_sub_epi32(data[2], data[5]);
+    __m256i tmp3 = _mm256_add_epi32(data[3], data[4]);
+    __m256i tmp4 = _mm256_sub_epi32(data[3], data[4]);
+    
+    __m256i tmp10 = _mm256_add_epi32(tmp0, tmp3);
+    __m256i tmp13 = _mm256_sub_epi32(tmp0, tmp3);
+    __m256i tmp11 = _mm256_add_epi32(tmp1, tmp2);
+    __m256i tmp12 = _mm256_sub_epi32(tmp1, tmp2);
+    
+    s32 shift_odd = second ? IMAGE_JPEG_CONST_BITS + IMAGE_JPEG_PASS1_BITS : IMAGE_JPEG_CONST_BITS - IMAGE_JPEG_PASS1_BITS;
+    __m128i count_odd = _mm_cvtsi32_si128(shift_odd);
+    __m256i round_odd = _mm256_set1_epi32(1 << (shift_odd - 1));
+    
+    if (second) {
+        __m128i count_even = _mm_cvtsi32_si128(IMAGE_JPEG_PASS1_BITS);
+        __m256i round_even = _mm256_set1_epi32(1 << (IMAGE_JPEG_PASS1_BITS - 1));
+        data[0] = _mm256_sra_epi32(_mm256_add_epi32(_mm256_add_epi32(tmp10, tmp11), round_even), count_even);
+        data[4] = _mm256_sra_epi32(_mm256_add_epi32(_mm256_sub_epi32(tmp10, tmp11), round_even), count_even);
+    } else {
+        data[0] = _mm256_slli_epi32(_mm256_add_epi32(tmp10, tmp11), IMAGE_JPEG_PASS1_BITS);
+        data[4] = _mm256_slli_epi32(_mm256_sub_epi32(tmp10, tmp11), IMAGE_JPEG_PASS1_BITS);
+    }
+    
+    __m256i z1 = _mm256_mullo_epi32(_mm256_add_epi32(tmp12, tmp13), _mm256_set1_epi32(IMAGE_JPEG_FIX_0_541196100));
+    __m256i even2 = _mm256_add_epi32(z1, _mm256_mullo_epi32(tmp13, _mm256_set1_epi32(IMAGE_JPEG_FIX_0_765366865)));
+    __m256i even6 = _mm256_sub_epi32(z1, _mm256_mullo_epi32(tmp12, _mm256_set1_epi32(IMAGE_JPEG_FIX_1_847759065)));
+    data[2] = _mm256_sra_epi32(_mm256_add_epi32(even2, round_odd), count_odd);
+    data[6] = _mm256_sra_epi32(_mm256_add_epi32(even6, round_odd), count_odd);
+    
+    z1 = _mm256_add_epi32(tmp4, tmp7);
+    __m256i z2 = _mm256_add_epi32(tmp5, tmp6);
+    __m256i z3 = _mm256_add_epi32(tmp4, tmp6);
+    __m256i z4 = _mm256_add_epi32(tmp5, tmp7);
+    __m256i z5 = _mm256_mullo_epi32(_mm256_add_epi32(z3, z4), _mm256_set1_epi32(IMAGE_JPEG_FIX_1_175875602));
+    
+    tmp4 = _mm256_mullo_epi32(tmp4, _mm256_set1_epi32(IMAGE_JPEG_FIX_0_298631336));
+    tmp5 = _mm256_mullo_epi32(tmp5, _mm256_set1_epi32(IMAGE_JPEG_FIX_2_053119869));
+    tmp6 = _mm256_mullo_epi32(tmp6, _mm256_set1_epi32(IMAGE_JPEG_FIX_3_072711026));
+    tmp7 = _mm256_mullo_epi32(tmp7, _mm256_set1_epi32(IMAGE_JPEG_FIX_1_501321110));
+    z1 = _mm256_mullo_epi32(z1, _mm256_set1_epi32(-IMAGE_JPEG_FIX_0_899976223));
+    z2 = _mm256_mullo_epi32(z2, _mm256_set1_epi32(-IMAGE_JPEG_FIX_2_562915447));
+    z3 = _mm256_add_epi32(_mm256_mullo_epi32(z3, _mm256_set1_epi32(-IMAGE_JPEG_FIX_1_961570560)), z5);
+    z4 = _mm256_add_epi32(_mm256_mullo_epi32(z4, _mm256_set1_epi32(-IMAGE_JPEG_FIX_0_390180644)), z5);
+    
+    __m256i odd7 = _mm256_add_epi32(_mm256_add_epi32(tmp4, z1), z3);
+    __m256i odd5 = _mm256_add_epi32(_mm256_add_epi32(tmp5, z2), z4);
+    __m256i odd3 = _mm256_add_epi32(_mm256_add_epi32(tmp6, z2), z3);
+    __m256i odd1 = _mm256_add_epi32(_mm256_add_epi32(tmp7, z1), z4);
+    data[7] = _mm256_sra_epi32(_mm256_add_epi32(odd7, round_odd), count_odd);
+    data[5] = _mm256_sra_epi32(_mm256_add_epi32(odd5, round_odd), count_odd);
+    data[3] = _mm256_sra_epi32(_mm256_add_epi32(odd3, round_odd), count_odd);
+    data[1] = _mm256_sra_epi32(_mm256_add_epi32(odd1, round_odd), count_odd);
+}
+
+internal void image_jpeg_block_avx2(s16 *src, u32 pitch, u32 *reciprocal, s16 *out)
+{
+    // @Note: Rows go in, the transpose makes every register one column across the rows so the first
+    // pass works on all rows at once. The second transpose brings the rows back for the column pass,
+    // which leaves row 'u' of the coefficients in data[u].
+    __m256i data[8];
+    for (u32 y = 0; y < 8; ++y) {
+        data[y] = _mm256_cvtepi16_epi32(_mm_loadu_si128((__m128i *) (src + y*pitch)));
+    }
+    
+    image_jpeg_transpose_avx2(data);
+    image_jpeg_dct_pass_avx2(data, 0);
+    image_jpeg_transpose_avx2(data);
+    image_jpeg_dct_pass_avx2(data, 1);
+    
+    __m256i round = _mm256_set1_epi32(1 << (IMAGE_JPEG_QUANT_SHIFT - 1));
+    for (u32 y = 0; y < 8; y += 2) {
+        __m256i quantized[2];
+        for (u32 i = 0; i < 2; ++i) {
+            __m256i coefficient = data[y + i];
+            __m256i magnitude = _mm256_abs_epi32(coefficient);
+            __m256i scale = _mm256_loadu_si256((__m256i *) (reciprocal + (y + i)*8));
+            __m256i value = _mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(magnitude, scale), round), IMAGE_JPEG_QUANT_SHIFT);
+            quantized[i] = _mm256_sign_epi32(value, coefficient);
+        }
+        
+        // @Note: Packing works per 128 bit lane, the permute puts the two rows back in order.
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(quantized[0], quantized[1]), 0xD8);
+        _mm256_storeu_si256((__m256i *) (out + y*8), packed);
+    }
+}
+
+//
+// @Note: Entropy coding
+//
+
+internal void image_jpeg_reserve(Image_Jpeg_Worker *worker)
+{
+    // @Note: Called before every MCU, so the writes below never check for room.
+    if (worker->last == 0 || worker->last->size + IMAGE_JPEG_MCU_BOUND > IMAGE_JPEG_CHUNK_SIZE) {
+        Image_Jpeg_Chunk *chunk = (Image_Jpeg_Chunk *) arena_push_no_zero(worker->arena, sizeof(Image_Jpeg_Chunk));
+        chunk->size = 0;
+        SLLQueuePush(worker->first, worker->last, chunk);
+    }
+}
+
+internal void image_jpeg_put_byte(Image_Jpeg_Chunk *chunk, u8 byte)
+{
+    chunk->data[chunk->size++] = byte;
+    if (byte == 0xFF) {
+        chunk->data[chunk->size++] = 0;
+    }
+}
+
+internal void image_jpeg_put_bits(Image_Jpeg_Worker *worker, u32 code, u32 size)
+{
+    // @Note: At most 27 bits come in at once, so the 64 bit buffer never overflows. It is written out
+    // 32 bits at a time, byte by byte only when one of them needs a stuffed zero after it.
+    worker->bits = (worker->bits << size) | code;
+    worker->bit_count += size;
+    
+    if (worker->bit_count >= 32) {
+        worker->bit_count -= 32;
+        u32 word = (u32) (worker->bits >> worker->bit_count);
+        
+        Image_Jpeg_Chunk *chunk = worker->last;
+        u32 inverse = ~word;
+        if (((inverse - 0x01010101) & ~inverse & 0x80808080) == 0) {
+            u8 *at = chunk->data + chunk->size;
+            at[0] = (u8) (word >> 24);
+            at[1] = (u8) (word >> 16);
+            at[2] = (u8) (word >> 8);
+            at[3] = (u8) word;
+            chunk->size += 4;
+        } else {
+            for (s32 shift = 24; shift >= 0; shift -= 8) {
+                image_jpeg_put_byte(chunk, (u8) (word >> shift));
+            }
+        }
+    }
+}
+
+internal void image_jpeg_pad_bits(Image_Jpeg_Worker *worker)
+{
+    // @Note: Fills the last byte with ones and writes out everything that's left.
+    u32 pad = (8 - (worker->bit_count & 7)) & 7;
+    worker->bits = (worker->bits << pad) | ((1u << pad) - 1);
+    worker->bit_count += pad;
+    
+    while (worker->bit_count > 0) {
+        worker->bit_count -= 8;
+        image_jpeg_put_byte(worker->last, (u8) (worker->bits >> worker->bit_count));
+    }
+}
+
+internal void image_jpeg_put_value(Image_Jpeg_Worker *worker, Image_Jpeg_Huffman *table, u32 run, s32 value)
+{
+    // @Note: The symbol is the run of zeros before the value and its bit length, the bits that follow
+    // are the value itself for positive ones and the value minus one for negative ones.
+    u32 magnitude = (u32) (value < 0 ? -value : value);
+    u32 size = worker->jpeg->bit_size[magnitude];
+    
+    u32 symbol = (run << 4) | size;
+    u32 extra = (u32) (value < 0 ? value - 1 : value) & ((1u << size) - 1);
+    image_jpeg_put_bits(worker, ((u32) table->code[symbol] << size) | extra, table->size[symbol] + size);
+}
+
+internal void image_jpeg_put_block(Image_Jpeg_Worker *worker, s16 *block, s32 *dc, Image_Jpeg_Huffman *dc_table, Image_Jpeg_Huffman *ac_table)
+{
+    image_jpeg_put_value(worker, dc_table, 0, block[0] - *dc);
+    *dc = block[0];
+    
+    u32 run = 0;
+    for (u32 i = 1; i < 64; ++i) {
+        s32 value = block[image_jpeg_natural[i]];
+        if (value == 0) {
+            run += 1;
+        } else {
+            while (run >= 16) {
+                image_jpeg_put_bits(worker, ac_table->code[0xF0], ac_table->size[0xF0]);
+                run -= 16;
+            }
+            
+            image_jpeg_put_value(worker, ac_table, run, value);
+            run = 0;
+        }
+    }
+    
+    if (run > 0) {
+        image_jpeg_put_bits(worker, ac_table->code[0x00], ac_table->size[0x00]);
+    }
+}
+
+//
+// @Note: Workers
+//
+
+// @Note: BT.601 in 16 bit fixed point, luma comes out centered. Chroma stays unscaled so samples can be
+// summed before rounding, its factors add up to zero so sums of them are already centered. Pixels past
+// 'width' repeat the last one.
+internal void image_jpeg_convert_scalar(u32 *line, u32 width, u32 first, u32 count, s16 *luma, s32 *cb, s32 *cr)
+{
+    for (u32 x = first; x < count; ++x) {
+        u32 pixel = line[MIN(x, width - 1)];
+        s32 r = (s32) (pixel & 0xFF);
+        s32 g = (s32) ((pixel >> 8) & 0xFF);
+        s32 b = (s32) ((pixel >> 16) & 0xFF);
+        luma[x] = (s16) (((19595*r + 38470*g + 7471*b + 32768) >> 16) - 128);
+        cb[x] = -11059*r - 21709*g + 32768*b;
+        cr[x] = 32768*r - 27439*g - 5329*b;
+    }
+}
+
+internal void image_jpeg_convert_avx2(u32 *line, u32 width, u32 count, s16 *luma, s32 *cb, s32 *cr)
+{
+    __m256i mask = _mm256_set1_epi32(0xFF);
+    __m256i round = _mm256_set1_epi32(32768 - (128 << 16));
+    
+    u32 x = 0;
+    for (; x + 8 <= width; x += 8) {
+        __m256i pixels = _mm256_loadu_si256((__m256i *) (line + x));
+        __m256i r = _mm256_and_si256(pixels, mask);
+        __m256i g = _mm256_and_si256(_mm256_srli_epi32(pixels, 8), mask);
+        __m256i b = _mm256_and_si256(_mm256_srli_epi32(pixels, 16), mask);
+        
+        __m256i y = _mm256_add_epi32(_mm256_mullo_epi32(r, _mm256_set1_epi32(19595)), _mm256_mullo_epi32(g, _mm256_set1_epi32(38470)));
+        y = _mm256_add_epi32(y, _mm256_mullo_epi32(b, _mm256_set1_epi32(7471)));
+        y = _mm256_srai_epi32(_mm256_add_epi32(y, round), 16);
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(y, y), 0x08);
+        _mm_storeu_si128((__m128i *) (luma + x), _mm256_castsi256_si128(packed));
+        
+        __m256i u = _mm256_add_epi32(_mm256_mullo_epi32(r, _mm256_set1_epi32(-11059)), _mm256_mullo_epi32(g, _mm256_set1_epi32(-21709)));
+        u = _mm256_add_epi32(u, _mm256_slli_epi32(b, 15));
+        _mm256_storeu_si256((__m256i *) (cb + x), u);
+        
+        __m256i v = _mm256_add_epi32(_mm256_slli_epi32(r, 15), _mm256_mullo_epi32(g, _mm256_set1_epi32(-27439)));
+        v = _mm256_add_epi32(v, _mm256_mullo_epi32(b, _mm256_set1_epi32(-5329)));
+        _mm256_storeu_si256((__m256i *) (cr + x), v);
+    }
+    
+    image_jpeg_convert_scalar(line, width, x, count, luma, cb, cr);
+}
+
+internal void image_jpeg_convert(Image_Jpeg *jpeg, Image_Jpeg_Worker *worker, u32 mcu_row)
+{
+    // @Note: Lines past the bottom edge repeat the last one. Chroma is the rounded average of the
+    // samples it covers, summed up over the lines of one chroma line first.
+    u32 luma_width = jpeg->mcus_x*jpeg->mcu_width;
+    u32 chroma_width = jpeg->mcus_x*8;
+    u32 step_x = jpeg->mcu_width/8;
+    u32 step_y = jpeg->mcu_height/8;
+    u32 shift = 16 + (step_x - 1) + (step_y - 1);
+    s32 round = 1 << (shift - 1);
+    
+    for (u32 y = 0; y < jpeg->mcu_height; ++y) {
+        u32 line_index = MIN(mcu_row*jpeg->mcu_height + y, jpeg->height - 1) - jpeg->band_first;
+        u32 *line = (u32 *) (jpeg->band + (usize) line_index*jpeg->width*4);
+        s16 *luma = worker->luma + y*luma_width;
+        if (jpeg->avx2) {
+            image_jpeg_convert_avx2(line, jpeg->width, luma_width, luma, worker->line[0], worker->line[1]);
+        } else {
+            image_jpeg_convert_scalar(line, jpeg->width, 0, luma_width, luma, worker->line[0], worker->line[1]);
+        }
+        
+        u32 chroma_y = y/step_y;
+        b32 first = (y % step_y) == 0;
+        b32 last = (y % step_y) == step_y - 1;
+        for (u32 i = 0; i < 2; ++i) {
+            s32 *samples = worker->line[i];
+            s32 *sums = worker->sums[i];
+            for (u32 x = 0; x < chroma_width; ++x) {
+                s32 sum = step_x == 2 ? samples[2*x] + samples[2*x + 1] : samples[x];
+                sums[x] = first ? sum : sums[x] + sum;
+            }
+            
+            if (last) {
+                s16 *out = worker->chroma[i] + chroma_y*chroma_width;
+                for (u32 x = 0; x < chroma_width; ++x) {
+                    out[x] = (s16) ((sums[x] + round) >> shift);
+                }
+            }
+        }
+    }
+}
+
+internal void image_jpeg_worker(void *data)
+{
+    OPTICK_EVENT();
+    
+    Image_Jpeg_Worker *worker = (Image_Jpeg_Worker *) data;
+    Image_Jpeg *jpeg = worker->jpeg;
+    
+    u32 luma_width = jpeg->mcus_x*jpeg->mcu_width;
+    u32 chroma_width = jpeg->mcus_x*8;
+    u32 blocks_x = jpeg->mcu_width/8;
+    u32 blocks_y = jpeg->mcu_height/8;
+    
+    for (u32 row = worker->first_row; row < worker->first_row + worker->row_count; ++row) {
+        image_jpeg_convert(jpeg, worker, row);
+        
+        worker->dc[0] = worker->dc[1] = worker->dc[2] = 0;
+        for (u32 mcu = 0; mcu < jpeg->mcus_x; ++mcu) {
+            image_jpeg_reserve(worker);
+            
+            for (u32 by = 0; by < blocks_y; ++by) {
+                for (u32 bx = 0; bx < blocks_x; ++bx) {
+                    s16 *src = worker->luma + by*8*luma_width + mcu*jpeg->mcu_width + bx*8;
+                    if (jpeg->avx2) {
+                        image_jpeg_block_avx2(src, luma_width, jpeg->reciprocal[0], worker->block);
+                    } else {
+                        image_jpeg_block_scalar(src, luma_width, jpeg->reciprocal[0], worker->block);
+                    }
+                    
+                    image_jpeg_put_block(worker, worker->block, worker->dc + 0, jpeg->huffman + 0, jpeg->huffman + 1);
+                }
+            }
+            
+            for (u32 i = 0; i < 2; ++i) {
+                s16 *src = worker->chroma[i] + mcu*8;
+                if (jpeg->avx2) {
+                    image_jpeg_block_avx2(src, chroma_width, jpeg->reciprocal[1], worker->block);
+                } else {
+                    image_jpeg_block_scalar(src, chroma_width, jpeg->reciprocal[1], worker->block);
+                }
+                
+                image_jpeg_put_block(worker, worker->block, worker->dc + 1 + i, jpeg->huffman + 2, jpeg->huffman + 3);
+            }
+        }
+        
+        // @Note: Every MCU row is one restart interval, it ends on a byte padded with ones and the
+        // marker for the next one. The reserve above left room for both.
+        image_jpeg_pad_bits(worker);
+        
+        if (row + 1 < jpeg->mcu_rows) {
+            Image_Jpeg_Chunk *chunk = worker->last;
+            chunk->data[chunk->size++] = 0xFF;
+            chunk->data[chunk->size++] = (u8) (0xD0 + (row & 7));
+        }
+    }
+}
+
+internal void image_jpeg_thread(void *data)
+{
+    OPTICK_THREAD("JPEG encode");
+    image_jpeg_worker(data);
+}
+
+internal void image_jpeg_flush(Image_Jpeg *jpeg, Image_File *file)
+{
+    OPTICK_EVENT();
+    
+    // @Note: Worker 0 is the calling thread, a worker that fails to start is done on it too.
+    u32 first_row = jpeg->band_first/jpeg->mcu_height;
+    u32 row_count = (jpeg->band_lines + jpeg->mcu_height - 1)/jpeg->mcu_height;
+    u32 worker_count = MIN(jpeg->worker_count, row_count);
+    for (u32 i = 0; i < worker_count; ++i) {
+        Image_Jpeg_Worker *worker = jpeg->workers + i;
+        worker->first_row = first_row + row_count*i/worker_count;
+        worker->row_count = first_row + row_count*(i + 1)/worker_count - worker->first_row;
+    }
+    
+    OS_Thread threads[IMAGE_JPEG_MAX_WORKERS] = {0};
+    b32 started[IMAGE_JPEG_MAX_WORKERS] = {0};
+    for (u32 i = 1; i < worker_count; ++i) {
+        started[i] = os_thread_start(threads + i, image_jpeg_thread, jpeg->workers + i);
+    }
+    
+    image_jpeg_worker(jpeg->workers);
+    
+    for (u32 i = 1; i < worker_count; ++i) {
+        if (started[i]) {
+            os_thread_join(threads + i);
+        } else {
+            image_jpeg_worker(jpeg->workers + i);
+        }
+    }
+    
+    for (u32 i = 0; i < worker_count; ++i) {
+        Image_Jpeg_Worker *worker = jpeg->workers + i;
+        for (Image_Jpeg_Chunk *chunk = worker->first; chunk != 0; chunk = chunk->next) {
+            image_file_write(file, chunk->data, chunk->size);
+        }
+        
+        worker->first = worker->last = 0;
+        arena_clear(worker->arena);
+    }
+    
+    jpeg->band_first += jpeg->band_lines;
+    jpeg->band_lines = 0;
+}
+
+//
+// @Note: Headers
+//
+
+internal u8 *image_jpeg_put_u16(u8 *at, u32 value)
+{
+    at[0] = (u8) ((value >> 8) & 0xFF);
+    at[1] = (u8) (value & 0xFF);
+    
+    u8 *result = at + 2;
+    return(result);
+}
+
+internal void image_jpeg_header(Image_Jpeg *jpeg, Image_File *file)
+{
+    u8 header[1024];
+    u8 *at = header;
+    
+    static const u8 start[] = {
+        0xFF, 0xD8,
+        0xFF, 0xE0, 0x00, 0x10, 'J', 'F', 'I', 'F', 0x00, 0x01, 0x01, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00,
+    };
+    MemoryCopy(at, start, sizeof(start));
+    at += sizeof(start);
+    
+    *at++ = 0xFF;
+    *at++ = 0xDB;
+    at = image_jpeg_put_u16(at, 2 + 2*65);
+    for (u32 i = 0; i < 2; ++i) {
+        *at++ = (u8) i;
+        MemoryCopy(at, jpeg->quant[i], 64);
+        at += 64;
+    }
+    
+    u8 luma_sampling = (u8) (((jpeg->mcu_width/8) << 4) | (jpeg->mcu_height/8));
+    *at++ = 0xFF;
+    *at++ = 0xC0;
+    at = image_jpeg_put_u16(at, 8 + 3*3);
+    *at++ = 8;
+    at = image_jpeg_put_u16(at, jpeg->height);
+    at = image_jpeg_put_u16(at, jpeg->width);
+    *at++ = 3;
+    *at++ = 1; *at++ = luma_sampling; *at++ = 0;
+    *at++ = 2; *at++ = 0x11;          *at++ = 1;
+    *at++ = 3; *at++ = 0x11;          *at++ = 1;
+    
+    static const u8 table_ids[4] = {0x00, 0x10, 0x01, 0x11};
+    u32 table_size = 0;
+    u32 symbol_counts[4] = {0};
+    for (u32 i = 0; i < 4; ++i) {
+        for (u32 j = 0; j < 16; ++j) {
+            symbol_counts[i] += image_jpeg_huffman_counts[i][j];
+        }
+        
+        table_size += 1 + 16 + symbol_counts[i];
+    }
+    
+    *at++ = 0xFF;
+    *at++ = 0xC4;
+    at = image_jpeg_put_u16(at, 2 + table_size);
+    for (u32 i = 0; i < 4; ++i) {
+        *at++ = table_ids[i];
+        MemoryCopy(at, image_jpeg_huffman_counts[i], 16);
+        at += 16;
+        MemoryCopy(at, image_jpeg_huffman_symbols[i], symbol_counts[i]);
+        at += symbol_counts[i];
+    }
+    
+    *at++ = 0xFF;
+    *at++ = 0xDD;
+    at = image_jpeg_put_u16(at, 4);
+    at = image_jpeg_put_u16(at, jpeg->mcus_x);
+    
+    static const u8 scan[] = {
+        0xFF, 0xDA, 0x00, 0x0C, 0x03, 0x01, 0x00, 0x02, 0x11, 0x03, 0x11, 0x00, 0x3F, 0x00,
+    };
+    MemoryCopy(at, scan, sizeof(scan));
+    at += sizeof(scan);
+    
+    image_file_write(file, header, (usize) (at - header));
+}
+
+internal void image_jpeg_tables(Image_Jpeg *jpeg, u32 quality)
+{
+    // @Note: Quality scales the Annex K tables the same way libjpeg and stb do.
+    quality = MAX(1, MIN(quality, 100));
+    u32 scale = quality < 50 ? 5000/quality : 200 - 2*quality;
+    
+    for (u32 i = 0; i < 64; ++i) {
+        u32 natural = image_jpeg_natural[i];
+        const u8 *base[2] = {image_jpeg_luma_quant, image_jpeg_chroma_quant};
+        for (u32 t = 0; t < 2; ++t) {
+            u32 q = (base[t][natural]*scale + 50)/100;
+            q = MAX(1, MIN(q, 255));
+            
+            u32 divisor = 8*q;
+            jpeg->quant[t][i] = (u8) q;
+            jpeg->reciprocal[t][natural] = ((1u << IMAGE_JPEG_QUANT_SHIFT) + divisor/2)/divisor;
+        }
+    }
+    
+    jpeg->bit_size[0] = 0;
+    for (u32 i = 1; i < ARRAY_SIZE(jpeg->bit_size); ++i) {
+        jpeg->bit_size[i] = (u8) (jpeg->bit_size[i/2] + 1);
+    }
+    
+    for (u32 i = 0; i < 4; ++i) {
+        Image_Jpeg_Huffman *table = jpeg->huffman + i;
+        const u8 *symbols = image_jpeg_huffman_symbols[i];
+        
+        u32 code = 0;
+        u32 k = 0;
+        for (u32 size = 1; size <= 16; ++size) {
+            for (u32 j = 0; j < image_jpeg_huffman_counts[i][size - 1]; ++j) {
+                table->code[symbols[k]] = (u16) code;
+                table->size[symbols[k]] = (u8) size;
+                code += 1;
+                k += 1;
+            }
+            
+            code <<= 1;
+        }
+    }
+}
+
+internal b32 image_jpeg_begin(Image_Jpeg *jpeg, Arena *arena, Image_File *file, u32 width, u32 height, Image_Options options)
+{
+    jpeg->width = width;
+    jpeg->height = height;
+    jpeg->subsampling = options.subsampling < IMAGE_SUBSAMPLING_COUNT ? options.subsampling : IMAGE_SUBSAMPLING_444;
+    jpeg->avx2 = os_cpu_has_avx2();
+    
+    jpeg->mcu_width = jpeg->subsampling == IMAGE_SUBSAMPLING_444 ? 8 : 16;
+    jpeg->mcu_height = jpeg->subsampling == IMAGE_SUBSAMPLING_420 ? 16 : 8;
+    jpeg->mcus_x = (width + jpeg->mcu_width - 1)/jpeg->mcu_width;
+    jpeg->mcu_rows = (height + jpeg->mcu_height - 1)/jpeg->mcu_height;
+    
+    image_jpeg_tables(jpeg, options.quality);
+    
+    jpeg->band = arena_push_array(arena, u8, (usize) width*4*IMAGE_JPEG_BAND_LINES);
+    jpeg->band_first = 0;
+    jpeg->band_lines = 0;
+    
+    u32 workers = options.workers ? options.workers : os_cpu_count();
+    jpeg->worker_count = MAX(1, MIN(workers, IMAGE_JPEG_MAX_WORKERS));
+    
+    usize luma_size = (usize) jpeg->mcus_x*jpeg->mcu_width*jpeg->mcu_height;
+    usize chroma_size = (usize) jpeg->mcus_x*8*8;
+    for (u32 i = 0; i < jpeg->worker_count; ++i) {
+        Image_Jpeg_Worker *worker = jpeg->workers + i;
+        worker->jpeg = jpeg;
+        worker->arena = arena_make();
+        worker->first = worker->last = 0;
+        worker->bits = 0;
+        worker->bit_count = 0;
+        worker->luma = arena_push_array(arena, s16, luma_size);
+        worker->chroma[0] = arena_push_array(arena, s16, chroma_size);
+        worker->chroma[1] = arena_push_array(arena, s16, chroma_size);
+        for (u32 j = 0; j < 2; ++j) {
+            worker->line[j] = arena_push_array(arena, s32, luma_size/jpeg->mcu_height);
+            worker->sums[j] = arena_push_array(arena, s32, chroma_size/8);
+        }
+    }
+    
+    image_jpeg_header(jpeg, file);
+    
+    b32 result = !file->failed;
+    return(result);
+}
+
+internal void image_jpeg_rows(Image_Jpeg *jpeg, Image_File *file, u8 *pixels, u32 count, u32 pitch)
+{
+    usize line_size = (usize) jpeg->width*4;
+    for (u32 i = 0; i < count; ++i) {
+        MemoryCopy(jpeg->band + jpeg->band_lines*line_size, pixels + (usize) i*pitch, line_size);
+        jpeg->band_lines += 1;
+        
+        if (jpeg->band_lines == IMAGE_JPEG_BAND_LINES) {
+            image_jpeg_flush(jpeg, file);
+        }
+    }
+}
+
+internal void image_jpeg_end(Image_Jpeg *jpeg, Image_File *file)
+{
+    if (jpeg->band_lines > 0) {
+        image_jpeg_flush(jpeg, file);
+    }
+    
+    u8 end[2] = {0xFF, 0xD9};
+    image_file_write(file, end, sizeof(end));
+    
+    for (u32 i = 0; i < jpeg->worker_count; ++i) {
+        arena_release(jpeg->workers[i].arena);
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef IMAGE_JPEG_H
+#define IMAGE_JPEG_H
+
+#include <immintrin.h>
+
+// @Note: Baseline JPEG, standard Huffman tables, quantization tables scaled by quality the same way
+// as libjpeg. Rows are collected into a band of IMAGE_JPEG_BAND_LINES and every band is encoded on
+// up to IMAGE_JPEG_MAX_WORKERS threads, each taking a contiguous range of its MCU rows. A restart
+// marker after every MCU row makes the rows independent, so the workers never wait on each other
+// and their output only has to be written out in order.
+//
+// The DCT is libjpeg's slow integer one (jfdctint.c), with an AVX2 path that does all 8 rows or
+// columns of a block at once. Quantization is a reciprocal multiply in both paths, so they give
+// the same bits.
+#define IMAGE_JPEG_BAND_LINES 256
+#define IMAGE_JPEG_MAX_WORKERS 16
+#define IMAGE_JPEG_CHUNK_SIZE KB(64)
+#define IMAGE_JPEG_MCU_BOUND KB(4) // @Note: Worst case of one MCU, six blocks with every 0xFF stuffed
+#define IMAGE_JPEG_QUANT_SHIFT 18
+
+typedef struct Image_Jpeg_Chunk {
+    struct Image_Jpeg_Chunk *next;
+    usize size;
+    u8 data[IMAGE_JPEG_CHUNK_SIZE];
+} Image_Jpeg_Chunk;
+
+typedef struct {
+    u16 code[256];
+    u8 size[256];
+} Image_Jpeg_Huffman;
+
+typedef struct {
+    Image_Jpeg *jpeg; // @Note: Read only while the workers run
+    Arena *arena;     // @Note: Chunks, cleared after every band
+    
+    u32 first_row; // @Note: MCU rows of the picture
+    u32 row_count;
+    
+    s16 *luma;      // @Note: One MCU row, 'mcus_x*mcu_width' wide
+    s16 *chroma[2]; // @Note: One MCU row after subsampling, 'mcus_x*8' wide and 8 high
+    s32 *line[2];   // @Note: Chroma of one line before subsampling
+    s32 *sums[2];   // @Note: Chroma of one line after summing up horizontally, and vertically for 4:2:0
+    s16 block[64];
+    s32 dc[3];
+    
+    Image_Jpeg_Chunk *first;
+    Image_Jpeg_Chunk *last;
+    u64 bits;
+    u32 bit_count;
+} Image_Jpeg_Worker;
+
+struct Image_Jpeg {
+    u32 width;
+    u32 height;
+    Image_Subsampling subsampling;
+    b32 avx2;
+    
+    u32 mcu_width; // @Note: In pixels
+    u32 mcu_height;
+    u32 mcus_x;
+    u32 mcu_rows;
+    
+    u8 quant[2][64];      // @Note: Zigzag order, as they go into the file
+    u32 reciprocal[2][64]; // @Note: Natural order, of 8 times the quantizer since the DCT is scaled by 8
+    Image_Jpeg_Huffman huffman[4]; // @Note: DC luma, AC luma, DC chroma, AC chroma
+    u8 bit_size[2048];             // @Note: Bits needed for a magnitude, DC differences stay below 2048
+    
+    u8 *band;       // @Note: RGBA, IMAGE_JPEG_BAND_LINES rows of the picture's width
+    u32 band_first; // @Note: First line of the picture in the band
+    u32 band_lines; // @Note: Filled so far
+    
+    u32 worker_count;
+    Image_Jpeg_Worker workers[IMAGE_JPEG_MAX_WORKERS];
+};
+
+internal b32 image_jpeg_begin(Image_Jpeg *jpeg, Arena *arena, Image_File *file, u32 width, u32 height, Image_Options options);
+internal void image_jpeg_rows(Image_Jpeg *jpeg, Image_File *file, u8 *pixels, u32 count, u32 pitch);
+internal void image_jpeg_end(Image_Jpeg *jpeg, Image_File *file);
+
+#endif // IMAGE_JPEG_H
@@ -0,0 +1,925 @@
+//
+// @Note: Tables from RFC 1951
+//
+
+global const u16 image_png_length_base[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258,
+};
+
+global const u8 image_png_length_extra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0,
+};
+
+global const u16 image_png_distance_base[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769,
+    1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577,
+};
+
+global const u8 image_png_distance_extra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13,
+};
+
+global const u8 image_png_code_length_order[19] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15,
+};
+
+#define IMAGE_PNG_ADLER_BASE 65521
+#define IMAGE_PNG_ADLER_MAX 5552 // @Note: Most bytes before the sums have to be reduced to stay in 32 bits
+
+//
+// @Note: Checksums
+//
+
+internal u32 image_png_crc(Image_Png *png, u32 crc, u8 *data, usize size)
+{
+    crc = ~crc;
+    for (usize i = 0; i < size; ++i) {
+        crc = png->crc_table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    
+    u32 result = ~crc;
+    return(result);
+}
+
+internal u32 image_png_adler_scalar(u32 adler, u8 *data, usize size)
+{
+    u32 a = adler & 0xFFFF;
+    u32 b = adler >> 16;
+    while (size > 0) {
+        usize count = MIN(size, IMAGE_PNG_ADLER_MAX);
+        size -= count;
+        for (usize i = 0; i < count; ++i) {
+            a += data[i];
+            b += a;
+        }
+        
+        data += count;
+        a %= IMAGE_PNG_ADLER_BASE;
+        b %= IMAGE_PNG_ADLER_BASE;
+    }
+    
+    u32 result = a | (b << 16);
+    return(result);
+}
+
+internal u32 image_png_sum_avx2(__m256i value)
+{
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(value), _mm256_extracti128_si256(value, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    
+    u32 result = (u32) _mm_cvtsi128_si32(sum);
+    return(result);
+}
+
+internal u32 image_png_adler_avx2(u32 adler, u8 *data, usize size)
+{
+    // @Note: For 32 bytes 'b' grows by 32 times 'a' plus every byte weighed by how many sums it is
+    // still in, so 32 for the first down to 1 for the last. The 32 times 'a' part is kept in 'prefix'
+    // as the sum of 'a' over the blocks so far and multiplied in once at the end.
+    __m256i weights = _mm256_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17,
+                                       16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+    __m256i ones = _mm256_set1_epi16(1);
+    __m256i zero = _mm256_setzero_si256();
+    
+    u32 a = adler & 0xFFFF;
+    u32 b = adler >> 16;
+    usize blocks = size/32;
+    while (blocks > 0) {
+        usize count = MIN(blocks, IMAGE_PNG_ADLER_MAX/32);
+        blocks -= count;
+        
+        __m256i prefix = _mm256_setr_epi32((s32) (a*count), 0, 0, 0, 0, 0, 0, 0);
+        __m256i sum_b = _mm256_setr_epi32((s32) b, 0, 0, 0, 0, 0, 0, 0);
+        __m256i sum_a = zero;
+        for (usize i = 0; i < count; ++i) {
+            __m256i bytes = _mm256_loadu_si256((__m256i *) data);
+            prefix = _mm256_add_epi32(prefix, sum_a);
+            sum_a = _mm256_add_epi32(sum_a, _mm256_sad_epu8(bytes, zero));
+            sum_b = _mm256_add_epi32(sum_b, _mm256_madd_epi16(_mm256_maddubs_epi16(bytes, weights), ones));
+            data += 32;
+        }
+        
+        sum_b = _mm256_add_epi32(sum_b, _mm256_slli_epi32(prefix, 5));
+        a = (a + image_png_sum_avx2(sum_a)) % IMAGE_PNG_ADLER_BASE;
+        b = image_png_sum_avx2(sum_b) % IMAGE_PNG_ADLER_BASE;
+    }
+    
+    u32 result = image_png_adler_scalar(a | (b << 16), data, size % 32);
+    return(result);
+}
+
+internal u32 image_png_adler_combine(u32 first, u32 second, usize second_size)
+{
+    // @Note: zlib's adler32_combine(), the checksum of both pieces one after the other.
+    u32 rem = (u32) (second_size % IMAGE_PNG_ADLER_BASE);
+    u32 a = first & 0xFFFF;
+    u32 b = (rem*a) % IMAGE_PNG_ADLER_BASE;
+    a += (second & 0xFFFF) + IMAGE_PNG_ADLER_BASE - 1;
+    b += (first >> 16) + (second >> 16) + IMAGE_PNG_ADLER_BASE - rem;
+    
+    if (a >= IMAGE_PNG_ADLER_BASE) a -= IMAGE_PNG_ADLER_BASE;
+    if (a >= IMAGE_PNG_ADLER_BASE) a -= IMAGE_PNG_ADLER_BASE;
+    if (b >= 2*IMAGE_PNG_ADLER_BASE) b -= 2*IMAGE_PNG_ADLER_BASE;
+    if (b >= IMAGE_PNG_ADLER_BASE) b -= IMAGE_PNG_ADLER_BASE;
+    
+    u32 result = a | (b << 16);
+    return(result);
+}
+
+//
+// @Note: Filters
+//
+
+internal void image_png_rgb(u8 *out, u8 *pixels, u32 width)
+{
+    for (u32 x = 0; x < width; ++x) {
+        out[3*x + 0] = pixels[4*x + 0];
+        out[3*x + 1] = pixels[4*x + 1];
+        out[3*x + 2] = pixels[4*x + 2];
+    }
+}
+
+internal u8 image_png_paeth(s32 a, s32 b, s32 c)
+{
+    s32 pa = b - c;
+    s32 pb = a - c;
+    s32 pc = pa + pb;
+    pa = pa < 0 ? -pa : pa;
+    pb = pb < 0 ? -pb : pb;
+    pc = pc < 0 ? -pc : pc;
+    
+    u8 result = (u8) (pa <= pb && pa <= pc ? a : (pb <= pc ? b : c));
+    return(result);
+}
+
+// @Note: Bytes 'first' up to 'count' of the row under all five filters into the candidates, their
+// absolute values as signed bytes are added to 'sums'.
+internal void image_png_filter_scalar(Image_Png_Worker *worker, u32 first, u32 count, u64 *sums)
+{
+    u8 *left = worker->lines[0];
+    u8 *up_left = worker->lines[1];
+    u8 *row = left + 3;
+    u8 *up = up_left + 3;
+    for (u32 x = first; x < count; ++x) {
+        u8 raw = row[x];
+        u8 a = left[x];
+        u8 b = up[x];
+        u8 c = up_left[x];
+        
+        u8 values[IMAGE_PNG_FILTER_COUNT] = {
+            raw,
+            (u8) (raw - a),
+            (u8) (raw - b),
+            (u8) (raw - ((a + b) >> 1)),
+            (u8) (raw - image_png_paeth(a, b, c)),
+        };
+        
+        for (u32 i = 0; i < IMAGE_PNG_FILTER_COUNT; ++i) {
+            s32 value = (s8) values[i];
+            worker->candidates[i][1 + x] = values[i];
+            sums[i] += (u64) (value < 0 ? -value : value);
+        }
+    }
+}
+
+internal __m256i image_png_paeth_avx2(__m256i a, __m256i b, __m256i c)
+{
+    // @Note: 16 bits a value, pick 'a' when its distance is the smallest, else 'b' when it's smaller
+    // than 'c's, else 'c'. Same ties as image_png_paeth().
+    __m256i to_b = _mm256_sub_epi16(b, c);
+    __m256i to_a = _mm256_sub_epi16(a, c);
+    __m256i pa = _mm256_abs_epi16(to_b);
+    __m256i pb = _mm256_abs_epi16(to_a);
+    __m256i pc = _mm256_abs_epi16(_mm256_add_epi16(to_b, to_a));
+    __m256i smallest = _mm256_min_epi16(_mm256_min_epi16(pa, pb), pc);
+    
+    __m256i result = _mm256_blendv_epi8(c, b, _mm256_cmpeq_epi16(pb, smallest));
+    result = _mm256_blendv_epi8(result, a, _mm256_cmpeq_epi16(pa, smallest));
+    return(result);
+}
+
+internal void image_png_filter_avx2(Image_Png_Worker *worker, u32 count, u64 *sums)
+{
+    u8 *row = worker->lines[0] + 3;
+    u8 *up = worker->lines[1] + 3;
+    __m256i zero = _mm256_setzero_si256();
+    __m256i one = _mm256_set1_epi8(1);
+    __m256i totals[IMAGE_PNG_FILTER_COUNT];
+    for (u32 i = 0; i < IMAGE_PNG_FILTER_COUNT; ++i) {
+        totals[i] = zero;
+    }
+    
+    u32 x = 0;
+    for (; x + 32 <= count; x += 32) {
+        __m256i raw = _mm256_loadu_si256((__m256i *) (row + x));
+        __m256i a = _mm256_loadu_si256((__m256i *) (row + x - 3));
+        __m256i b = _mm256_loadu_si256((__m256i *) (up + x));
+        __m256i c = _mm256_loadu_si256((__m256i *) (up + x - 3));
+        
+        // @Note: Rounding average minus the carry of the lowest bit is the truncating one
+        __m256i average = _mm256_sub_epi8(_mm256_avg_epu8(a, b), _mm256_and_si256(_mm256_xor_si256(a, b), one));
+        
+        __m256i paeth_lo = image_png_paeth_avx2(_mm256_unpacklo_epi8(a, zero), _mm256_unpacklo_epi8(b, zero), _mm256_unpacklo_epi8(c, zero));
+        __m256i paeth_hi = image_png_paeth_avx2(_mm256_unpackhi_epi8(a, zero), _mm256_unpackhi_epi8(b, zero), _mm256_unpackhi_epi8(c, zero));
+        __m256i paeth = _mm256_packus_epi16(paeth_lo, paeth_hi);
+        
+        __m256i values[IMAGE_PNG_FILTER_COUNT] = {
+            raw,
+            _mm256_sub_epi8(raw, a),
+            _mm256_sub_epi8(raw, b),
+            _mm256_sub_epi8(raw, average),
+            _mm256_sub_epi8(raw, paeth),
+        };
+        
+        for (u32 i = 0; i < IMAGE_PNG_FILTER_COUNT; ++i) {
+            _mm256_storeu_si256((__m256i *) (worker->candidates[i] + 1 + x), values[i]);
+            totals[i] = _mm256_add_epi64(totals[i], _mm256_sad_epu8(_mm256_abs_epi8(values[i]), zero));
+        }
+    }
+    
+    for (u32 i = 0; i < IMAGE_PNG_FILTER_COUNT; ++i) {
+        u64 lanes[4];
+        _mm256_storeu_si256((__m256i *) lanes, totals[i]);
+        sums[i] += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    }
+    
+    image_png_filter_scalar(worker, x, count, sums);
+}
+
+internal void image_png_filter_worker(void *data)
+{
+    OPTICK_EVENT();
+    
+    Image_Png_Worker *worker = (Image_Png_Worker *) data;
+    Image_Png *png = worker->png;
+    u32 width = png->width;
+    u32 count = width*3;
+    usize pitch = (usize) width*4;
+    
+    // @Note: The first row of the picture has zeros above it
+    u8 *above = worker->first_row > 0 ? png->band + (worker->first_row - 1)*pitch : png->previous;
+    if (png->band_first + worker->first_row > 0) {
+        image_png_rgb(worker->lines[1] + 3, above, width);
+    } else {
+        MemoryZero(worker->lines[1] + 3, count);
+    }
+    
+    for (u32 row = worker->first_row; row < worker->first_row + worker->row_count; ++row) {
+        image_png_rgb(worker->lines[0] + 3, png->band + row*pitch, width);
+        
+        u64 sums[IMAGE_PNG_FILTER_COUNT] = {0};
+        if (png->avx2) {
+            image_png_filter_avx2(worker, count, sums);
+        } else {
+            image_png_filter_scalar(worker, 0, count, sums);
+        }
+        
+        u32 best = 0;
+        for (u32 i = 1; i < IMAGE_PNG_FILTER_COUNT; ++i) {
+            if (sums[i] < sums[best]) {
+                best = i;
+            }
+        }
+        
+        u8 *out = png->filtered + png->history + (usize) row*png->line_size;
+        MemoryCopy(out, worker->candidates[best], png->line_size);
+        
+        u8 *swap = worker->lines[0];
+        worker->lines[0] = worker->lines[1];
+        worker->lines[1] = swap;
+    }
+}
+
+//
+// @Note: Huffman codes
+//
+
+// @Note: Code lengths of at most 'limit' bits for 'count' symbols. Moffat and Katajainen's in-place
+// minimum redundancy lengths on the used symbols sorted by count, then moving leaves up until the
+// longest fits, the way miniz does it. Always gives at least two codes, some decoders don't take one.
+internal void image_png_huffman_build(Image_Png_Huffman *table, u32 *counts, u32 count, u32 limit)
+{
+    u32 used[288];
+    u32 lengths[288] = {0};
+    u32 used_count = 0;
+    for (u32 i = 0; i < count; ++i) {
+        if (counts[i] > 0) {
+            used[used_count++] = (counts[i] << 9) | i;
+        }
+    }
+    
+    for (u32 i = 0; i < 2 && used_count < 2; ++i) {
+        if (counts[i] == 0) {
+            used[used_count++] = (1 << 9) | i;
+        }
+    }
+    
+    // @Note: Insertion sort by count, there are at most 288 symbols
+    for (u32 i = 1; i < used_count; ++i) {
+        u32 key = used[i];
+        u32 j = i;
+        while (j > 0 && used[j - 1] > key) {
+            used[j] = used[j - 1];
+            j -= 1;
+        }
+        
+        used[j] = key;
+    }
+    
+    s32 n = (s32) used_count;
+    for (s32 i = 0; i < n; ++i) {
+        lengths[i] = used[i] >> 9;
+    }
+    
+    lengths[0] += lengths[1];
+    s32 root = 0;
+    s32 leaf = 2;
+    for (s32 next = 1; next < n - 1; ++next) {
+        if (leaf >= n || lengths[root] < lengths[leaf]) {
+            lengths[next] = lengths[root];
+            lengths[root++] = (u32) next;
+        } else {
+            lengths[next] = lengths[leaf++];
+        }
+        
+        if (leaf >= n || (root < next && lengths[root] < lengths[leaf])) {
+            lengths[next] += lengths[root];
+            lengths[root++] = (u32) next;
+        } else {
+            lengths[next] += lengths[leaf++];
+        }
+    }
+    
+    lengths[n - 2] = 0;
+    for (s32 next = n - 3; next >= 0; --next) {
+        lengths[next] = lengths[lengths[next]] + 1;
+    }
+    
+    s32 available = 1;
+    s32 taken = 0;
+    s32 depth = 0;
+    root = n - 2;
+    s32 next = n - 1;
+    while (available > 0) {
+        while (root >= 0 && (s32) lengths[root] == depth) {
+            taken += 1;
+            root -= 1;
+        }
+        
+        while (available > taken) {
+            lengths[next--] = (u32) depth;
+            available -= 1;
+        }
+        
+        available = 2*taken;
+        depth += 1;
+        taken = 0;
+    }
+    
+    u32 length_counts[33] = {0};
+    for (s32 i = 0; i < n; ++i) {
+        length_counts[MIN(lengths[i], 32)] += 1;
+    }
+    
+    for (u32 i = limit + 1; i <= 32; ++i) {
+        length_counts[limit] += length_counts[i];
+        length_counts[i] = 0;
+    }
+    
+    u32 total = 0;
+    for (u32 i = limit; i > 0; --i) {
+        total += length_counts[i] << (limit - i);
+    }
+    
+    while (total != (1u << limit)) {
+        length_counts[limit] -= 1;
+        for (u32 i = limit - 1; i > 0; --i) {
+            if (length_counts[i] > 0) {
+                length_counts[i] -= 1;
+                length_counts[i + 1] += 2;
+                break;
+            }
+        }
+        
+        total -= 1;
+    }
+    
+    // @Note: Shortest codes to the most used symbols, which sit at the end
+    MemoryZero(table->size, sizeof(table->size));
+    s32 at = n;
+    for (u32 size = 1; size <= limit; ++size) {
+        for (u32 i = 0; i < length_counts[size]; ++i) {
+            table->size[used[--at] & 0x1FF] = (u8) size;
+        }
+    }
+    
+    u32 next_code[16] = {0};
+    u32 code = 0;
+    u32 size_counts[16] = {0};
+    for (u32 i = 0; i < count; ++i) {
+        size_counts[table->size[i]] += 1;
+    }
+    
+    size_counts[0] = 0;
+    for (u32 size = 1; size <= 15; ++size) {
+        code = (code + size_counts[size - 1]) << 1;
+        next_code[size] = code;
+    }
+    
+    for (u32 i = 0; i < count; ++i) {
+        u32 size = table->size[i];
+        if (size > 0) {
+            u32 value = next_code[size]++;
+            u32 reversed = 0;
+            for (u32 bit = 0; bit < size; ++bit) {
+                reversed = (reversed << 1) | ((value >> bit) & 1);
+            }
+            
+            table->code[i] = (u16) reversed;
+        }
+    }
+}
+
+//
+// @Note: Deflate
+//
+
+internal void image_png_put_bits(Image_Png_Worker *worker, u32 value, u32 size)
+{
+    // @Note: At most 28 bits come in at once, deflate fills bytes from the lowest bit up.
+    worker->bits |= (u64) value << worker->bit_count;
+    worker->bit_count += size;
+    
+    if (worker->bit_count >= 32) {
+        Image_Png_Chunk *chunk = worker->last;
+        u8 *at = chunk->data + chunk->size;
+        u32 word = (u32) worker->bits;
+        at[0] = (u8) word;
+        at[1] = (u8) (word >> 8);
+        at[2] = (u8) (word >> 16);
+        at[3] = (u8) (word >> 24);
+        chunk->size += 4;
+        
+        worker->bits >>= 32;
+        worker->bit_count -= 32;
+    }
+}
+
+internal void image_png_align(Image_Png_Worker *worker)
+{
+    worker->bit_count = (worker->bit_count + 7) & ~7u;
+    while (worker->bit_count > 0) {
+        Image_Png_Chunk *chunk = worker->last;
+        chunk->data[chunk->size++] = (u8) worker->bits;
+        worker->bits >>= 8;
+        worker->bit_count -= 8;
+    }
+}
+
+internal void image_png_reserve(Image_Png_Worker *worker)
+{
+    // @Note: Called before every block, so the writes below never check for room.
+    if (worker->last == 0 || worker->last->size + IMAGE_PNG_BLOCK_BOUND > IMAGE_PNG_CHUNK_SIZE) {
+        Image_Png_Chunk *chunk = (Image_Png_Chunk *) arena_push_no_zero(worker->arena, sizeof(Image_Png_Chunk));
+        chunk->size = 0;
+        SLLQueuePush(worker->first, worker->last, chunk);
+    }
+}
+
+internal void image_png_block(Image_Png_Worker *worker)
+{
+    Image_Png *png = worker->png;
+    image_png_reserve(worker);
+    
+    worker->litlen_counts[256] = 1;
+    Image_Png_Huffman litlen = {0};
+    Image_Png_Huffman distance = {0};
+    image_png_huffman_build(&litlen, worker->litlen_counts, 286, 15);
+    image_png_huffman_build(&distance, worker->distance_counts, 30, 15);
+    
+    u32 litlen_count = 286;
+    while (litlen_count > 257 && litlen.size[litlen_count - 1] == 0) {
+        litlen_count -= 1;
+    }
+    
+    u32 distance_count = 30;
+    while (distance_count > 1 && distance.size[distance_count - 1] == 0) {
+        distance_count -= 1;
+    }
+    
+    // @Note: Both code lengths as one list, runs of the same length become 16, runs of zeros 17 and 18.
+    u8 sizes[286 + 30];
+    u32 size_count = 0;
+    for (u32 i = 0; i < litlen_count; ++i) {
+        sizes[size_count++] = litlen.size[i];
+    }
+    
+    for (u32 i = 0; i < distance_count; ++i) {
+        sizes[size_count++] = distance.size[i];
+    }
+    
+    u8 runs[286 + 30];
+    u8 run_extra[286 + 30];
+    u32 run_count = 0;
+    u32 length_counts[19] = {0};
+    for (u32 i = 0; i < size_count;) {
+        u8 size = sizes[i];
+        u32 repeat = 1;
+        while (i + repeat < size_count && sizes[i + repeat] == size) {
+            repeat += 1;
+        }
+        
+        if (size == 0 && repeat >= 3) {
+            repeat = MIN(repeat, 138);
+            runs[run_count] = repeat >= 11 ? 18 : 17;
+            run_extra[run_count++] = (u8) (repeat - (repeat >= 11 ? 11 : 3));
+        } else if (size != 0 && repeat >= 4) {
+            repeat = MIN(repeat - 1, 6) + 1;
+            runs[run_count] = size;
+            run_extra[run_count++] = 0;
+            runs[run_count] = 16;
+            run_extra[run_count++] = (u8) (repeat - 1 - 3);
+        } else {
+            repeat = 1;
+            runs[run_count] = size;
+            run_extra[run_count++] = 0;
+        }
+        
+        i += repeat;
+    }
+    
+    for (u32 i = 0; i < run_count; ++i) {
+        length_counts[runs[i]] += 1;
+    }
+    
+    Image_Png_Huffman lengths = {0};
+    image_png_huffman_build(&lengths, length_counts, 19, 7);
+    
+    u32 order_count = 19;
+    while (order_count > 4 && lengths.size[image_png_code_length_order[order_count - 1]] == 0) {
+        order_count -= 1;
+    }
+    
+    image_png_put_bits(worker, 2 << 1, 3);
+    image_png_put_bits(worker, litlen_count - 257, 5);
+    image_png_put_bits(worker, distance_count - 1, 5);
+    image_png_put_bits(worker, order_count - 4, 4);
+    for (u32 i = 0; i < order_count; ++i) {
+        image_png_put_bits(worker, lengths.size[image_png_code_length_order[i]], 3);
+    }
+    
+    static const u8 run_extra_bits[3] = {2, 3, 7};
+    for (u32 i = 0; i < run_count; ++i) {
+        u32 symbol = runs[i];
+        image_png_put_bits(worker, lengths.code[symbol], lengths.size[symbol]);
+        if (symbol >= 16) {
+            image_png_put_bits(worker, run_extra[i], run_extra_bits[symbol - 16]);
+        }
+    }
+    
+    for (u32 i = 0; i < worker->symbol_count; ++i) {
+        Image_Png_Symbol symbol = worker->symbols[i];
+        if (symbol.distance == 0) {
+            image_png_put_bits(worker, litlen.code[symbol.value], litlen.size[symbol.value]);
+        } else {
+            u32 code = png->length_code[symbol.value];
+            u32 extra = image_png_length_extra[code];
+            u32 bits = litlen.code[257 + code] | ((symbol.value - image_png_length_base[code]) << litlen.size[257 + code]);
+            image_png_put_bits(worker, bits, litlen.size[257 + code] + extra);
+            
+            u32 d = symbol.distance - 1;
+            code = png->distance_code[d < 256 ? d : 256 + (d >> 7)];
+            extra = image_png_distance_extra[code];
+            bits = distance.code[code] | ((symbol.distance - image_png_distance_base[code]) << distance.size[code]);
+            image_png_put_bits(worker, bits, distance.size[code] + extra);
+        }
+    }
+    
+    image_png_put_bits(worker, litlen.code[256], litlen.size[256]);
+    
+    worker->symbol_count = 0;
+    MemoryZero(worker->litlen_counts, sizeof(worker->litlen_counts));
+    MemoryZero(worker->distance_counts, sizeof(worker->distance_counts));
+}
+
+internal u32 image_png_hash(u8 *at)
+{
+    u32 value = *(u32 *) at;
+    
+    u32 result = (value*2654435761u) >> (32 - IMAGE_PNG_HASH_BITS);
+    return(result);
+}
+
+internal u32 image_png_match(u8 *a, u8 *b, u32 limit)
+{
+    u32 result = 0;
+    while (result + 8 <= limit && *(u64 *) (a + result) == *(u64 *) (b + result)) {
+        result += 8;
+    }
+    
+    while (result < limit && a[result] == b[result]) {
+        result += 1;
+    }
+    
+    return(result);
+}
+
+internal void image_png_deflate(Image_Png_Worker *worker, u8 *data, usize start, usize end)
+{
+    // @Note: Positions are from 'data', the window in front of 'start' is hashed first so matches can
+    // go back into it. Heads hold the position plus one, an empty one wraps around to never be behind.
+    Image_Png *png = worker->png;
+    MemoryZero(worker->head, sizeof(u32) << IMAGE_PNG_HASH_BITS);
+    
+    usize window = start > IMAGE_PNG_WINDOW ? start - IMAGE_PNG_WINDOW : 0;
+    for (usize at = window; at < start && at + 4 <= end; ++at) {
+        worker->head[image_png_hash(data + at)] = (u32) at + 1;
+    }
+    
+    usize at = start;
+    while (at < end) {
+        u32 length = 0;
+        u32 distance = 0;
+        if (at + IMAGE_PNG_MIN_MATCH <= end) {
+            u32 hash = image_png_hash(data + at);
+            usize candidate = (usize) worker->head[hash] - 1;
+            worker->head[hash] = (u32) at + 1;
+            
+            if (candidate < at && at - candidate <= IMAGE_PNG_WINDOW) {
+                length = image_png_match(data + candidate, data + at, (u32) MIN(end - at, IMAGE_PNG_MAX_MATCH));
+                distance = (u32) (at - candidate);
+            }
+        }
+        
+        Image_Png_Symbol *symbol = worker->symbols + worker->symbol_count++;
+        if (length >= IMAGE_PNG_MIN_MATCH) {
+            symbol->value = (u16) length;
+            symbol->distance = (u16) distance;
+            worker->litlen_counts[257 + png->length_code[length]] += 1;
+            
+            u32 d = distance - 1;
+            worker->distance_counts[png->distance_code[d < 256 ? d : 256 + (d >> 7)]] += 1;
+            
+            if (length <= IMAGE_PNG_INSERT_MATCH) {
+                for (usize i = at + 1; i < at + length && i + 4 <= end; ++i) {
+                    worker->head[image_png_hash(data + i)] = (u32) i + 1;
+                }
+            }
+            
+            at += length;
+        } else {
+            symbol->value = data[at];
+            symbol->distance = 0;
+            worker->litlen_counts[data[at]] += 1;
+            at += 1;
+        }
+        
+        if (worker->symbol_count == IMAGE_PNG_BLOCK_SYMBOLS) {
+            image_png_block(worker);
+        }
+    }
+    
+    if (worker->symbol_count > 0) {
+        image_png_block(worker);
+    }
+    
+    // @Note: Empty stored block, brings the stream back to a byte boundary so the next piece can follow
+    image_png_reserve(worker);
+    image_png_put_bits(worker, 0, 3);
+    image_png_align(worker);
+    
+    Image_Png_Chunk *chunk = worker->last;
+    u8 sync[4] = {0x00, 0x00, 0xFF, 0xFF};
+    MemoryCopy(chunk->data + chunk->size, sync, sizeof(sync));
+    chunk->size += sizeof(sync);
+}
+
+internal void image_png_deflate_worker(void *data)
+{
+    OPTICK_EVENT();
+    
+    Image_Png_Worker *worker = (Image_Png_Worker *) data;
+    Image_Png *png = worker->png;
+    
+    usize start = png->history + (usize) worker->first_row*png->line_size;
+    usize end = start + (usize) worker->row_count*png->line_size;
+    worker->adler = png->avx2 ? image_png_adler_avx2(1, png->filtered + start, end - start) : image_png_adler_scalar(1, png->filtered + start, end - start);
+    
+    image_png_deflate(worker, png->filtered, start, end);
+    
+    worker->out_size = 0;
+    u8 type[4] = {'I', 'D', 'A', 'T'};
+    worker->crc = image_png_crc(png, 0, type, sizeof(type));
+    for (Image_Png_Chunk *chunk = worker->first; chunk != 0; chunk = chunk->next) {
+        worker->crc = image_png_crc(png, worker->crc, chunk->data, chunk->size);
+        worker->out_size += chunk->size;
+    }
+}
+
+internal void image_png_filter_thread(void *data)
+{
+    OPTICK_THREAD("PNG filter");
+    image_png_filter_worker(data);
+}
+
+internal void image_png_deflate_thread(void *data)
+{
+    OPTICK_THREAD("PNG deflate");
+    image_png_deflate_worker(data);
+}
+
+//
+// @Note: Chunks
+//
+
+internal void image_png_chunk(Image_Png *png, Image_File *file, const char *type, u8 *data, u32 size)
+{
+    u8 header[8] = {(u8) (size >> 24), (u8) (size >> 16), (u8) (size >> 8), (u8) size};
+    MemoryCopy(header + 4, type, 4);
+    
+    u32 crc = image_png_crc(png, 0, header + 4, 4);
+    crc = image_png_crc(png, crc, data, size);
+    u8 footer[4] = {(u8) (crc >> 24), (u8) (crc >> 16), (u8) (crc >> 8), (u8) crc};
+    
+    image_file_write(file, header, sizeof(header));
+    image_file_write(file, data, size);
+    image_file_write(file, footer, sizeof(footer));
+}
+
+internal void image_png_run(Image_Png *png, u32 worker_count, OS_Thread_Func *thread_func, OS_Thread_Func *func)
+{
+    // @Note: Worker 0 is the calling thread, a worker that fails to start is done on it too.
+    OS_Thread threads[IMAGE_PNG_MAX_WORKERS] = {0};
+    b32 started[IMAGE_PNG_MAX_WORKERS] = {0};
+    for (u32 i = 1; i < worker_count; ++i) {
+        started[i] = os_thread_start(threads + i, thread_func, png->workers + i);
+    }
+    
+    func(png->workers);
+    
+    for (u32 i = 1; i < worker_count; ++i) {
+        if (started[i]) {
+            os_thread_join(threads + i);
+        } else {
+            func(png->workers + i);
+        }
+    }
+}
+
+internal void image_png_flush(Image_Png *png, Image_File *file)
+{
+    OPTICK_EVENT();
+    
+    u32 worker_count = MIN(png->worker_count, png->band_lines);
+    for (u32 i = 0; i < worker_count; ++i) {
+        Image_Png_Worker *worker = png->workers + i;
+        worker->first_row = png->band_lines*i/worker_count;
+        worker->row_count = png->band_lines*(i + 1)/worker_count - worker->first_row;
+    }
+    
+    // @Note: Filtering has to be done everywhere before anyone deflates, the window reaches into the
+    // rows of the worker before.
+    image_png_run(png, worker_count, image_png_filter_thread, image_png_filter_worker);
+    image_png_run(png, worker_count, image_png_deflate_thread, image_png_deflate_worker);
+    
+    for (u32 i = 0; i < worker_count; ++i) {
+        Image_Png_Worker *worker = png->workers + i;
+        u8 header[8] = {
+            (u8) (worker->out_size >> 24), (u8) (worker->out_size >> 16), (u8) (worker->out_size >> 8), (u8) worker->out_size,
+            'I', 'D', 'A', 'T',
+        };
+        u8 footer[4] = {(u8) (worker->crc >> 24), (u8) (worker->crc >> 16), (u8) (worker->crc >> 8), (u8) worker->crc};
+        
+        image_file_write(file, header, sizeof(header));
+        for (Image_Png_Chunk *chunk = worker->first; chunk != 0; chunk = chunk->next) {
+            image_file_write(file, chunk->data, chunk->size);
+        }
+        image_file_write(file, footer, sizeof(footer));
+        
+        png->adler = image_png_adler_combine(png->adler, worker->adler, (usize) worker->row_count*png->line_size);
+        
+        worker->first = worker->last = 0;
+        arena_clear(worker->arena);
+    }
+    
+    // @Note: The end of this band is the window of the next one
+    usize pitch = (usize) png->width*4;
+    usize size = png->history + (usize) png->band_lines*png->line_size;
+    usize keep = MIN(size, IMAGE_PNG_WINDOW);
+    MemoryCopy(png->filtered, png->filtered + size - keep, keep);
+    MemoryCopy(png->previous, png->band + (png->band_lines - 1)*pitch, pitch);
+    png->history = keep;
+    
+    png->band_first += png->band_lines;
+    png->band_lines = 0;
+}
+
+internal b32 image_png_begin(Image_Png *png, Arena *arena, Image_File *file, u32 width, u32 height, Image_Options options)
+{
+    png->width = width;
+    png->height = height;
+    png->avx2 = os_cpu_has_avx2();
+    png->line_size = 1 + 3*width;
+    
+    png->band = arena_push_array(arena, u8, (usize) width*4*IMAGE_PNG_BAND_LINES);
+    png->band_first = 0;
+    png->band_lines = 0;
+    png->previous = arena_push_array(arena, u8, (usize) width*4);
+    png->filtered = arena_push_array(arena, u8, IMAGE_PNG_WINDOW + (usize) png->line_size*IMAGE_PNG_BAND_LINES);
+    png->history = 0;
+    png->adler = 1;
+    
+    for (u32 code = 0; code < ARRAY_SIZE(image_png_length_base); ++code) {
+        for (u32 i = 0; i < (1u << image_png_length_extra[code]) && image_png_length_base[code] + i <= IMAGE_PNG_MAX_MATCH; ++i) {
+            png->length_code[image_png_length_base[code] + i] = (u8) code;
+        }
+    }
+    
+    for (u32 code = 0; code < ARRAY_SIZE(image_png_distance_base); ++code) {
+        for (u32 i = 0; i < (1u << image_png_distance_extra[code]); ++i) {
+            u32 d = image_png_distance_base[code] + i - 1;
+            png->distance_code[d < 256 ? d : 256 + (d >> 7)] = (u8) code;
+        }
+    }
+    
+    for (u32 i = 0; i < 256; ++i) {
+        u32 crc = i;
+        for (u32 bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1) ? 0xEDB88320 ^ (crc >> 1) : crc >> 1;
+        }
+        
+        png->crc_table[i] = crc;
+    }
+    
+    u32 workers = options.workers ? options.workers : os_cpu_count();
+    png->worker_count = MAX(1, MIN(workers, IMAGE_PNG_MAX_WORKERS));
+    for (u32 i = 0; i < png->worker_count; ++i) {
+        Image_Png_Worker *worker = png->workers + i;
+        worker->png = png;
+        worker->arena = arena_make();
+        worker->first = worker->last = 0;
+        worker->bits = 0;
+        worker->bit_count = 0;
+        worker->symbol_count = 0;
+        
+        // @Note: Rows get 3 zero bytes in front, the left neighbour of the first pixel, and 32 past the end for the loads
+        for (u32 j = 0; j < 2; ++j) {
+            worker->lines[j] = arena_push_array(arena, u8, png->line_size + 3 + 32);
+        }
+        
+        for (u32 j = 0; j < IMAGE_PNG_FILTER_COUNT; ++j) {
+            worker->candidates[j] = arena_push_array(arena, u8, png->line_size + 32);
+            worker->candidates[j][0] = (u8) j;
+        }
+        
+        worker->head = arena_push_array(arena, u32, 1 << IMAGE_PNG_HASH_BITS);
+        worker->symbols = arena_push_array(arena, Image_Png_Symbol, IMAGE_PNG_BLOCK_SYMBOLS);
+    }
+    
+    // @Note: 8 bit RGB, no interlacing. The zlib header goes out in its own IDAT, 32 KB window, no preset dictionary.
+    u8 signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    image_file_write(file, signature, sizeof(signature));
+    
+    u8 ihdr[13] = {
+        (u8) (width >> 24), (u8) (width >> 16), (u8) (width >> 8), (u8) width,
+        (u8) (height >> 24), (u8) (height >> 16), (u8) (height >> 8), (u8) height,
+        8, 2, 0, 0, 0,
+    };
+    image_png_chunk(png, file, "IHDR", ihdr, sizeof(ihdr));
+    
+    u8 zlib[2] = {0x78, 0x01};
+    image_png_chunk(png, file, "IDAT", zlib, sizeof(zlib));
+    
+    b32 result = !file->failed;
+    return(result);
+}
+
+internal void image_png_rows(Image_Png *png, Image_File *file, u8 *pixels, u32 count, u32 pitch)
+{
+    usize line_size = (usize) png->width*4;
+    for (u32 i = 0; i < count; ++i) {
+        MemoryCopy(png->band + png->band_lines*line_size, pixels + (usize) i*pitch, line_size);
+        png->band_lines += 1;
+        
+        if (png->band_lines == IMAGE_PNG_BAND_LINES) {
+            image_png_flush(png, file);
+        }
+    }
+}
+
+internal void image_png_end(Image_Png *png, Image_File *file)
+{
+    if (png->band_lines > 0) {
+        image_png_flush(png, file);
+    }
+    
+    // @Note: Final empty block with fixed codes, then the checksum of everything that went in
+    u8 tail[6] = {0x03, 0x00, (u8) (png->adler >> 24), (u8) (png->adler >> 16), (u8) (png->adler >> 8), (u8) png->adler};
+    image_png_chunk(png, file, "IDAT", tail, sizeof(tail));
+    image_png_chunk(png, file, "IEND", 0, 0);
+    
+    for (u32 i = 0; i < png->worker_count; ++i) {
+        arena_release(png->workers[i].arena);
+    }
+}
@@ -0,0 +1,97 @@
+#ifndef IMAGE_PNG_H
+#define IMAGE_PNG_H
+
+// @Note: 24 bit PNG. Rows are collected into a band of IMAGE_PNG_BAND_LINES and every band is done on
+// up to IMAGE_PNG_MAX_WORKERS threads, each taking a contiguous range of its rows, in two runs. First
+// the rows are filtered, every row gets whichever of the five filters leaves the smallest sum of
+// absolute values, the usual heuristic. Then every worker deflates its own rows into dynamic Huffman
+// blocks, with the 32 KB in front of them already in its hash table, so matches can reach back into the
+// rows of the worker before it the same as in one long stream. Each range ends on an empty stored block
+// to get back to a byte boundary, so the pieces only have to be written out in order.
+//
+// Matching is greedy with a single entry per hash, which is plenty for flat pictures: after filtering
+// most rows are long runs of zeros.
+#define IMAGE_PNG_BAND_LINES 256
+#define IMAGE_PNG_MAX_WORKERS 16
+#define IMAGE_PNG_WINDOW KB(32)
+#define IMAGE_PNG_HASH_BITS 15
+#define IMAGE_PNG_MIN_MATCH 4
+#define IMAGE_PNG_MAX_MATCH 258
+#define IMAGE_PNG_INSERT_MATCH 16 // @Note: Positions inside matches up to this long go into the hash table
+#define IMAGE_PNG_BLOCK_SYMBOLS KB(16)
+#define IMAGE_PNG_CHUNK_SIZE KB(256)
+#define IMAGE_PNG_BLOCK_BOUND (6*IMAGE_PNG_BLOCK_SYMBOLS + KB(1)) // @Note: Worst case of one block, 48 bits a symbol and the header
+#define IMAGE_PNG_FILTER_COUNT 5
+
+typedef struct Image_Png_Chunk {
+    struct Image_Png_Chunk *next;
+    usize size;
+    u8 data[IMAGE_PNG_CHUNK_SIZE];
+} Image_Png_Chunk;
+
+// @Note: A literal when 'distance' is zero, a match of 'value' bytes otherwise
+typedef struct {
+    u16 value;
+    u16 distance;
+} Image_Png_Symbol;
+
+// @Note: Codes are bit reversed, deflate sends them starting from the top bit
+typedef struct {
+    u16 code[288];
+    u8 size[288];
+} Image_Png_Huffman;
+
+typedef struct {
+    Image_Png *png; // @Note: Read only while the workers run
+    Arena *arena;   // @Note: Chunks, cleared after every band
+    
+    u32 first_row; // @Note: Rows of the band
+    u32 row_count;
+    
+    u8 *lines[2];                            // @Note: RGB of this and the previous row, 3 zero bytes in front
+    u8 *candidates[IMAGE_PNG_FILTER_COUNT]; // @Note: The row under every filter, filter type first
+    
+    u32 *head; // @Note: Last position for every hash, plus one
+    Image_Png_Symbol *symbols;
+    u32 symbol_count;
+    u32 litlen_counts[286];
+    u32 distance_counts[30];
+    
+    Image_Png_Chunk *first;
+    Image_Png_Chunk *last;
+    usize out_size;
+    u64 bits;
+    u32 bit_count;
+    
+    u32 adler; // @Note: Of the filtered rows
+    u32 crc;   // @Note: Of the chunk type and the output
+} Image_Png_Worker;
+
+struct Image_Png {
+    u32 width;
+    u32 height;
+    b32 avx2;
+    u32 line_size; // @Note: Filter type and RGB
+    
+    u8 *band;       // @Note: RGBA, IMAGE_PNG_BAND_LINES rows of the picture's width
+    u32 band_first; // @Note: First line of the picture in the band
+    u32 band_lines; // @Note: Filled so far
+    u8 *previous;   // @Note: RGBA of the line before the band
+    
+    u8 *filtered;  // @Note: IMAGE_PNG_WINDOW of the rows before the band, then the band's rows
+    usize history; // @Note: How much of that window there is
+    u32 adler;
+    
+    u8 length_code[IMAGE_PNG_MAX_MATCH + 1];
+    u8 distance_code[512]; // @Note: Distances up to 256 directly, past that in steps of 128
+    u32 crc_table[256];
+    
+    u32 worker_count;
+    Image_Png_Worker workers[IMAGE_PNG_MAX_WORKERS];
+};
+
+internal b32 image_png_begin(Image_Png *png, Arena *arena, Image_File *file, u32 width, u32 height, Image_Options options);
+internal void image_png_rows(Image_Png *png, Image_File *file, u8 *pixels, u32 count, u32 pitch);
+internal void image_png_end(Image_Png *png, Image_File *file);
+
+#endif // IMAGE_PNG_H
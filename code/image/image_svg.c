@@ -0,0 +1,568 @@
+internal void image_svg_print(Image_Svg *svg, char *line, s32 size)
+{
+    // @Note: snprintf() reports what it would have written, anything past the line was cut off.
+    if (size > 0) {
+        image_file_write(&svg->file, line, MIN((usize) size, IMAGE_SVG_LINE_SIZE - 1));
+    }
+}
+
+internal s32 image_svg_paint(char *out, usize cap, const char *attribute, u32 col)
+{
+    s32 size = snprintf(out, cap, " %s=\"#%06X\"", attribute, col >> 8);
+    if ((col & 0xFF) != 0xFF) {
+        size += snprintf(out + size, cap - size, " %s-opacity=\"%.3f\"", attribute, (f32) (col & 0xFF)/255.0f);
+    }
+    
+    return(size);
+}
+
+internal u64 image_svg_shape_hash(R_Texture2D *texture, RectF32 uv)
+{
+    u64 result = str8_hash((u64) (usize) texture, str8_make((u8 *) &uv, sizeof(RectF32)));
+    return(result);
+}
+
+internal Image_Svg_Shape *image_svg_shape_get(Image_Svg *svg, R_Texture2D *texture, RectF32 uv)
+{
+    Image_Svg_Shape *result = 0;
+    u64 hash = image_svg_shape_hash(texture, uv);
+    for (Image_Svg_Shape *shape = svg->shapes[hash % IMAGE_SVG_SHAPE_BUCKET_COUNT]; shape != 0 && result == 0; shape = shape->next) {
+        if (shape->texture == texture && MemoryMatch(&shape->uv, &uv, sizeof(RectF32))) {
+            result = shape;
+        }
+    }
+    
+    return(result);
+}
+
+internal b32 image_svg_is_solid(Image_Svg *svg, R_Texture2D *texture, RectF32 uv)
+{
+    RectF32 white = svg->solid.uv;
+    b32 result = (texture == svg->solid.texture &&
+                  uv.x0 >= white.x0 && uv.x1 <= white.x1 &&
+                  uv.y0 >= white.y0 && uv.y1 <= white.y1);
+    return(result);
+}
+
+internal void image_svg_init(Image_Svg *svg, Arena *arena, u32 width, u32 height, u32 background, u32 *palette, u32 palette_count)
+{
+    MemoryZero(svg, sizeof(Image_Svg));
+    svg->arena = arena;
+    svg->width = width;
+    svg->height = height;
+    svg->background = background;
+    svg->solid = r_solid_get();
+    MemoryCopy(svg->palette, palette, MIN(palette_count, R_MARKER_PALETTE_SIZE)*sizeof(u32));
+}
+
+internal void image_svg_resolve(Image_Svg *svg, R_List *list, Image_Svg_Shape_Func *func, void *user)
+{
+    OPTICK_EVENT();
+    
+    for (R_Cmd *cmd = list->first; cmd != 0; cmd = cmd->next) {
+        if (r_key_kind(cmd->key) != R_CMD_QUADS) continue;
+        
+        R_Texture2D *texture = list->textures[r_key_texture(cmd->key)];
+        R_Quad *quads = (R_Quad *) cmd->data;
+        for (usize i = 0; i < cmd->count; ++i) {
+            RectF32 uv = quads[i].uv;
+            if (image_svg_is_solid(svg, texture, uv) || image_svg_shape_get(svg, texture, uv) != 0) continue;
+            
+            // @Note: Also remembered when there's no outline, so it's only asked once.
+            Image_Svg_Shape *shape = arena_push_array(svg->arena, Image_Svg_Shape, 1);
+            shape->texture = texture;
+            shape->uv = uv;
+            shape->path = func(user, svg->arena, texture, uv, &shape->size);
+            shape->id = svg->shape_count++;
+            
+            u64 slot = image_svg_shape_hash(texture, uv) % IMAGE_SVG_SHAPE_BUCKET_COUNT;
+            shape->next = svg->shapes[slot];
+            svg->shapes[slot] = shape;
+        }
+    }
+}
+
+internal void image_svg_quads(Image_Svg *svg, R_List *list, R_Cmd *cmd)
+{
+    char line[IMAGE_SVG_LINE_SIZE];
+    R_Texture2D *texture = list->textures[r_key_texture(cmd->key)];
+    R_Quad *quads = (R_Quad *) cmd->data;
+    for (usize i = 0; i < cmd->count; ++i) {
+        R_Quad *quad = quads + i;
+        if ((quad->col & 0xFF) == 0) continue;
+        
+        // @Note: The backend grows quads by their radius and rounds the corners with it,
+        // rotations are about the center. Rotated ones are never culled, their bounds don't matter much.
+        RectF32 pos = {
+            quad->pos.x0 - quad->radius, quad->pos.y0 - quad->radius,
+            quad->pos.x1 + quad->radius, quad->pos.y1 + quad->radius,
+        };
+        if (quad->theta == 0.0f && (pos.x1 < 0.0f || pos.y1 < 0.0f || pos.x0 > (f32) svg->width || pos.y0 > (f32) svg->height)) {
+            continue;
+        }
+        
+        s32 size = 0;
+        if (image_svg_is_solid(svg, texture, quad->uv)) {
+            size = snprintf(line, sizeof(line), "<rect x=\"%.2f\" y=\"%.2f\" width=\"%.2f\" height=\"%.2f\"",
+                            pos.x0, pos.y0, pos.x1 - pos.x0, pos.y1 - pos.y0);
+            if (quad->radius > 0.0f) {
+                size += snprintf(line + size, sizeof(line) - size, " rx=\"%.2f\"", quad->radius);
+            }
+        } else {
+            Image_Svg_Shape *shape = image_svg_shape_get(svg, texture, quad->uv);
+            if (shape == 0 || shape->path.size == 0 || shape->size.X <= 0.0f || shape->size.Y <= 0.0f) {
+                svg->stats.skipped += 1;
+                continue;
+            }
+            
+            if (!shape->written) {
+                String8 start = str8("<defs><path id=\"s");
+                String8 end = str8("\"/></defs>\n");
+                image_file_write(&svg->file, start.data, start.size);
+                image_svg_print(svg, line, snprintf(line, sizeof(line), "%u\" d=\"", shape->id));
+                image_file_write(&svg->file, shape->path.data, shape->path.size);
+                image_file_write(&svg->file, end.data, end.size);
+                shape->written = 1;
+            }
+            
+            size = snprintf(line, sizeof(line), "<use xlink:href=\"#s%u\" transform=\"translate(%.2f %.2f) scale(%.4f %.4f)\"",
+                            shape->id, quad->pos.x0, quad->pos.y0,
+                            (quad->pos.x1 - quad->pos.x0)/shape->size.X, (quad->pos.y1 - quad->pos.y0)/shape->size.Y);
+        }
+        
+        if (quad->theta != 0.0f) {
+            f32 cx = (pos.x0 + pos.x1)*0.5f;
+            f32 cy = (pos.y0 + pos.y1)*0.5f;
+            size += snprintf(line + size, sizeof(line) - size, " transform=\"rotate(%.3f %.2f %.2f)\"",
+                             -quad->theta*(180.0f/HMM_PI32), cx, cy);
+        }
+        
+        size += image_svg_paint(line + size, sizeof(line) - size, "fill", quad->col);
+        size += snprintf(line + size, sizeof(line) - size, "/>\n");
+        image_svg_print(svg, line, size);
+        svg->stats.quads += 1;
+    }
+}
+
+internal f32 image_svg_marker_sdf(u32 shape, f32 dx, f32 dy, f32 r)
+{
+    // @Note: Same distances the backend shades markers with.
+    f32 result = 0.0f;
+    switch (shape) {
+        case R_MARKER_SQUARE: result = MAX(fabsf(dx), fabsf(dy)) - r; break;
+        case R_MARKER_DIAMOND: result = (fabsf(dx) + fabsf(dy) - r)*0.70710678f; break;
+        default: result = sqrtf(dx*dx + dy*dy) - r; break;
+    }
+    
+    return(result);
+}
+
+// @Note: Whether an opaque marker still shows over what's painted on top of it, and if so
+// paints the pixels it fully covers. Pixels outside of 'bounds' count as painted.
+internal b32 image_svg_marker_visible(Image_Svg *svg, R_Marker *marker, f32 r, RectF32 bounds)
+{
+    const f32 inner = -0.71f;       // @Note: Whole pixel inside the shape
+    const f32 outer = 1.75f + 0.71f; // @Note: Past the smooth edge
+    
+    s32 x0 = (s32) MAX(floorf(marker->x - r - outer), bounds.x0);
+    s32 y0 = (s32) MAX(floorf(marker->y - r - outer), bounds.y0);
+    s32 x1 = (s32) MIN(ceilf(marker->x + r + outer), bounds.x1 - 1.0f);
+    s32 y1 = (s32) MIN(ceilf(marker->y + r + outer), bounds.y1 - 1.0f);
+    
+    b32 result = 0;
+    for (s32 y = y0; y <= y1 && !result; ++y) {
+        for (s32 x = x0; x <= x1 && !result; ++x) {
+            u64 bit = (u64) y*svg->width + (u64) x;
+            if (!(svg->painted[bit/64] & (1ull << (bit % 64)))) {
+                result = image_svg_marker_sdf(marker->shape, (f32) x + 0.5f - marker->x, (f32) y + 0.5f - marker->y, r) < outer;
+            }
+        }
+    }
+    
+    if (result) {
+        for (s32 y = y0; y <= y1; ++y) {
+            for (s32 x = x0; x <= x1; ++x) {
+                if (image_svg_marker_sdf(marker->shape, (f32) x + 0.5f - marker->x, (f32) y + 0.5f - marker->y, r) <= inner) {
+                    u64 bit = (u64) y*svg->width + (u64) x;
+                    svg->painted[bit/64] |= 1ull << (bit % 64);
+                }
+            }
+        }
+    }
+    
+    return(result);
+}
+
+// @Note: Marker commands are walked top to bottom before anything is written, to pick what shows,
+// a run of commands with the same state at a time. Markers that look like the topmost one are kept
+// to one per pixel, for scatter plots that's all of them. Opaque markers are dropped when the ones
+// above already cover them. When the whole run looks the same the order doesn't change the picture,
+// so one marker per cell of a coarse grid goes first and covers most of the cloud, after which little
+// more than its outline is left.
+internal void image_svg_markers_pick(Image_Svg *svg, R_List *list, R_Cmd **cmds, u64 **kept, usize count)
+{
+    Arena_Temp temp = arena_temp_begin(svg->arena);
+    R_Cmd *top = cmds[count - 1];
+    
+    u64 bits = (u64) svg->width*svg->height;
+    MemoryZero(svg->taken, ((bits + 63)/64)*sizeof(u64));
+    
+    // @Note: Clipped markers only cover what's inside of the clip.
+    RectF32 bounds = { 0.0f, 0.0f, (f32) svg->width, (f32) svg->height };
+    u64 clip = r_key_clip(top->key);
+    if (clip != 0) {
+        RectF32 rect = list->clips[clip - 1];
+        bounds.x0 = MAX(bounds.x0, floorf(rect.x0));
+        bounds.y0 = MAX(bounds.y0, floorf(rect.y0));
+        bounds.x1 = MIN(bounds.x1, ceilf(rect.x1));
+        bounds.y1 = MIN(bounds.y1, ceilf(rect.y1));
+    }
+    
+    R_Marker *first = (R_Marker *) top->data + top->count - 1;
+    u32 tail_of = 0;
+    MemoryCopy(&tail_of, &first->radius, sizeof(u32));
+    b32 opaque = r_key_blend(top->key) == R_BLEND_ALPHA;
+    
+    b32 uniform = opaque && (svg->palette[first->palette] & 0xFF) == 0xFF;
+    for (usize c = 0; c < count && uniform; ++c) {
+        R_Marker *markers = (R_Marker *) cmds[c]->data;
+        for (usize i = 0; i < cmds[c]->count && uniform; ++i) {
+            uniform = MemoryMatch(&markers[i].radius, &tail_of, sizeof(u32));
+        }
+    }
+    
+    if (uniform) {
+        u32 cell = MAX((u32) r_f32_from_f16(first->radius), 1);
+        u32 cells_x = svg->width/cell + 1;
+        u32 cells_y = svg->height/cell + 1;
+        u64 *cells = arena_push_array(temp.arena, u64, ((u64) cells_x*cells_y + 63)/64);
+        
+        for (usize c = 0; c < count; ++c) {
+            R_Marker *markers = (R_Marker *) cmds[c]->data;
+            for (usize i = 0; i < cmds[c]->count; ++i) {
+                R_Marker *marker = markers + i;
+                if (marker->x < 0.0f || marker->y < 0.0f || marker->x >= (f32) svg->width || marker->y >= (f32) svg->height) {
+                    continue;
+                }
+                
+                u64 at = ((u64) marker->y/cell)*cells_x + (u64) marker->x/cell;
+                if (cells[at/64] & (1ull << (at % 64))) continue;
+                cells[at/64] |= 1ull << (at % 64);
+                
+                u64 bit = (u64) marker->y*svg->width + (u64) marker->x;
+                svg->taken[bit/64] |= 1ull << (bit % 64);
+                if (image_svg_marker_visible(svg, marker, r_f32_from_f16(marker->radius), bounds)) {
+                    kept[c][i/64] |= 1ull << (i % 64);
+                }
+            }
+        }
+    }
+    
+    for (usize c = count; c > 0; --c) {
+        R_Marker *markers = (R_Marker *) cmds[c - 1]->data;
+        u64 *cmd_kept = kept[c - 1];
+        for (usize i = cmds[c - 1]->count; i > 0; --i) {
+            R_Marker *marker = markers + i - 1;
+            f32 r = r_f32_from_f16(marker->radius);
+            svg->stats.markers_in += 1;
+            
+            if (cmd_kept[(i - 1)/64] & (1ull << ((i - 1) % 64))) continue;
+            if (marker->x + r < 0.0f || marker->y + r < 0.0f || marker->x - r > (f32) svg->width || marker->y - r > (f32) svg->height) {
+                continue;
+            }
+            
+            if (MemoryMatch(&marker->radius, &tail_of, sizeof(u32)) &&
+                marker->x >= 0.0f && marker->y >= 0.0f && marker->x < (f32) svg->width && marker->y < (f32) svg->height) {
+                u64 bit = (u64) marker->y*svg->width + (u64) marker->x;
+                if (svg->taken[bit/64] & (1ull << (bit % 64))) continue;
+                svg->taken[bit/64] |= 1ull << (bit % 64);
+            }
+            
+            if (opaque && (svg->palette[marker->palette] & 0xFF) == 0xFF && !image_svg_marker_visible(svg, marker, r, bounds)) {
+                continue;
+            }
+            
+            cmd_kept[(i - 1)/64] |= 1ull << ((i - 1) % 64);
+        }
+    }
+    
+    arena_temp_end(&temp);
+}
+
+internal void image_svg_markers(Image_Svg *svg, R_Cmd *cmd, u64 *kept)
+{
+    char line[IMAGE_SVG_LINE_SIZE];
+    R_Marker *markers = (R_Marker *) cmd->data;
+    
+    b32 open = 0;
+    u32 open_tail = 0;
+    for (usize i = 0; i < cmd->count; ++i) {
+        if (!(kept[i/64] & (1ull << (i % 64)))) continue;
+        
+        R_Marker *marker = markers + i;
+        f32 r = r_f32_from_f16(marker->radius);
+        u32 tail = 0;
+        MemoryCopy(&tail, &marker->radius, sizeof(u32));
+        
+        // @Note: Color is per group, the shapes only carry geometry.
+        s32 size = 0;
+        if (!open || tail != open_tail) {
+            if (open) {
+                size += snprintf(line + size, sizeof(line) - size, "</g>\n");
+            }
+            size += snprintf(line + size, sizeof(line) - size, "<g");
+            size += image_svg_paint(line + size, sizeof(line) - size, "fill", svg->palette[marker->palette]);
+            size += snprintf(line + size, sizeof(line) - size, ">\n");
+            open = 1;
+            open_tail = tail;
+        }
+        
+        switch (marker->shape) {
+            case R_MARKER_SQUARE: {
+                size += snprintf(line + size, sizeof(line) - size, "<rect x=\"%.1f\" y=\"%.1f\" width=\"%.1f\" height=\"%.1f\"/>\n",
+                                 marker->x - r, marker->y - r, 2.0f*r, 2.0f*r);
+            } break;
+            
+            case R_MARKER_DIAMOND: {
+                size += snprintf(line + size, sizeof(line) - size, "<path d=\"M%.1f %.1fl%.1f %.1f %.1f %.1f %.1f %.1fz\"/>\n",
+                                 marker->x - r, marker->y, r, -r, r, r, -r, r);
+            } break;
+            
+            default: {
+                size += snprintf(line + size, sizeof(line) - size, "<circle cx=\"%.1f\" cy=\"%.1f\" r=\"%.1f\"/>\n",
+                                 marker->x, marker->y, r);
+            } break;
+        }
+        
+        image_svg_print(svg, line, size);
+        svg->stats.markers_out += 1;
+    }
+    
+    if (open) {
+        image_svg_print(svg, line, snprintf(line, sizeof(line), "</g>\n"));
+    }
+}
+
+internal void image_svg_vertex(Image_Svg *svg, char op, R_Line_Vertex *vertex)
+{
+    char line[64];
+    image_svg_print(svg, line, snprintf(line, sizeof(line), "%c%.1f %.1f", op, vertex->x, vertex->y));
+    svg->stats.vertices_out += 1;
+}
+
+// @Note: One pixel column worth of a polyline, everything in it collapses to these four.
+typedef struct {
+    s64 column;
+    usize count;
+    R_Line_Vertex first;
+    R_Line_Vertex low;
+    R_Line_Vertex high;
+    R_Line_Vertex last;
+    usize low_at;
+    usize high_at;
+    usize last_at;
+} Image_Svg_Column;
+
+internal void image_svg_column_flush(Image_Svg *svg, Image_Svg_Column *column, b32 *started)
+{
+    if (column->count > 0) {
+        image_svg_vertex(svg, *started ? 'L' : 'M', &column->first);
+        *started = 1;
+        
+        // @Note: Low and high in the order they came in, each only if it's not the first or last already.
+        b32 low_first = column->low_at <= column->high_at;
+        usize at[2] = { low_first ? column->low_at : column->high_at, low_first ? column->high_at : column->low_at };
+        R_Line_Vertex *vertex[2] = { low_first ? &column->low : &column->high, low_first ? &column->high : &column->low };
+        for (u32 i = 0; i < 2; ++i) {
+            if (at[i] != 0 && at[i] != column->last_at && (i == 0 || at[i] != at[0])) {
+                image_svg_vertex(svg, 'L', vertex[i]);
+            }
+        }
+        
+        if (column->last_at != 0) {
+            image_svg_vertex(svg, 'L', &column->last);
+        }
+    }
+    
+    column->count = 0;
+}
+
+internal void image_svg_lines(Image_Svg *svg, R_List *list, R_Cmd *cmd)
+{
+    char line[IMAGE_SVG_LINE_SIZE];
+    R_Line_Style style = list->line_styles[r_key_param(cmd->key)];
+    if ((style.col & 0xFF) == 0 || style.width <= 0.0f) return;
+    
+    s32 size = snprintf(line, sizeof(line), "<path fill=\"none\"");
+    size += image_svg_paint(line + size, sizeof(line) - size, "stroke", style.col);
+    size += snprintf(line + size, sizeof(line) - size, " stroke-width=\"%.2f\" stroke-linejoin=\"%s\" stroke-linecap=\"%s\"",
+                     style.width, style.join == R_JOIN_ROUND ? "round" : "miter", style.join == R_JOIN_ROUND ? "round" : "butt");
+    if (style.dash > 0.0f && style.gap > 0.0f) {
+        size += snprintf(line + size, sizeof(line) - size, " stroke-dasharray=\"%.2f %.2f\"", style.dash, style.gap);
+    }
+    size += snprintf(line + size, sizeof(line) - size, " d=\"");
+    image_svg_print(svg, line, size);
+    
+    // @Note: Everything left or right of the picture shares one column on each side, so only
+    // the segments that cross into it are kept from there.
+    R_Line_Vertex *vertices = (R_Line_Vertex *) cmd->data;
+    Image_Svg_Column column = {0};
+    b32 started = 0;
+    for (usize i = 0; i < cmd->count; ++i) {
+        R_Line_Vertex *vertex = vertices + i;
+        if (vertex->dist < 0.0f) {
+            image_svg_column_flush(svg, &column, &started);
+            started = 0;
+            continue;
+        }
+        
+        svg->stats.vertices_in += 1;
+        s64 x = (s64) HMM_Clamp(-1.0f, floorf(vertex->x), (f32) svg->width);
+        if (column.count > 0 && x != column.column) {
+            image_svg_column_flush(svg, &column, &started);
+        }
+        
+        if (column.count == 0) {
+            column.column = x;
+            column.first = *vertex;
+            column.low = *vertex;
+            column.high = *vertex;
+            column.low_at = 0;
+            column.high_at = 0;
+            column.last_at = 0;
+        } else {
+            if (vertex->y < column.low.y) {
+                column.low = *vertex;
+                column.low_at = column.count;
+            }
+            if (vertex->y > column.high.y) {
+                column.high = *vertex;
+                column.high_at = column.count;
+            }
+            column.last = *vertex;
+            column.last_at = column.count;
+        }
+        
+        column.count += 1;
+    }
+    image_svg_column_flush(svg, &column, &started);
+    
+    image_svg_print(svg, line, snprintf(line, sizeof(line), "\"/>\n"));
+}
+
+internal b32 image_svg_write(Image_Svg *svg, R_List *list, String8 path)
+{
+    OPTICK_EVENT();
+    
+    char line[IMAGE_SVG_LINE_SIZE];
+    Arena_Temp temp = arena_temp_begin(svg->arena);
+    b32 error = !image_file_open(&svg->file, temp.arena, path);
+    
+    if (!error) {
+        image_svg_print(svg, line, snprintf(line, sizeof(line),
+                                            "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                                            "<svg xmlns=\"http://www.w3.org/2000/svg\" xmlns:xlink=\"http://www.w3.org/1999/xlink\""
+                                            " width=\"%u\" height=\"%u\" viewBox=\"0 0 %u %u\">\n",
+                                            svg->width, svg->height, svg->width, svg->height));
+        
+        if ((svg->background & 0xFF) != 0) {
+            s32 size = snprintf(line, sizeof(line), "<rect width=\"100%%\" height=\"100%%\"");
+            size += image_svg_paint(line + size, sizeof(line) - size, "fill", svg->background);
+            size += snprintf(line + size, sizeof(line) - size, "/>\n");
+            image_svg_print(svg, line, size);
+        }
+        
+        if (list->clip_count > 0) {
+            image_svg_print(svg, line, snprintf(line, sizeof(line), "<defs>\n"));
+            for (u32 i = 0; i < list->clip_count; ++i) {
+                RectF32 clip = list->clips[i];
+                image_svg_print(svg, line, snprintf(line, sizeof(line),
+                                                    "<clipPath id=\"c%u\"><rect x=\"%.2f\" y=\"%.2f\" width=\"%.2f\" height=\"%.2f\"/></clipPath>\n",
+                                                    i + 1, clip.x0, clip.y0, clip.x1 - clip.x0, clip.y1 - clip.y0));
+            }
+            image_svg_print(svg, line, snprintf(line, sizeof(line), "</defs>\n"));
+        }
+        
+        svg->taken = arena_push_array(temp.arena, u64, ((u64) svg->width*svg->height + 63)/64);
+        svg->painted = arena_push_array(temp.arena, u64, ((u64) svg->width*svg->height + 63)/64);
+        
+        R_Cmd **cmds = arena_push_array(temp.arena, R_Cmd *, list->count);
+        usize cmd_count = 0;
+        for (R_Cmd *cmd = list->first; cmd != 0; cmd = cmd->next) {
+            if (cmd->count > 0) {
+                cmds[cmd_count++] = cmd;
+            }
+        }
+        
+        R_Cmd **sorted = r_sort_cmds(temp.arena, cmds, cmd_count);
+        
+        u64 **kept = arena_push_array(temp.arena, u64 *, cmd_count);
+        usize at = cmd_count;
+        while (at > 0) {
+            if (r_key_kind(sorted[at - 1]->key) != R_CMD_MARKERS) {
+                at -= 1;
+                continue;
+            }
+            
+            usize end = at;
+            u64 run_state = r_key_state(sorted[at - 1]->key);
+            while (at > 0 && r_key_kind(sorted[at - 1]->key) == R_CMD_MARKERS && r_key_state(sorted[at - 1]->key) == run_state) {
+                kept[at - 1] = arena_push_array(temp.arena, u64, (sorted[at - 1]->count + 63)/64);
+                at -= 1;
+            }
+            
+            image_svg_markers_pick(svg, list, sorted + at, kept + at, end - at);
+        }
+        
+        // @Note: Same order the renderer draws in. Clip and blend are groups around runs of commands.
+        u64 group = 0;
+        for (usize i = 0; i < cmd_count; ++i) {
+            R_Cmd *cmd = sorted[i];
+            u64 clip = r_key_clip(cmd->key);
+            u64 blend = r_key_blend(cmd->key);
+            u64 cmd_group = clip | (blend << 16);
+            
+            if (cmd_group != group) {
+                s32 size = 0;
+                if (group != 0) {
+                    size += snprintf(line + size, sizeof(line) - size, "</g>\n");
+                }
+                if (cmd_group != 0) {
+                    size += snprintf(line + size, sizeof(line) - size, "<g");
+                    if (clip != 0) {
+                        size += snprintf(line + size, sizeof(line) - size, " clip-path=\"url(#c%u)\"", (u32) clip);
+                    }
+                    if (blend == R_BLEND_ADDITIVE) {
+                        size += snprintf(line + size, sizeof(line) - size, " style=\"mix-blend-mode:plus-lighter\"");
+                    }
+                    size += snprintf(line + size, sizeof(line) - size, ">\n");
+                }
+                image_svg_print(svg, line, size);
+                group = cmd_group;
+            }
+            
+            switch (r_key_kind(cmd->key)) {
+                case R_CMD_QUADS: image_svg_quads(svg, list, cmd); break;
+                case R_CMD_MARKERS: image_svg_markers(svg, cmd, kept[i]); break;
+                case R_CMD_LINES: image_svg_lines(svg, list, cmd); break;
+            }
+        }
+        
+        if (group != 0) {
+            image_svg_print(svg, line, snprintf(line, sizeof(line), "</g>\n"));
+        }
+        image_svg_print(svg, line, snprintf(line, sizeof(line), "</svg>\n"));
+    }
+    
+    error = !image_file_close(&svg->file) || error;
+    if (error) {
+        er_push(str8("failed to write the svg file"));
+    }
+    
+    svg->taken = 0;
+    svg->painted = 0;
+    arena_temp_end(&temp);
+    
+    b32 result = !error;
+    return(result);
+}
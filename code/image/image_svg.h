@@ -0,0 +1,64 @@
+#ifndef IMAGE_SVG_H
+#define IMAGE_SVG_H
+
+// @Note: Vector pictures from a draw list, the same one r_flush_batches() would submit. Solid quads
+// become rects, textured ones the outline of whatever sits there in the atlas (glyphs), markers and
+// lines become shapes and paths. Everything goes out through an Image_File, nothing is held.
+//
+// Lists of big data sets are thinned down to what can show up at the picture's size: markers that land
+// on a pixel already taken by one of the same style or that sit under opaque ones are dropped, and lines
+// keep the first, lowest, highest and last vertex of every pixel column they cross. The file is sized by
+// the picture, not the data.
+#define IMAGE_SVG_SHAPE_BUCKET_COUNT 256
+#define IMAGE_SVG_LINE_SIZE 512
+
+// @Note: Outline for the quad that samples 'uv' out of 'texture', as SVG path data in the space of a
+// quad 'size' big. Returns an empty string for things without one, those quads are left out.
+typedef String8 Image_Svg_Shape_Func(void *user, Arena *arena, R_Texture2D *texture, RectF32 uv, HMM_Vec2 *size);
+
+typedef struct Image_Svg_Shape {
+    struct Image_Svg_Shape *next;
+    R_Texture2D *texture;
+    RectF32 uv;
+    
+    String8 path;
+    HMM_Vec2 size;
+    u32 id;
+    b32 written; // @Note: Its <defs> entry goes out right before the first use
+} Image_Svg_Shape;
+
+typedef struct {
+    u64 quads;
+    u64 markers_in;
+    u64 markers_out;
+    u64 vertices_in;
+    u64 vertices_out;
+    u64 skipped; // @Note: Textured quads without an outline
+} Image_Svg_Stats;
+
+typedef struct {
+    Arena *arena;
+    u32 width;
+    u32 height;
+    u32 background;
+    
+    R_Solid solid;
+    u32 palette[R_MARKER_PALETTE_SIZE];
+    
+    Image_Svg_Shape *shapes[IMAGE_SVG_SHAPE_BUCKET_COUNT];
+    u32 shape_count;
+    
+    Image_File file;
+    u64 *taken;   // @Note: One bit per pixel, markers like the topmost one of the current run
+    u64 *painted; // @Note: One bit per pixel, covered by opaque markers
+    Image_Svg_Stats stats;
+} Image_Svg;
+
+// @Note: Init and resolve touch the solid rect, marker palette and whatever 'func' reads (the font),
+// so they belong on the thread that draws. Writing only reads the list and what was resolved, it can
+// go anywhere as long as nobody else uses the list or the arena meanwhile.
+internal void image_svg_init(Image_Svg *svg, Arena *arena, u32 width, u32 height, u32 background, u32 *palette, u32 palette_count);
+internal void image_svg_resolve(Image_Svg *svg, R_List *list, Image_Svg_Shape_Func *func, void *user);
+internal b32 image_svg_write(Image_Svg *svg, R_List *list, String8 path);
+
+#endif // IMAGE_SVG_H
@@ -0,0 +1,80 @@
+internal usize image_y4m_frame_size(u32 width, u32 height)
+{
+    usize chroma = (usize) ((width + 1)/2)*((height + 1)/2);
+    usize result = (usize) width*height + 2*chroma;
+    return(result);
+}
+
+internal void image_y4m_convert(u8 *out, u8 *pixels, u32 width, u32 height, u32 pitch)
+{
+    OPTICK_EVENT();
+    
+    // @Note: BT.601 studio range in 16.16 fixed point, luma 16 to 235 and chroma 16 to 240. The chroma rows
+    // sum up to four pixels, repeating the last row and column when the size is odd, so they're scaled by 4.
+    u32 chroma_width = (width + 1)/2;
+    u32 chroma_height = (height + 1)/2;
+    u8 *luma = out;
+    u8 *cb = luma + (usize) width*height;
+    u8 *cr = cb + (usize) chroma_width*chroma_height;
+    
+    for (u32 y = 0; y < height; ++y) {
+        u8 *row = pixels + (usize) y*pitch;
+        u8 *dst = luma + (usize) y*width;
+        for (u32 x = 0; x < width; ++x) {
+            s32 r = row[x*4 + 0];
+            s32 g = row[x*4 + 1];
+            s32 b = row[x*4 + 2];
+            dst[x] = (u8) (((16 << 16) + 0x8000 + 16829*r + 33039*g + 6416*b) >> 16);
+        }
+    }
+    
+    for (u32 y = 0; y < chroma_height; ++y) {
+        u8 *top = pixels + (usize) (2*y)*pitch;
+        u8 *bottom = pixels + (usize) MIN(2*y + 1, height - 1)*pitch;
+        u8 *dst_cb = cb + (usize) y*chroma_width;
+        u8 *dst_cr = cr + (usize) y*chroma_width;
+        for (u32 x = 0; x < chroma_width; ++x) {
+            u32 left = 2*x*4;
+            u32 right = MIN(2*x + 1, width - 1)*4;
+            s32 r = top[left + 0] + top[right + 0] + bottom[left + 0] + bottom[right + 0];
+            s32 g = top[left + 1] + top[right + 1] + bottom[left + 1] + bottom[right + 1];
+            s32 b = top[left + 2] + top[right + 2] + bottom[left + 2] + bottom[right + 2];
+            dst_cb[x] = (u8) (((128 << 18) + (1 << 17) - 9714*r - 19070*g + 28784*b) >> 18);
+            dst_cr[x] = (u8) (((128 << 18) + (1 << 17) + 28784*r - 24103*g - 4681*b) >> 18);
+        }
+    }
+}
+
+internal b32 image_y4m_begin(Image_Y4m *y4m, Arena *arena, String8 path, u32 width, u32 height, u32 fps)
+{
+    y4m->width = width;
+    y4m->height = height;
+    y4m->frames = 0;
+    
+    b32 error = !image_file_open(&y4m->file, arena, path);
+    if (error) {
+        er_push(str8("Failed to open y4m file"));
+    }
+    
+    if (!error) {
+        char header[128];
+        s32 size = snprintf(header, sizeof(header), "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C420jpeg\n", width, height, MAX(fps, 1));
+        image_file_write(&y4m->file, header, (usize) size);
+    }
+    
+    b32 result = !error;
+    return(result);
+}
+
+internal void image_y4m_frame(Image_Y4m *y4m, u8 *frame)
+{
+    image_file_write(&y4m->file, (void *) "FRAME\n", 6);
+    image_file_write(&y4m->file, frame, image_y4m_frame_size(y4m->width, y4m->height));
+    y4m->frames += 1;
+}
+
+internal b32 image_y4m_end(Image_Y4m *y4m)
+{
+    b32 result = image_file_close(&y4m->file);
+    return(result);
+}
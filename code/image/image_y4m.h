@@ -0,0 +1,23 @@
+#ifndef IMAGE_Y4M_H
+#define IMAGE_Y4M_H
+
+// @Note: YUV4MPEG2, an uncompressed stream of frames that ffmpeg and most players read as it is. Frames
+// are 4:2:0 in BT.601 studio range with centered chroma (C420jpeg), odd sizes round the chroma planes up.
+// Conversion doesn't touch the stream, so frames can be converted on any thread and written in order.
+#define IMAGE_Y4M_DEFAULT_FPS 30
+
+typedef struct {
+    Image_File file;
+    u32 width;
+    u32 height;
+    u32 frames; // @Note: Written so far
+} Image_Y4m;
+
+internal usize image_y4m_frame_size(u32 width, u32 height);
+internal void image_y4m_convert(u8 *out, u8 *pixels, u32 width, u32 height, u32 pitch);
+
+internal b32 image_y4m_begin(Image_Y4m *y4m, Arena *arena, String8 path, u32 width, u32 height, u32 fps);
+internal void image_y4m_frame(Image_Y4m *y4m, u8 *frame); // @Note: 'frame' from image_y4m_convert()
+internal b32 image_y4m_end(Image_Y4m *y4m);
+
+#endif // IMAGE_Y4M_H
@@ -1,6 +1,26 @@
 #ifndef OS_H
 #define OS_H
 
+// @Note: Read-only view of a whole file, 'data' stays valid until os_file_unmap().
+typedef struct {
+    String8 data;
+    void *file;
+    void *mapping;
+} OS_File_Map;
+
+typedef void OS_Thread_Func(void *data);
+
+// @Note: Owned by the caller and has to stay where it is until os_thread_join().
+typedef struct {
+    OS_Thread_Func *func;
+    void *data;
+    void *handle;
+} OS_Thread;
+
+typedef struct {
+    void *handle;
+} OS_Semaphore;
+
 internal b32 os_main_is_init(void);
 internal b32 os_main_init(void);
 internal void os_wait(f64 ms);
@@ -13,6 +33,21 @@ internal void os_memory_decommit(void *ptr, usize size);
 internal usize os_get_page_size(void);
 
 internal String8 os_file_read(Arena *arena, String8 file);
+internal b32 os_file_write(String8 file, String8 data);
+internal b32 os_file_append(String8 file, String8 data);
+internal b32 os_file_delete(String8 file);
+internal OS_File_Map os_file_map(String8 file);
+internal void os_file_unmap(OS_File_Map *map);
+
+internal b32 os_thread_start(OS_Thread *thread, OS_Thread_Func *func, void *data);
+internal void os_thread_join(OS_Thread *thread);
+internal u32 os_cpu_count(void);
+internal b32 os_cpu_has_avx2(void);
+
+internal OS_Semaphore os_semaphore_create(u32 initial);
+internal void os_semaphore_destroy(OS_Semaphore semaphore);
+internal void os_semaphore_signal(OS_Semaphore semaphore);
+internal void os_semaphore_wait(OS_Semaphore semaphore);
 
 internal void os_exit_process(u32 code);
 
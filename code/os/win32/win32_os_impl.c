@@ -151,6 +151,195 @@ internal String8 os_file_read(Arena *arena, String8 file)
     return(result);
 }
 
+internal b32 win32_file_write_all(HANDLE file_handle, String8 data)
+{
+    // @Note: Same as reading, WriteFile takes at most 32 bits worth of bytes at a time
+    b32 result = 1;
+    u8 *start = data.data;
+    u8 *end = data.data + data.size;
+    while (start < end) {
+        u64 total_to_write = (u64) (end - start);
+        DWORD left_to_write = (DWORD) total_to_write;
+        if (total_to_write > 0xFFFFFFFF) {
+            left_to_write = 0xFFFFFFFF;
+        }
+        
+        DWORD actual_written = 0;
+        if (!WriteFile(file_handle, start, left_to_write, &actual_written, 0)) {
+            result = 0;
+            break;
+        }
+        
+        start += actual_written;
+    }
+    
+    return(result);
+}
+
+internal b32 os_file_write(String8 file, String8 data)
+{
+    b32 result = 0;
+    HANDLE file_handle = CreateFile((LPCSTR) file.data,
+                                    GENERIC_WRITE, 0, 0,
+                                    CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, 0);
+    
+    if (file_handle != INVALID_HANDLE_VALUE) {
+        result = win32_file_write_all(file_handle, data);
+        CloseHandle(file_handle);
+    }
+    
+    return(result);
+}
+
+internal b32 os_file_append(String8 file, String8 data)
+{
+    b32 result = 0;
+    HANDLE file_handle = CreateFile((LPCSTR) file.data,
+                                    FILE_APPEND_DATA, 0, 0,
+                                    OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, 0);
+    
+    if (file_handle != INVALID_HANDLE_VALUE) {
+        result = win32_file_write_all(file_handle, data);
+        CloseHandle(file_handle);
+    }
+    
+    return(result);
+}
+
+internal b32 os_file_delete(String8 file)
+{
+    b32 result = DeleteFile((LPCSTR) file.data) != 0;
+    return(result);
+}
+
+internal OS_File_Map os_file_map(String8 file)
+{
+    OS_File_Map result = {0};
+    HANDLE file_handle = CreateFile((LPCSTR) file.data,
+                                    GENERIC_READ, FILE_SHARE_READ, 0,
+                                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    
+    if (file_handle != INVALID_HANDLE_VALUE) {
+        LARGE_INTEGER win32_size = {0};
+        GetFileSizeEx(file_handle, &win32_size);
+        
+        // @Note: Empty files can't be mapped, those are just treated as missing
+        HANDLE mapping = 0;
+        if (win32_size.QuadPart > 0) {
+            mapping = CreateFileMapping(file_handle, 0, PAGE_READONLY, 0, 0, 0);
+        }
+        
+        void *view = 0;
+        if (mapping) {
+            view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        }
+        
+        if (view) {
+            result.data.data = (u8 *) view;
+            result.data.size = (usize) win32_size.QuadPart;
+            result.file = file_handle;
+            result.mapping = mapping;
+        } else {
+            if (mapping) CloseHandle(mapping);
+            CloseHandle(file_handle);
+        }
+    }
+    
+    return(result);
+}
+
+internal void os_file_unmap(OS_File_Map *map)
+{
+    if (map->data.data) {
+        UnmapViewOfFile(map->data.data);
+        CloseHandle((HANDLE) map->mapping);
+        CloseHandle((HANDLE) map->file);
+    }
+    
+    MemoryZero(map, sizeof(OS_File_Map));
+}
+
+internal DWORD WINAPI win32_thread_proc(LPVOID param)
+{
+    OS_Thread *thread = (OS_Thread *) param;
+    thread->func(thread->data);
+    return(0);
+}
+
+internal b32 os_thread_start(OS_Thread *thread, OS_Thread_Func *func, void *data)
+{
+    thread->func = func;
+    thread->data = data;
+    thread->handle = CreateThread(0, 0, win32_thread_proc, thread, 0, 0);
+    
+    b32 result = thread->handle != 0;
+    return(result);
+}
+
+internal void os_thread_join(OS_Thread *thread)
+{
+    if (thread->handle) {
+        WaitForSingleObject((HANDLE) thread->handle, INFINITE);
+        CloseHandle((HANDLE) thread->handle);
+    }
+    
+    MemoryZero(thread, sizeof(OS_Thread));
+}
+
+internal u32 os_cpu_count(void)
+{
+    SYSTEM_INFO info = {0};
+    GetSystemInfo(&info);
+    
+    u32 result = MAX((u32) info.dwNumberOfProcessors, 1);
+    return(result);
+}
+
+internal b32 os_cpu_has_avx2(void)
+{
+    // @Note: The CPU has to have it and the OS has to save the YMM registers on switches.
+    int info[4] = {0};
+    __cpuid(info, 0);
+    s32 max_leaf = info[0];
+    
+    b32 result = 0;
+    if (max_leaf >= 7) {
+        __cpuid(info, 1);
+        b32 osxsave = (info[2] & (1 << 27)) != 0;
+        b32 avx = (info[2] & (1 << 28)) != 0;
+        if (osxsave && avx && (_xgetbv(0) & 0x6) == 0x6) {
+            __cpuidex(info, 7, 0);
+            result = (info[1] & (1 << 5)) != 0;
+        }
+    }
+    
+    return(result);
+}
+
+internal OS_Semaphore os_semaphore_create(u32 initial)
+{
+    OS_Semaphore result = {0};
+    result.handle = CreateSemaphoreA(0, (LONG) initial, LONG_MAX, 0);
+    return(result);
+}
+
+internal void os_semaphore_destroy(OS_Semaphore semaphore)
+{
+    if (semaphore.handle) {
+        CloseHandle((HANDLE) semaphore.handle);
+    }
+}
+
+internal void os_semaphore_signal(OS_Semaphore semaphore)
+{
+    ReleaseSemaphore((HANDLE) semaphore.handle, 1, 0);
+}
+
+internal void os_semaphore_wait(OS_Semaphore semaphore)
+{
+    WaitForSingleObject((HANDLE) semaphore.handle, INFINITE);
+}
+
 internal void os_exit_process(u32 code)
 {
     ExitProcess(code);
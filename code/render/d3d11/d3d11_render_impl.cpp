@@ -7,6 +7,19 @@ global b32 d3d11_is_init = 0;
 
 #define d3d11_window_from_opaque(w) (d3d11_windows + (u64)(w))
 
+internal void d3d11_color_from_u32(u32 color, FLOAT *out)
+{
+    u8 a = (color >> 8*0) & 0xFF;
+    u8 b = (color >> 8*1) & 0xFF;
+    u8 g = (color >> 8*2) & 0xFF;
+    u8 r = (color >> 8*3) & 0xFF;
+    
+    out[0] = r/255.0f;
+    out[1] = g/255.0f;
+    out[2] = b/255.0f;
+    out[3] = a/255.0f;
+}
+
 // @ToDo: Clean-up all this mess in the shader.
 global u8 hlsl[] =
 "struct VS_INPUT {\n"
@@ -66,14 +79,324 @@ global u8 hlsl[] =
 "    // @Note: we flip because we submit the colours in rgba format\n"
 "    float4 pixel_color = float4(tex.Sample(tex_sampler, input.uv) * input.col).abgr;\n"
 "    return(float4(pixel_color.rgb, s * pixel_color.a));\n"
+"}\n"
+"\n"
+"// @Note: Texture holds a distance field in red, 0.5 on the edge and growing inwards.\n"
+"// Edge gets one screen pixel of smoothing at whatever scale the quad is drawn at.\n"
+"float4 main_ps_sdf(PS_INPUT input) : SV_TARGET {\n"
+"    float2 coord = input.quad_pos - input.quad_center;\n"
+"    float s = 1.0f - smoothstep(0.0f, 1.75f, sdf_rect(coord, input.quad_half - input.radius, input.radius));\n"
+"    float dist = tex.Sample(tex_sampler, input.uv).r - 0.5f;\n"
+"    float coverage = saturate(dist/max(fwidth(dist), 0.0001f) + 0.5f);\n"
+"    float4 col = input.col.abgr;\n"
+"    return(float4(col.rgb, s * coverage * col.a));\n"
+"}\n";
+
+global u8 hlsl_marker[] =
+"struct VS_INPUT {\n"
+"    float2 pos     : POS;\n"
+"    float2 center  : CENTER;\n"
+"    float radius   : RADIUS;\n"
+"    uint shape     : SHAPE;\n"
+"    uint palette   : PALETTE;\n"
+"};\n"
+"\n"
+"struct PS_INPUT {\n"
+"    float4 pos                : SV_POSITION;\n"
+"    float4 col                : COL;\n"
+"    float2 local              : LOCAL;\n"
+"    float radius              : RADIUS;\n"
+"    nointerpolation uint shape : SHAPE;\n"
+"};\n"
+"\n"
+"cbuffer VS_CBUFFER : register(b0) {\n"
+"    float2 resolution;\n"
+"};\n"
+"\n"
+"cbuffer PALETTE_CBUFFER : register(b1) {\n"
+"    float4 palette[256];\n"
+"};\n"
+"\n"
+"PS_INPUT main_vs(VS_INPUT input) {\n"
+"    PS_INPUT output;\n"
+"    // @Note: Same padding as the quads get, room for the smoothstep outside the shape.\n"
+"    output.local = input.pos*(2.0f*input.radius);\n"
+"    output.col = palette[input.palette];\n"
+"    output.radius = input.radius;\n"
+"    output.shape = input.shape;\n"
+"    float2 screen_pos = ((input.center + output.local)/resolution)*2.0f - 1.0f;\n"
+"    output.pos = float4(screen_pos.x, -screen_pos.y, 0.0f, 1.0f);\n"
+"    return(output);\n"
+"}\n"
+"\n"
+"float4 main_ps(PS_INPUT input) : SV_TARGET {\n"
+"    float2 p = input.local;\n"
+"    float sdf = length(p) - input.radius;\n"
+"    if (input.shape == 1u) {\n"
+"        float2 d = abs(p) - input.radius;\n"
+"        sdf = length(max(d, 0.0f)) + min(max(d.x, d.y), 0.0f);\n"
+"    } else if (input.shape == 2u) {\n"
+"        sdf = (abs(p.x) + abs(p.y) - input.radius)*0.70710678f;\n"
+"    }\n"
+"    float s = 1.0f - smoothstep(0.0f, 1.75f, sdf);\n"
+"    return(float4(input.col.rgb, s * input.col.a));\n"
 "}\n";
 
+// @Note: One instance per segment, vertices come from a structured buffer so every
+// segment can look at its neighbours for the joins. Template x picks the end, y the side.
+global u8 hlsl_line[] =
+"struct Line_Vertex {\n"
+"    float2 pos;\n"
+"    float dist;\n"
+"};\n"
+"\n"
+"struct VS_INPUT {\n"
+"    float2 pos : POS;\n"
+"    uint id    : SV_InstanceID;\n"
+"};\n"
+"\n"
+"struct PS_INPUT {\n"
+"    float4 pos                     : SV_POSITION;\n"
+"    float2 p                       : LINE_POS;\n"
+"    nointerpolation float4 segment : SEGMENT;\n"
+"    nointerpolation float4 ends    : ENDS;\n"
+"    nointerpolation float3 extra   : EXTRA;\n"
+"};\n"
+"\n"
+"cbuffer VS_CBUFFER : register(b0) {\n"
+"    float2 resolution;\n"
+"};\n"
+"\n"
+"cbuffer LINE_CBUFFER : register(b1) {\n"
+"    float4 line_col;\n"
+"    float half_width;\n"
+"    float dash;\n"
+"    float gap;\n"
+"    uint join;\n"
+"};\n"
+"\n"
+"StructuredBuffer<Line_Vertex> vertices : register(t0);\n"
+"\n"
+"float2 join_tangent(float2 d0, float2 d1) {\n"
+"    float2 t = d0 + d1;\n"
+"    return((dot(t, t) > 1e-6f) ? normalize(t) : d1);\n"
+"}\n"
+"\n"
+"PS_INPUT main_vs(VS_INPUT input) {\n"
+"    PS_INPUT output = (PS_INPUT) 0;\n"
+"    Line_Vertex v0 = vertices[max(input.id, 1u) - 1u];\n"
+"    Line_Vertex v1 = vertices[input.id];\n"
+"    Line_Vertex v2 = vertices[input.id + 1u];\n"
+"    Line_Vertex v3 = vertices[input.id + 2u];\n"
+"    float2 a = v1.pos;\n"
+"    float2 b = v2.pos;\n"
+"    float len = length(b - a);\n"
+"    // @Note: Segments touching a terminator collapse to nothing.\n"
+"    if (v1.dist < 0.0f || v2.dist < 0.0f || len <= 0.0f) {\n"
+"        return(output);\n"
+"    }\n"
+"    float2 d = (b - a)/len;\n"
+"    float2 n = float2(-d.y, d.x);\n"
+"    bool has_prev = input.id > 0u && v0.dist >= 0.0f && any(v0.pos != a);\n"
+"    bool has_next = v3.dist >= 0.0f && any(v3.pos != b);\n"
+"    float2 ta = has_prev ? join_tangent(normalize(a - v0.pos), d) : d;\n"
+"    float2 tb = has_next ? join_tangent(d, normalize(v3.pos - b)) : d;\n"
+"    bool at_a = input.pos.x < 0.0f;\n"
+"    bool has_join = at_a ? has_prev : has_next;\n"
+"    float2 c = at_a ? a : b;\n"
+"    float2 t = at_a ? ta : tb;\n"
+"    float ext = at_a ? -1.0f : 1.0f;\n"
+"    // @Note: Padding for the smoothstep, same as the quads.\n"
+"    float w = half_width + 2.0f;\n"
+"    float2 offset;\n"
+"    if (join == 0u && has_join) {\n"
+"        float2 m = float2(-t.y, t.x);\n"
+"        offset = m*input.pos.y*(w/max(dot(m, n), 0.25f));\n"
+"    } else if (join == 0u) {\n"
+"        offset = n*input.pos.y*w + d*ext*2.0f;\n"
+"    } else {\n"
+"        offset = n*input.pos.y*w + d*ext*w;\n"
+"    }\n"
+"    output.p = c + offset;\n"
+"    output.segment = float4(a, b);\n"
+"    output.ends = float4(ta, tb);\n"
+"    output.extra = float3(v1.dist, has_prev ? 0.0f : 1.0f, has_next ? 0.0f : 1.0f);\n"
+"    float2 screen_pos = (output.p/resolution)*2.0f - 1.0f;\n"
+"    output.pos = float4(screen_pos.x, -screen_pos.y, 0.0f, 1.0f);\n"
+"    return(output);\n"
+"}\n"
+"\n"
+"float4 main_ps(PS_INPUT input) : SV_TARGET {\n"
+"    float2 a = input.segment.xy;\n"
+"    float2 b = input.segment.zw;\n"
+"    float len = length(b - a);\n"
+"    float2 d = (b - a)/len;\n"
+"    float2 q = input.p - a;\n"
+"    float along = dot(q, d);\n"
+"    float sdf = 0.0f;\n"
+"    if (join == 1u) {\n"
+"        float h = clamp(along/len, 0.0f, 1.0f);\n"
+"        sdf = length(q - d*(h*len)) - half_width;\n"
+"    } else {\n"
+"        sdf = abs(dot(q, float2(-d.y, d.x))) - half_width;\n"
+"        // @Note: Joins are cut on the bisector so neighbours don't overlap, open ends get\n"
+"        // a butt cap with the same smooth edge as the sides.\n"
+"        float end_a = -dot(input.p - a, input.ends.xy);\n"
+"        float end_b = dot(input.p - b, input.ends.zw);\n"
+"        if (input.extra.y > 0.5f) sdf = max(sdf, end_a); else clip(-end_a);\n"
+"        if (input.extra.z > 0.5f) sdf = max(sdf, end_b); else clip(-end_b);\n"
+"    }\n"
+"    if (dash > 0.0f && gap > 0.0f) {\n"
+"        float period = dash + gap;\n"
+"        float s = input.extra.x + along;\n"
+"        float phase = s - period*floor(s/period);\n"
+"        float dash_sdf = (phase < dash) ? -min(phase, dash - phase) : min(phase - dash, period - phase);\n"
+"        sdf = max(sdf, dash_sdf);\n"
+"    }\n"
+"    float s = 1.0f - smoothstep(0.0f, 1.75f, sdf);\n"
+"    return(float4(line_col.rgb, s * line_col.a));\n"
+"}\n";
+
+internal b32 d3d11_compile_shaders(u8 *source, usize size, ID3DBlob **vshader, ID3DBlob **pshader)
+{
+    UINT flags = D3DCOMPILE_PACK_MATRIX_COLUMN_MAJOR | D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_WARNINGS_ARE_ERRORS;
+#ifndef NDEBUG
+    flags |= D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#else
+    flags |= D3DCOMPILE_OPTIMIZATION_LEVEL3;
+#endif
+    ID3DBlob *d3d11_verror = 0;
+    ID3DBlob *d3d11_perror = 0;
+    HRESULT v_res = D3DCompile(source, size, 0, 0, 0, "main_vs", "vs_5_0", flags, 0, vshader, &d3d11_verror);
+    HRESULT p_res = D3DCompile(source, size, 0, 0, 0, "main_ps", "ps_5_0", flags, 0, pshader, &d3d11_perror);
+    
+    b32 error = 0;
+    if (v_res != S_OK || p_res != S_OK) {
+#ifndef NDEBUG
+        if (d3d11_verror) OutputDebugString((const char *) d3d11_verror->GetBufferPointer());
+        if (d3d11_perror) OutputDebugString((const char *) d3d11_perror->GetBufferPointer());
+#endif
+        er_push(str8("Error creating shaders"));
+        error = 1;
+    }
+    
+    if (d3d11_verror) {
+        d3d11_verror->Release();
+    }
+    
+    if (d3d11_perror) {
+        d3d11_perror->Release();
+    }
+    
+    b32 result = !error;
+    return(result);
+}
+
+internal b32 d3d11_compile_pixel_shader(u8 *source, usize size, const char *entry, ID3DBlob **pshader)
+{
+    UINT flags = D3DCOMPILE_PACK_MATRIX_COLUMN_MAJOR | D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_WARNINGS_ARE_ERRORS;
+#ifndef NDEBUG
+    flags |= D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#else
+    flags |= D3DCOMPILE_OPTIMIZATION_LEVEL3;
+#endif
+    ID3DBlob *d3d11_perror = 0;
+    HRESULT p_res = D3DCompile(source, size, 0, 0, 0, entry, "ps_5_0", flags, 0, pshader, &d3d11_perror);
+    
+    b32 error = 0;
+    if (p_res != S_OK) {
+#ifndef NDEBUG
+        if (d3d11_perror) OutputDebugString((const char *) d3d11_perror->GetBufferPointer());
+#endif
+        er_push(str8("Error creating shaders"));
+        error = 1;
+    }
+    
+    if (d3d11_perror) {
+        d3d11_perror->Release();
+    }
+    
+    b32 result = !error;
+    return(result);
+}
+
+internal b32 d3d11_instance_buffer_reserve(usize bytes)
+{
+    if (bytes > d3d11_state.instance_cap) {
+        usize cap = d3d11_state.instance_cap;
+        while (cap < bytes) {
+            cap *= 2;
+        }
+        
+        D3D11_BUFFER_DESC desc = {0};
+        desc.ByteWidth      = (UINT) cap;
+        desc.Usage          = D3D11_USAGE_DYNAMIC;
+        desc.BindFlags      = D3D11_BIND_VERTEX_BUFFER;
+        desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        
+        ID3D11Buffer *buffer = 0;
+        d3d11_state.device->CreateBuffer(&desc, 0, &buffer);
+        if (buffer) {
+            d3d11_state.buffer[I_BUFFER]->Release();
+            d3d11_state.buffer[I_BUFFER] = buffer;
+            d3d11_state.instance_cap = cap;
+        }
+    }
+    
+    b32 result = (bytes <= d3d11_state.instance_cap);
+    return(result);
+}
+
+internal b32 d3d11_line_buffer_reserve(usize count)
+{
+    if (count > d3d11_state.line_cap) {
+        usize cap = MAX(d3d11_state.line_cap, 1);
+        while (cap < count) {
+            cap *= 2;
+        }
+        
+        D3D11_BUFFER_DESC desc = {0};
+        desc.ByteWidth           = (UINT) (cap*sizeof(R_Line_Vertex));
+        desc.Usage               = D3D11_USAGE_DYNAMIC;
+        desc.BindFlags           = D3D11_BIND_SHADER_RESOURCE;
+        desc.CPUAccessFlags      = D3D11_CPU_ACCESS_WRITE;
+        desc.MiscFlags           = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+        desc.StructureByteStride = sizeof(R_Line_Vertex);
+        
+        ID3D11Buffer *buffer = 0;
+        ID3D11ShaderResourceView *view = 0;
+        d3d11_state.device->CreateBuffer(&desc, 0, &buffer);
+        if (buffer) {
+            d3d11_state.device->CreateShaderResourceView(buffer, 0, &view);
+        }
+        
+        if (view) {
+            if (d3d11_state.buffer[L_BUFFER]) d3d11_state.buffer[L_BUFFER]->Release();
+            if (d3d11_state.line_view) d3d11_state.line_view->Release();
+            d3d11_state.buffer[L_BUFFER] = buffer;
+            d3d11_state.line_view = view;
+            d3d11_state.line_cap = cap;
+        } else if (buffer) {
+            buffer->Release();
+        }
+    }
+    
+    b32 result = (count <= d3d11_state.line_cap);
+    return(result);
+}
+
 internal b32 r_is_init(void)
 {
     return(d3d11_is_init);
 }
 
 internal b32 r_backend_init(void)
+{
+    b32 result = r_backend_init_ex(0);
+    return(result);
+}
+
+internal b32 r_backend_init_ex(b32 software)
 {
     b32 error = 0;
     if (d3d11_is_init) {
@@ -91,9 +414,20 @@ internal b32 r_backend_init(void)
         flags |= D3D11_CREATE_DEVICE_DEBUG;
 #endif
         D3D_FEATURE_LEVEL features[] = { D3D_FEATURE_LEVEL_11_0 };
-        HRESULT res = D3D11CreateDevice(0, D3D_DRIVER_TYPE_HARDWARE, 0, flags,
-                                        features, ARRAY_SIZE(features), D3D11_SDK_VERSION,
-                                        &d3d11_state.device, 0, &d3d11_state.context);
+        HRESULT res = E_FAIL;
+        if (!software) {
+            res = D3D11CreateDevice(0, D3D_DRIVER_TYPE_HARDWARE, 0, flags,
+                                    features, ARRAY_SIZE(features), D3D11_SDK_VERSION,
+                                    &d3d11_state.device, 0, &d3d11_state.context);
+        }
+        
+        // @Note: No usable GPU (headless hosts, remote sessions) or asked not to use it, fall back to the
+        // software rasterizer.
+        if (res != S_OK) {
+            res = D3D11CreateDevice(0, D3D_DRIVER_TYPE_WARP, 0, flags,
+                                    features, ARRAY_SIZE(features), D3D11_SDK_VERSION,
+                                    &d3d11_state.device, 0, &d3d11_state.context);
+        }
         
         if (res != S_OK) {
             er_push(str8("Failed to create d3d11 device and context"));
@@ -114,35 +448,7 @@ internal b32 r_backend_init(void)
     ID3DBlob *vshader = 0;
     ID3DBlob *pshader = 0;
     if (!error) {
-        UINT flags = D3DCOMPILE_PACK_MATRIX_COLUMN_MAJOR | D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_WARNINGS_ARE_ERRORS;
-#ifndef NDEBUG
-        flags |= D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
-#else
-        flags |= D3DCOMPILE_OPTIMIZATION_LEVEL3;
-#endif
-        ID3DBlob *d3d11_verror = 0;
-        ID3DBlob *d3d11_perror = 0;
-        HRESULT v_res = D3DCompile(hlsl, sizeof(hlsl), 0, 0, 0, "main_vs", "vs_5_0", flags, 0, &vshader, &d3d11_verror);
-        HRESULT p_res = D3DCompile(hlsl, sizeof(hlsl), 0, 0, 0, "main_ps", "ps_5_0", flags, 0, &pshader, &d3d11_perror);
-        
-        if (v_res != S_OK || p_res != S_OK) {
-#ifndef NDEBUG
-            const char *v_msg = (const char *) d3d11_verror->GetBufferPointer();
-            const char *p_msg = (const char *) d3d11_perror->GetBufferPointer();
-            OutputDebugString(v_msg);
-            OutputDebugString(p_msg);
-#endif
-            er_push(str8("Error creating shaders"));
-            error = 1;
-        }
-        
-        if (d3d11_verror) {
-            d3d11_verror->Release();
-        }
-        
-        if (d3d11_perror) {
-            d3d11_perror->Release();
-        }
+        error = !d3d11_compile_shaders(hlsl, sizeof(hlsl), &vshader, &pshader);
     }
     
     if (!error) {
@@ -166,6 +472,61 @@ internal b32 r_backend_init(void)
         pshader->Release();
     }
     
+    ID3DBlob *sdf_pshader = 0;
+    if (!error) {
+        error = !d3d11_compile_pixel_shader(hlsl, sizeof(hlsl), "main_ps_sdf", &sdf_pshader);
+    }
+    
+    if (!error) {
+        d3d11_state.device->CreatePixelShader(sdf_pshader->GetBufferPointer(), sdf_pshader->GetBufferSize(), NULL, &d3d11_state.sdf_pixel_shader);
+        sdf_pshader->Release();
+    }
+    
+    ID3DBlob *marker_vshader = 0;
+    ID3DBlob *marker_pshader = 0;
+    if (!error) {
+        error = !d3d11_compile_shaders(hlsl_marker, sizeof(hlsl_marker), &marker_vshader, &marker_pshader);
+    }
+    
+    if (!error) {
+        D3D11_INPUT_ELEMENT_DESC desc[] = {
+            // Template
+            { "POS", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+            
+            // Instancing
+            { "CENTER", 0, DXGI_FORMAT_R32G32_FLOAT, 1, offsetof(R_Marker, x), D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+            { "RADIUS", 0, DXGI_FORMAT_R16_FLOAT, 1, offsetof(R_Marker, radius), D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+            { "SHAPE", 0, DXGI_FORMAT_R8_UINT, 1, offsetof(R_Marker, shape), D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+            { "PALETTE", 0, DXGI_FORMAT_R8_UINT, 1, offsetof(R_Marker, palette), D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+        };
+        
+        d3d11_state.device->CreateVertexShader(marker_vshader->GetBufferPointer(), marker_vshader->GetBufferSize(), NULL, &d3d11_state.marker_vertex_shader);
+        d3d11_state.device->CreatePixelShader(marker_pshader->GetBufferPointer(), marker_pshader->GetBufferSize(), NULL, &d3d11_state.marker_pixel_shader);
+        d3d11_state.device->CreateInputLayout(desc, ARRAY_SIZE(desc), marker_vshader->GetBufferPointer(), marker_vshader->GetBufferSize(), &d3d11_state.marker_layout);
+        
+        marker_vshader->Release();
+        marker_pshader->Release();
+    }
+    
+    ID3DBlob *line_vshader = 0;
+    ID3DBlob *line_pshader = 0;
+    if (!error) {
+        error = !d3d11_compile_shaders(hlsl_line, sizeof(hlsl_line), &line_vshader, &line_pshader);
+    }
+    
+    if (!error) {
+        D3D11_INPUT_ELEMENT_DESC desc[] = {
+            { "POS", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        };
+        
+        d3d11_state.device->CreateVertexShader(line_vshader->GetBufferPointer(), line_vshader->GetBufferSize(), NULL, &d3d11_state.line_vertex_shader);
+        d3d11_state.device->CreatePixelShader(line_pshader->GetBufferPointer(), line_pshader->GetBufferSize(), NULL, &d3d11_state.line_pixel_shader);
+        d3d11_state.device->CreateInputLayout(desc, ARRAY_SIZE(desc), line_vshader->GetBufferPointer(), line_vshader->GetBufferSize(), &d3d11_state.line_layout);
+        
+        line_vshader->Release();
+        line_pshader->Release();
+    }
+    
     if (!error) {
         // @Note: This has to be defined in a specific way because we're using
         // triangle-strip as a primitive + back-face culling.
@@ -184,18 +545,31 @@ internal b32 r_backend_init(void)
         desc.CPUAccessFlags = 0;
         d3d11_state.device->CreateBuffer(&desc, &vertex_data, &d3d11_state.buffer[V_BUFFER]);
 
-        // @ToDo: Grow buffer when it becomes full.
+        // @Note: Grows in r_submit_quads when it becomes full.
         desc.ByteWidth      = R_D3D11_BUFFER_INIT_CAP;
         desc.Usage          = D3D11_USAGE_DYNAMIC;
         desc.BindFlags      = D3D11_BIND_VERTEX_BUFFER;
         desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
         d3d11_state.device->CreateBuffer(&desc, 0, &d3d11_state.buffer[I_BUFFER]);
+        d3d11_state.instance_cap = R_D3D11_BUFFER_INIT_CAP;
         
         desc.ByteWidth      = sizeof(D3D11_Cbuffer) + 0xF & 0xFFFFFFF0; // @Note: This _has to_ be a multiple of 16
         desc.Usage          = D3D11_USAGE_DYNAMIC;
         desc.BindFlags      = D3D11_BIND_CONSTANT_BUFFER;
         desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
         d3d11_state.device->CreateBuffer(&desc, 0, &d3d11_state.buffer[C_BUFFER]);
+        
+        desc.ByteWidth      = sizeof(D3D11_Palette);
+        d3d11_state.device->CreateBuffer(&desc, 0, &d3d11_state.buffer[P_BUFFER]);
+        
+        desc.ByteWidth      = sizeof(D3D11_Line_Style);
+        d3d11_state.device->CreateBuffer(&desc, 0, &d3d11_state.buffer[S_BUFFER]);
+        
+        // @Note: Grows in r_submit_lines when it becomes full.
+        if (!d3d11_line_buffer_reserve(R_D3D11_BUFFER_INIT_CAP/sizeof(R_Line_Vertex))) {
+            er_push(str8("Failed to create line buffer"));
+            error = 1;
+        }
     }
     
     if (!error) {
@@ -205,6 +579,9 @@ internal b32 r_backend_init(void)
         desc.ScissorEnable = 1;
         
         d3d11_state.device->CreateRasterizerState(&desc, &d3d11_state.rasterizer);
+        
+        desc.CullMode = D3D11_CULL_NONE;
+        d3d11_state.device->CreateRasterizerState(&desc, &d3d11_state.rasterizer_no_cull);
     }
     
     if (!error) {
@@ -218,7 +595,10 @@ internal b32 r_backend_init(void)
         desc.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
         desc.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
         
-        d3d11_state.device->CreateBlendState(&desc, &d3d11_state.blend_state);
+        d3d11_state.device->CreateBlendState(&desc, &d3d11_state.blend_state[R_BLEND_ALPHA]);
+        
+        desc.RenderTarget[0].DestBlend = D3D11_BLEND_ONE;
+        d3d11_state.device->CreateBlendState(&desc, &d3d11_state.blend_state[R_BLEND_ADDITIVE]);
     }
     
     if (!error) {
@@ -233,6 +613,14 @@ internal b32 r_backend_init(void)
         desc.MaxLOD = D3D11_FLOAT32_MAX;
         
         d3d11_state.device->CreateSamplerState(&desc, &d3d11_state.sampler_state);
+        
+        // @Note: The SDF shader takes its edge from fwidth() of the distance, which only comes out
+        // one pixel wide when the distance is filtered. Glyphs sit next to each other, so no wrapping.
+        desc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+        desc.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
+        desc.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
+        desc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+        d3d11_state.device->CreateSamplerState(&desc, &d3d11_state.sdf_sampler_state);
     }
     
     // @Note: It's better not to use 'r_create_texture' here because 
@@ -263,6 +651,13 @@ internal b32 r_backend_init(void)
     
     if (!error) {
         d3d11_is_init = 1;
+        
+        // @Note: Markers are white until someone sets the palette
+        u32 white[R_MARKER_PALETTE_SIZE];
+        for (u32 i = 0; i < R_MARKER_PALETTE_SIZE; ++i) {
+            white[i] = 0xFFFFFFFF;
+        }
+        r_marker_palette_set(white, R_MARKER_PALETTE_SIZE);
     }
     
     b32 result = !error;
@@ -277,15 +672,33 @@ internal void r_backend_end(void)
     if (d3d11_state.buffer[V_BUFFER]) d3d11_state.buffer[V_BUFFER]->Release();
     if (d3d11_state.buffer[I_BUFFER]) d3d11_state.buffer[I_BUFFER]->Release();
     if (d3d11_state.buffer[C_BUFFER]) d3d11_state.buffer[C_BUFFER]->Release();
+    if (d3d11_state.buffer[P_BUFFER]) d3d11_state.buffer[P_BUFFER]->Release();
+    if (d3d11_state.buffer[L_BUFFER]) d3d11_state.buffer[L_BUFFER]->Release();
+    if (d3d11_state.buffer[S_BUFFER]) d3d11_state.buffer[S_BUFFER]->Release();
+    if (d3d11_state.line_view) d3d11_state.line_view->Release();
     
     if (d3d11_state.layout) d3d11_state.layout->Release();
     if (d3d11_state.vertex_shader) d3d11_state.vertex_shader->Release();
     if (d3d11_state.pixel_shader) d3d11_state.pixel_shader->Release();
+    if (d3d11_state.sdf_pixel_shader) d3d11_state.sdf_pixel_shader->Release();
+    if (d3d11_state.marker_layout) d3d11_state.marker_layout->Release();
+    if (d3d11_state.marker_vertex_shader) d3d11_state.marker_vertex_shader->Release();
+    if (d3d11_state.marker_pixel_shader) d3d11_state.marker_pixel_shader->Release();
+    if (d3d11_state.line_layout) d3d11_state.line_layout->Release();
+    if (d3d11_state.line_vertex_shader) d3d11_state.line_vertex_shader->Release();
+    if (d3d11_state.line_pixel_shader) d3d11_state.line_pixel_shader->Release();
     
     if (d3d11_state.rasterizer) d3d11_state.rasterizer->Release();
-    if (d3d11_state.blend_state) d3d11_state.blend_state->Release();
+    if (d3d11_state.rasterizer_no_cull) d3d11_state.rasterizer_no_cull->Release();
+    for (u32 i = 0; i < R_BLEND_COUNT; ++i) {
+        if (d3d11_state.blend_state[i]) d3d11_state.blend_state[i]->Release();
+    }
     if (d3d11_state.sampler_state) d3d11_state.sampler_state->Release();
+    if (d3d11_state.sdf_sampler_state) d3d11_state.sdf_sampler_state->Release();
     
+    for (D3D11_Target *target = d3d11_state.first_free_target; target != 0; target = target->next) {
+        if (target->pixels_arena) arena_release(target->pixels_arena);
+    }
     if (d3d11_state.arena) arena_release(d3d11_state.arena);
     if (d3d11_state.dummy_texture.data) d3d11_state.dummy_texture.data->Release();
     if (d3d11_state.dummy_texture.view) d3d11_state.dummy_texture.view->Release();
@@ -404,45 +817,74 @@ internal void r_frame_begin(GFX_Window *window, u32 clear_color)
                 d3d11_state.device->CreateRenderTargetView(back_buff, 0, &w->target);
                 back_buff->Release();
 
-                u8 a = (clear_color >> 8*0) & 0xFF;
-                u8 b = (clear_color >> 8*1) & 0xFF;
-                u8 g = (clear_color >> 8*2) & 0xFF;
-                u8 r = (clear_color >> 8*3) & 0xFF;
-                
-                const FLOAT bg[] = { r/255.0f, g/255.0f, b/255.0f, a/255.0f };
+                FLOAT bg[4] = {0};
+                d3d11_color_from_u32(clear_color, bg);
                 d3d11_state.context->ClearRenderTargetView(w->target, bg);
             }
         }
     }
 }
 
-internal b32 r_submit_quads(GFX_Window *window, R_Quad_Node *draw_data, usize total_quad_count, R_Texture2D *texture)
+// @Note: Validates the destination of a submission, fills the cbuffer with its size and
+// returns where to draw. Null window means 'draw into whatever target is currently bound'.
+// Scissors are the whole output, narrowed down to the clip of the draw state if it has one.
+internal b32 d3d11_output_begin(GFX_Window *window, R_Draw_State *draw_state, ID3D11RenderTargetView **target_view, D3D11_VIEWPORT **viewport, D3D11_RECT *scissors)
 {
-    OPTICK_EVENT();
-    
     b32 error = 0;
     if (!r_is_init()) {
         er_push(str8("render backend not initialized"));
         error = 1;
     }
     
-    if (!gfx_window_is_valid(window)) {
+    if (window == 0) {
+        if (d3d11_state.current_target == 0) {
+            er_push(str8("no window provided and no render target bound"));
+            error = 1;
+        }
+    } else if (!gfx_window_is_valid(window)) {
         er_push(str8("provided window is invalid"));
         error = 1;
     }
     
     if (!error) {
         f32 width, height;
-        gfx_window_get_rect(window, &width, &height);
-        
-        D3D11_Window *w = d3d11_window_from_opaque(window);
-        w->viewport.Width = width;
-        w->viewport.Height = height;
+        HMM_Vec2 offset = {0};
+        if (window == 0) {
+            D3D11_Target *target = d3d11_state.current_target;
+            width = target->canvas.X;
+            height = target->canvas.Y;
+            offset = target->offset;
+            
+            *target_view = target->view;
+            *viewport = &target->viewport;
+            *scissors = target->scissors;
+        } else {
+            gfx_window_get_rect(window, &width, &height);
+            
+            D3D11_Window *w = d3d11_window_from_opaque(window);
+            w->viewport.Width = width;
+            w->viewport.Height = height;
+            
+            w->scissors.top = 0;
+            w->scissors.left = 0;
+            w->scissors.bottom = (LONG) height;
+            w->scissors.right = (LONG) width;
+            
+            *target_view = w->target;
+            *viewport = &w->viewport;
+            *scissors = w->scissors;
+        }
         
-        w->scissors.top = 0;
-        w->scissors.left = 0;
-        w->scissors.bottom = (LONG) height;
-        w->scissors.right = (LONG) width;
+        if (draw_state->clipped) {
+            // @Note: Round outwards, the smooth edges of things touching the clip stay intact
+            // @Note: Clips are in canvas pixels, scissors in target pixels
+            scissors->left = MAX(scissors->left, (LONG) (draw_state->clip.x0 - offset.X));
+            scissors->top = MAX(scissors->top, (LONG) (draw_state->clip.y0 - offset.Y));
+            scissors->right = MIN(scissors->right, (LONG) (draw_state->clip.x1 - offset.X + 0.999f));
+            scissors->bottom = MIN(scissors->bottom, (LONG) (draw_state->clip.y1 - offset.Y + 0.999f));
+            scissors->right = MAX(scissors->left, scissors->right);
+            scissors->bottom = MAX(scissors->top, scissors->bottom);
+        }
         
         d3d11_state.cbuffer.res.X = width;
         d3d11_state.cbuffer.res.Y = height;
@@ -451,7 +893,29 @@ internal b32 r_submit_quads(GFX_Window *window, R_Quad_Node *draw_data, usize to
         d3d11_state.context->Map(d3d11_state.buffer[C_BUFFER], 0, D3D11_MAP_WRITE_DISCARD, 0, &cbuffer_resource);
         MemoryCopy(cbuffer_resource.pData, &d3d11_state.cbuffer, sizeof(D3D11_Cbuffer));
         d3d11_state.context->Unmap(d3d11_state.buffer[C_BUFFER], 0);
-        
+    }
+    
+    b32 result = !error;
+    return(result);
+}
+
+internal b32 r_submit_quads(GFX_Window *window, R_Quad_Node *draw_data, usize total_quad_count, R_Draw_State draw_state)
+{
+    OPTICK_EVENT();
+    
+    ID3D11RenderTargetView *target_view = 0;
+    D3D11_VIEWPORT *viewport = 0;
+    D3D11_RECT scissors = {0};
+    b32 error = !d3d11_output_begin(window, &draw_state, &target_view, &viewport, &scissors);
+    
+    if (!error) {
+        if (!d3d11_instance_buffer_reserve(total_quad_count*sizeof(R_Quad))) {
+            er_push(str8("Failed to grow instance buffer"));
+            error = 1;
+        }
+    }
+    
+    if (!error) {
         D3D11_MAPPED_SUBRESOURCE vertex_resource = {0};
         d3d11_state.context->Map(d3d11_state.buffer[I_BUFFER], 0, D3D11_MAP_WRITE_DISCARD, 0, &vertex_resource);
         {
@@ -459,17 +923,17 @@ internal b32 r_submit_quads(GFX_Window *window, R_Quad_Node *draw_data, usize to
             usize offset = 0;
             for (R_Quad_Node *node = draw_data; node != 0; node = node->next) {
                 usize bytes = node->count * sizeof(R_Quad);
-                MemoryCopy(dst_ptr, node->quads, bytes);
+                MemoryCopy(dst_ptr + offset, node->quads, bytes);
                 offset += bytes;
             }
         }
         d3d11_state.context->Unmap(d3d11_state.buffer[I_BUFFER], 0);
         
         D3D11_Texture *d3d11_texture = 0;
-        if (texture == 0) {
+        if (draw_state.texture == 0) {
             d3d11_texture = &d3d11_state.dummy_texture;
         } else {
-            d3d11_texture = (D3D11_Texture *) texture;
+            d3d11_texture = (D3D11_Texture *) draw_state.texture;
         }
         
         ID3D11Buffer *buffers[] = { d3d11_state.buffer[V_BUFFER], d3d11_state.buffer[I_BUFFER] };
@@ -484,15 +948,22 @@ internal b32 r_submit_quads(GFX_Window *window, R_Quad_Node *draw_data, usize to
         d3d11_state.context->VSSetShader(d3d11_state.vertex_shader, 0, 0);
         
         d3d11_state.context->RSSetState(d3d11_state.rasterizer);
-        d3d11_state.context->RSSetViewports(1, &w->viewport);
-        d3d11_state.context->RSSetScissorRects(1, &w->scissors);
+        d3d11_state.context->RSSetViewports(1, viewport);
+        d3d11_state.context->RSSetScissorRects(1, &scissors);
         
-        d3d11_state.context->PSSetShader(d3d11_state.pixel_shader, 0, 0);
-        d3d11_state.context->PSSetSamplers(0, 1, &d3d11_state.sampler_state);
+        ID3D11PixelShader *pixel_shader = d3d11_state.pixel_shader;
+        ID3D11SamplerState *sampler_state = d3d11_state.sampler_state;
+        if (draw_state.sample == R_SAMPLE_SDF) {
+            pixel_shader = d3d11_state.sdf_pixel_shader;
+            sampler_state = d3d11_state.sdf_sampler_state;
+        }
+        
+        d3d11_state.context->PSSetShader(pixel_shader, 0, 0);
+        d3d11_state.context->PSSetSamplers(0, 1, &sampler_state);
         d3d11_state.context->PSSetShaderResources(0, 1, &d3d11_texture->view);
         
-        d3d11_state.context->OMSetRenderTargets(1, &w->target, 0);
-        d3d11_state.context->OMSetBlendState(d3d11_state.blend_state, 0, 0xFFFFFFFF);
+        d3d11_state.context->OMSetRenderTargets(1, &target_view, 0);
+        d3d11_state.context->OMSetBlendState(d3d11_state.blend_state[draw_state.blend], 0, 0xFFFFFFFF);
         
         d3d11_state.context->DrawInstanced(4, (UINT) total_quad_count, 0, 0);
     }
@@ -501,6 +972,155 @@ internal b32 r_submit_quads(GFX_Window *window, R_Quad_Node *draw_data, usize to
     return(result);
 }
 
+internal b32 r_submit_markers(GFX_Window *window, R_Marker_Node *draw_data, usize total_marker_count, R_Draw_State draw_state)
+{
+    OPTICK_EVENT();
+    
+    ID3D11RenderTargetView *target_view = 0;
+    D3D11_VIEWPORT *viewport = 0;
+    D3D11_RECT scissors = {0};
+    b32 error = !d3d11_output_begin(window, &draw_state, &target_view, &viewport, &scissors);
+    
+    // @Note: Shares the instance buffer with the quads, only the stride differs.
+    if (!error) {
+        if (!d3d11_instance_buffer_reserve(total_marker_count*sizeof(R_Marker))) {
+            er_push(str8("Failed to grow instance buffer"));
+            error = 1;
+        }
+    }
+    
+    if (!error) {
+        D3D11_MAPPED_SUBRESOURCE vertex_resource = {0};
+        d3d11_state.context->Map(d3d11_state.buffer[I_BUFFER], 0, D3D11_MAP_WRITE_DISCARD, 0, &vertex_resource);
+        {
+            u8 *dst_ptr = (u8 *) vertex_resource.pData;
+            usize offset = 0;
+            for (R_Marker_Node *node = draw_data; node != 0; node = node->next) {
+                usize bytes = node->count * sizeof(R_Marker);
+                MemoryCopy(dst_ptr + offset, node->markers, bytes);
+                offset += bytes;
+            }
+        }
+        d3d11_state.context->Unmap(d3d11_state.buffer[I_BUFFER], 0);
+        
+        ID3D11Buffer *buffers[] = { d3d11_state.buffer[V_BUFFER], d3d11_state.buffer[I_BUFFER] };
+        UINT strides[] = { sizeof(R_Vertex), sizeof(R_Marker) };
+        UINT offsets[] = { 0, 0 };
+        ID3D11Buffer *cbuffers[] = { d3d11_state.buffer[C_BUFFER], d3d11_state.buffer[P_BUFFER] };
+        
+        d3d11_state.context->IASetInputLayout(d3d11_state.marker_layout);
+        d3d11_state.context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+        d3d11_state.context->IASetVertexBuffers(0, ARRAY_SIZE(buffers), buffers, strides, offsets);
+        
+        d3d11_state.context->VSSetConstantBuffers(0, ARRAY_SIZE(cbuffers), cbuffers);
+        d3d11_state.context->VSSetShader(d3d11_state.marker_vertex_shader, 0, 0);
+        
+        d3d11_state.context->RSSetState(d3d11_state.rasterizer);
+        d3d11_state.context->RSSetViewports(1, viewport);
+        d3d11_state.context->RSSetScissorRects(1, &scissors);
+        
+        d3d11_state.context->PSSetShader(d3d11_state.marker_pixel_shader, 0, 0);
+        
+        d3d11_state.context->OMSetRenderTargets(1, &target_view, 0);
+        d3d11_state.context->OMSetBlendState(d3d11_state.blend_state[draw_state.blend], 0, 0xFFFFFFFF);
+        
+        d3d11_state.context->DrawInstanced(4, (UINT) total_marker_count, 0, 0);
+    }
+    
+    b32 result = !error;
+    return(result);
+}
+
+internal b32 r_submit_lines(GFX_Window *window, R_Line_Node *draw_data, usize total_vertex_count, R_Draw_State draw_state)
+{
+    OPTICK_EVENT();
+    
+    ID3D11RenderTargetView *target_view = 0;
+    D3D11_VIEWPORT *viewport = 0;
+    D3D11_RECT scissors = {0};
+    b32 error = !d3d11_output_begin(window, &draw_state, &target_view, &viewport, &scissors);
+    
+    if (!error) {
+        if (!d3d11_line_buffer_reserve(total_vertex_count)) {
+            er_push(str8("Failed to grow line buffer"));
+            error = 1;
+        }
+    }
+    
+    if (!error && total_vertex_count > 1) {
+        D3D11_Line_Style style = {0};
+        d3d11_color_from_u32(draw_state.line.col, style.col);
+        style.half_width = draw_state.line.width*0.5f;
+        style.dash = draw_state.line.dash;
+        style.gap = draw_state.line.gap;
+        style.join = (u32) draw_state.line.join;
+        
+        D3D11_MAPPED_SUBRESOURCE style_resource = {0};
+        d3d11_state.context->Map(d3d11_state.buffer[S_BUFFER], 0, D3D11_MAP_WRITE_DISCARD, 0, &style_resource);
+        MemoryCopy(style_resource.pData, &style, sizeof(D3D11_Line_Style));
+        d3d11_state.context->Unmap(d3d11_state.buffer[S_BUFFER], 0);
+        
+        D3D11_MAPPED_SUBRESOURCE line_resource = {0};
+        d3d11_state.context->Map(d3d11_state.buffer[L_BUFFER], 0, D3D11_MAP_WRITE_DISCARD, 0, &line_resource);
+        {
+            u8 *dst_ptr = (u8 *) line_resource.pData;
+            usize offset = 0;
+            for (R_Line_Node *node = draw_data; node != 0; node = node->next) {
+                usize bytes = node->count * sizeof(R_Line_Vertex);
+                MemoryCopy(dst_ptr + offset, node->vertices, bytes);
+                offset += bytes;
+            }
+        }
+        d3d11_state.context->Unmap(d3d11_state.buffer[L_BUFFER], 0);
+        
+        UINT stride = sizeof(R_Vertex);
+        UINT offset = 0;
+        ID3D11Buffer *cbuffers[] = { d3d11_state.buffer[C_BUFFER], d3d11_state.buffer[S_BUFFER] };
+        
+        d3d11_state.context->IASetInputLayout(d3d11_state.line_layout);
+        d3d11_state.context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+        d3d11_state.context->IASetVertexBuffers(0, 1, &d3d11_state.buffer[V_BUFFER], &stride, &offset);
+        
+        d3d11_state.context->VSSetConstantBuffers(0, ARRAY_SIZE(cbuffers), cbuffers);
+        d3d11_state.context->VSSetShaderResources(0, 1, &d3d11_state.line_view);
+        d3d11_state.context->VSSetShader(d3d11_state.line_vertex_shader, 0, 0);
+        
+        d3d11_state.context->RSSetState(d3d11_state.rasterizer_no_cull);
+        d3d11_state.context->RSSetViewports(1, viewport);
+        d3d11_state.context->RSSetScissorRects(1, &scissors);
+        
+        d3d11_state.context->PSSetConstantBuffers(1, 1, &d3d11_state.buffer[S_BUFFER]);
+        d3d11_state.context->PSSetShader(d3d11_state.line_pixel_shader, 0, 0);
+        
+        d3d11_state.context->OMSetRenderTargets(1, &target_view, 0);
+        d3d11_state.context->OMSetBlendState(d3d11_state.blend_state[draw_state.blend], 0, 0xFFFFFFFF);
+        
+        // @Note: Segment i goes from vertex i to i + 1
+        d3d11_state.context->DrawInstanced(4, (UINT) (total_vertex_count - 1), 0, 0);
+    }
+    
+    b32 result = !error;
+    return(result);
+}
+
+internal void r_marker_palette_set(u32 *colors, u32 count)
+{
+    if (!r_is_init()) {
+        er_push(str8("render backend not initialized"));
+    } else {
+        // @Note: Whole palette goes up every time, the copy keeps the untouched entries.
+        count = MIN(count, R_MARKER_PALETTE_SIZE);
+        for (u32 i = 0; i < count; ++i) {
+            d3d11_color_from_u32(colors[i], d3d11_state.palette.colors[i]);
+        }
+        
+        D3D11_MAPPED_SUBRESOURCE resource = {0};
+        d3d11_state.context->Map(d3d11_state.buffer[P_BUFFER], 0, D3D11_MAP_WRITE_DISCARD, 0, &resource);
+        MemoryCopy(resource.pData, &d3d11_state.palette, sizeof(D3D11_Palette));
+        d3d11_state.context->Unmap(d3d11_state.buffer[P_BUFFER], 0);
+    }
+}
+
 internal void r_frame_end(GFX_Window *window)
 {
     OPTICK_EVENT();
@@ -518,64 +1138,305 @@ internal void r_frame_end(GFX_Window *window)
     }
 }
 
-internal u8 *r_frame_end_get_backbuffer(GFX_Window *window, Arena *arena)
+internal R_Target *r_target_create(u32 width, u32 height)
 {
-    u8 *result = 0;
+    b32 error = 0;
     if (!r_is_init()) {
         er_push(str8("render backend not initialized"));
-    } else {
-        if (gfx_window_is_valid(window)) {
-            D3D11_Window *w = d3d11_window_from_opaque(window);
-            if (w->swap_chain && w->target) {
-                w->swap_chain->Present(0, 0);
+        error = 1;
+    }
+    
+    if (width == 0 || height == 0) {
+        er_push(str8("Render target has to have a non-zero size"));
+        error = 1;
+    }
+    
+    R_Target *result = 0;
+    if (!error) {
+        D3D11_Target *target = d3d11_state.first_free_target;
+        if (target == 0) {
+            target = arena_push_array(d3d11_state.arena, D3D11_Target, 1);
+        } else {
+            SLLStackPop(d3d11_state.first_free_target);
+        }
+        
+        // @Note: Keep the readback buffer around if it's big enough, that's the whole point of pooling
+        usize bytes = (usize) width*height*4;
+        Arena *pixels_arena = target->pixels_arena;
+        u8 *pixels = target->pixels;
+        usize pixels_cap = target->pixels_cap;
+        if (pixels_cap < bytes) {
+            if (pixels_arena) arena_release(pixels_arena);
+            pixels_arena = arena_make_sized(MAX(ARENA_HEADER_SIZE + bytes, ARENA_DEFAULT_COMMIT), 0);
+            pixels = arena_push_array(pixels_arena, u8, bytes);
+            pixels_cap = bytes;
+        }
+        
+        MemoryZero(target, sizeof(D3D11_Target));
+        target->width = width;
+        target->height = height;
+        target->pixels_arena = pixels_arena;
+        target->pixels = pixels;
+        target->pixels_cap = pixels_cap;
+        
+        D3D11_TEXTURE2D_DESC desc = {0};
+        desc.Width = width;
+        desc.Height = height;
+        desc.MipLevels = 1;
+        desc.ArraySize = 1;
+        desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        desc.SampleDesc.Count = 1;
+        desc.SampleDesc.Quality = 0;
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        desc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+        desc.CPUAccessFlags = 0;
+        desc.MiscFlags = 0;
+        
+        d3d11_state.device->CreateTexture2D(&desc, 0, &target->data);
+        d3d11_state.device->CreateRenderTargetView(target->data, 0, &target->view);
+        
+        target->viewport.TopLeftX = 0;
+        target->viewport.TopLeftY = 0;
+        target->viewport.Width = (f32) width;
+        target->viewport.Height = (f32) height;
+        target->viewport.MinDepth = 0.0f;
+        target->viewport.MaxDepth = 1.0f;
+        target->canvas.X = (f32) width;
+        target->canvas.Y = (f32) height;
+        
+        target->scissors.top = 0;
+        target->scissors.left = 0;
+        target->scissors.bottom = (LONG) height;
+        target->scissors.right = (LONG) width;
+        
+        if (target->data == 0 || target->view == 0) {
+            er_push(str8("Error creating render target"));
+            
+            if (target->data) target->data->Release();
+            if (target->view) target->view->Release();
+            SLLStackPush(d3d11_state.first_free_target, target);
+        } else {
+            result = (R_Target *) target;
+        }
+    }
+    
+    return(result);
+}
 
-                f32 width, height;
-                gfx_window_get_rect(window, &width, &height);
-                
-                u32 bytes = (u32) (width*height*4);
-                result = arena_push_array(arena, u8, bytes);
+internal b32 r_target_destroy(R_Target *target)
+{
+    b32 error = 0;
+    if (!r_is_init()) {
+        er_push(str8("render backend not initialized"));
+        error = 1;
+    }
+    
+    if (target == 0) {
+        er_push(str8("Provided target was null"));
+        error = 1;
+    }
+    
+    if (!error) {
+        D3D11_Target *d3d11_target = (D3D11_Target *) target;
+        if (d3d11_state.current_target == d3d11_target) {
+            d3d11_state.current_target = 0;
+        }
+        
+        d3d11_target->data->Release();
+        d3d11_target->view->Release();
+        if (d3d11_target->staging) {
+            d3d11_target->staging->Release();
+        }
+        
+        d3d11_target->data = 0;
+        d3d11_target->view = 0;
+        d3d11_target->staging = 0;
+        
+        SLLStackPush(d3d11_state.first_free_target, d3d11_target);
+    }
+    
+    b32 result = !error;
+    return(result);
+}
 
-                ID3D11Texture2D *surface = 0;
-                w->swap_chain->GetBuffer(0, __uuidof(ID3D11Texture2D), (void **) &surface);
+internal b32 r_target_begin(R_Target *target, u32 clear_color)
+{
+    HMM_Vec2 offset = {0};
+    HMM_Vec2 canvas = {0};
+    b32 result = r_target_begin_ex(target, clear_color, offset, canvas);
+    return(result);
+}
 
-                D3D11_TEXTURE2D_DESC desc = {0};
-                surface->GetDesc(&desc);
-                desc.BindFlags = 0;
-                desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ | D3D11_CPU_ACCESS_WRITE;
-                desc.Usage = D3D11_USAGE_STAGING;
+internal b32 r_target_begin_ex(R_Target *target, u32 clear_color, HMM_Vec2 offset, HMM_Vec2 canvas)
+{
+    b32 error = 0;
+    if (!r_is_init()) {
+        er_push(str8("render backend not initialized"));
+        error = 1;
+    }
+    
+    if (target == 0) {
+        er_push(str8("Provided target was null"));
+        error = 1;
+    }
+    
+    if (canvas.X > R_TARGET_MAX_CANVAS || canvas.Y > R_TARGET_MAX_CANVAS) {
+        er_push(str8("Canvas is bigger than R_TARGET_MAX_CANVAS"));
+        error = 1;
+    }
+    
+    if (!error) {
+        D3D11_Target *d3d11_target = (D3D11_Target *) target;
+        d3d11_state.current_target = d3d11_target;
+        
+        if (canvas.X <= 0.0f || canvas.Y <= 0.0f) {
+            canvas.X = (f32) d3d11_target->width;
+            canvas.Y = (f32) d3d11_target->height;
+            offset.X = 0.0f;
+            offset.Y = 0.0f;
+        }
+        
+        // @Note: Viewports may reach outside of the target (down to D3D11_VIEWPORT_BOUNDS_MIN), which
+        // is how a window of the canvas ends up in it without touching any of the vertex data.
+        d3d11_target->offset = offset;
+        d3d11_target->canvas = canvas;
+        d3d11_target->viewport.TopLeftX = -offset.X;
+        d3d11_target->viewport.TopLeftY = -offset.Y;
+        d3d11_target->viewport.Width = canvas.X;
+        d3d11_target->viewport.Height = canvas.Y;
+        
+        FLOAT bg[4] = {0};
+        d3d11_color_from_u32(clear_color, bg);
+        d3d11_state.context->ClearRenderTargetView(d3d11_target->view, bg);
+    }
+    
+    b32 result = !error;
+    return(result);
+}
 
-                ID3D11Texture2D *tex = 0;
-                d3d11_state.device->CreateTexture2D(&desc, 0, &tex);
-                d3d11_state.context->CopyResource(tex, surface);
-                
-                D3D11_MAPPED_SUBRESOURCE texture_resource = {0};
-                d3d11_state.context->Map(tex, 0, D3D11_MAP_READ_WRITE, 0, &texture_resource);
+internal void r_target_end(R_Target *target)
+{
+    if (!r_is_init()) {
+        er_push(str8("render backend not initialized"));
+    } else {
+        if (d3d11_state.current_target == (D3D11_Target *) target) {
+            d3d11_state.current_target = 0;
+        }
+    }
+}
 
-                u8 *dst = result;
-                u8 *src = ((u8 *) texture_resource.pData);
-                for (u32 i = 0; i < (u32) height; ++i) {
-                    MemoryCopy(dst, src, (u32) (width*4));
+internal b32 d3d11_target_staging(D3D11_Target *target)
+{
+    if (target->staging == 0) {
+        D3D11_TEXTURE2D_DESC desc = {0};
+        target->data->GetDesc(&desc);
+        desc.BindFlags = 0;
+        desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+        desc.Usage = D3D11_USAGE_STAGING;
+        
+        d3d11_state.device->CreateTexture2D(&desc, 0, &target->staging);
+    }
+    
+    b32 result = target->staging != 0;
+    return(result);
+}
+
+internal u8 *r_target_read_pixels(R_Target *target)
+{
+    OPTICK_EVENT();
+    
+    u8 *result = 0;
+    if (!r_is_init()) {
+        er_push(str8("render backend not initialized"));
+    } else if (target == 0) {
+        er_push(str8("Provided target was null"));
+    } else {
+        D3D11_Target *d3d11_target = (D3D11_Target *) target;
+        if (d3d11_target_staging(d3d11_target)) {
+            d3d11_state.context->CopyResource(d3d11_target->staging, d3d11_target->data);
+            
+            D3D11_MAPPED_SUBRESOURCE texture_resource = {0};
+            if (d3d11_state.context->Map(d3d11_target->staging, 0, D3D11_MAP_READ, 0, &texture_resource) == S_OK) {
+                usize row_bytes = (usize) d3d11_target->width*4;
+                u8 *dst = d3d11_target->pixels;
+                u8 *src = (u8 *) texture_resource.pData;
+                for (u32 i = 0; i < d3d11_target->height; ++i) {
+                    MemoryCopy(dst, src, row_bytes);
                     
-                    dst += (u32) (width*4);
+                    dst += row_bytes;
                     src += texture_resource.RowPitch;
                 }
                 
-                d3d11_state.context->Unmap(tex, 0);
-                    
-                tex->Release();
-                surface->Release();
-                
-                w->target->Release();
+                d3d11_state.context->Unmap(d3d11_target->staging, 0);
+                result = d3d11_target->pixels;
             }
         }
     }
+    
+    return(result);
+}
 
+internal void r_target_read_begin(R_Target *target)
+{
+    OPTICK_EVENT();
+    
+    if (!r_is_init()) {
+        er_push(str8("render backend not initialized"));
+    } else if (target == 0) {
+        er_push(str8("Provided target was null"));
+    } else {
+        D3D11_Target *d3d11_target = (D3D11_Target *) target;
+        if (d3d11_target_staging(d3d11_target)) {
+            d3d11_state.context->CopyResource(d3d11_target->staging, d3d11_target->data);
+        }
+    }
+}
+
+internal u8 *r_target_map(R_Target *target, u32 *pitch)
+{
+    u8 *result = r_target_map_ex(target, pitch, 0);
     return(result);
 }
 
+internal u8 *r_target_map_ex(R_Target *target, u32 *pitch, b32 wait)
+{
+    u8 *result = 0;
+    if (!r_is_init()) {
+        er_push(str8("render backend not initialized"));
+    } else if (target == 0) {
+        er_push(str8("Provided target was null"));
+    } else {
+        // @Note: Still drawing comes back as DXGI_ERROR_WAS_STILL_DRAWING, that's just 'not yet'.
+        D3D11_Target *d3d11_target = (D3D11_Target *) target;
+        D3D11_MAPPED_SUBRESOURCE texture_resource = {0};
+        UINT flags = wait ? 0 : D3D11_MAP_FLAG_DO_NOT_WAIT;
+        if (d3d11_target->staging &&
+            d3d11_state.context->Map(d3d11_target->staging, 0, D3D11_MAP_READ, flags, &texture_resource) == S_OK) {
+            result = (u8 *) texture_resource.pData;
+            *pitch = texture_resource.RowPitch;
+        }
+    }
+    
+    return(result);
+}
+
+internal void r_target_unmap(R_Target *target)
+{
+    if (!r_is_init()) {
+        er_push(str8("render backend not initialized"));
+    } else if (target == 0) {
+        er_push(str8("Provided target was null"));
+    } else {
+        D3D11_Target *d3d11_target = (D3D11_Target *) target;
+        if (d3d11_target->staging) {
+            d3d11_state.context->Unmap(d3d11_target->staging, 0);
+        }
+    }
+}
+
 internal R_Texture2D *r_texture_create(void *data, u32 width, u32 height)
 {
-    Assert(IS_POW2(width) && IS_POW2(height) && width != 0 && height != 0);
+    Assert(width != 0 && height != 0);
     
     R_Texture2D *result = 0;
     
@@ -600,7 +1461,7 @@ internal R_Texture2D *r_texture_create(void *data, u32 width, u32 height)
         tex_desc.SampleDesc.Quality = 0;
         tex_desc.Usage = D3D11_USAGE_DEFAULT;
         tex_desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-        tex_desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        tex_desc.CPUAccessFlags = 0; // @Note: Writes go through UpdateSubresource, default usage can't be mapped
         tex_desc.MiscFlags = 0;
         
         D3D11_SUBRESOURCE_DATA tex_data = {0};
@@ -608,7 +1469,7 @@ internal R_Texture2D *r_texture_create(void *data, u32 width, u32 height)
         tex_data.SysMemPitch = sizeof(u32)*width;
         tex_data.SysMemSlicePitch = 0; // @Note: Only used in 3D textures according to docs
         
-        d3d11_state.device->CreateTexture2D(&tex_desc, &tex_data, &texture->data);
+        d3d11_state.device->CreateTexture2D(&tex_desc, data ? &tex_data : 0, &texture->data);
         d3d11_state.device->CreateShaderResourceView(texture->data, 0, &texture->view);
         
         result = (R_Texture2D *) texture;
@@ -643,8 +1504,13 @@ internal b32 r_texture_destroy(R_Texture2D *texture)
     return(result);
 }
 
-// @ToDo: Update a sub-region of a texture
 internal b32 r_texture_update(R_Texture2D *texture, void *data, u32 width, u32 height)
+{
+    b32 result = r_texture_update_region(texture, data, 0, 0, width, height, sizeof(u32)*width);
+    return(result);
+}
+
+internal b32 r_texture_update_region(R_Texture2D *texture, void *data, u32 x, u32 y, u32 width, u32 height, u32 pitch)
 {
     OPTICK_EVENT();
     
@@ -659,26 +1525,52 @@ internal b32 r_texture_update(R_Texture2D *texture, void *data, u32 width, u32 h
         error = 1;
     }
     
-    if (!error) {
+    if (!error && width > 0 && height > 0) {
         D3D11_Texture *d3d11_texture = (D3D11_Texture *) texture;
         
         D3D11_BOX box = {0};
         box.front = 0;
         box.back = 1;
-        box.left = 0;
-        box.right = width;
-        box.top = 0;
-        box.bottom = height;
+        box.left = x;
+        box.right = x + width;
+        box.top = y;
+        box.bottom = y + height;
         
-        d3d11_state.context->UpdateSubresource(d3d11_texture->data, 0, &box, data, sizeof(u32)*width, sizeof(u32)*width*height);
+        d3d11_state.context->UpdateSubresource(d3d11_texture->data, 0, &box, data, pitch, pitch*height);
+    }
+    
+    b32 result = !error;
+    return(result);
+}
+
+internal b32 r_texture_copy_region(R_Texture2D *dst, u32 dst_x, u32 dst_y, R_Texture2D *src, u32 src_x, u32 src_y, u32 width, u32 height)
+{
+    OPTICK_EVENT();
+    
+    b32 error = 0;
+    if (!r_is_init()) {
+        er_push(str8("render backend not initialized"));
+        error = 1;
+    }
+    
+    if (dst == 0 || src == 0) {
+        er_push(str8("Provided texture was null"));
+        error = 1;
+    }
+    
+    if (!error && width > 0 && height > 0) {
+        D3D11_Texture *d3d11_dst = (D3D11_Texture *) dst;
+        D3D11_Texture *d3d11_src = (D3D11_Texture *) src;
         
-        // @ToDo: This is causing 'use after poison' sometimes, should investigate
-#if 0
-        D3D11_MAPPED_SUBRESOURCE texture_resource = {0};
-        d3d11_state.context->Map(d3d11_texture->data, 0, D3D11_MAP_WRITE_DISCARD, 0, &texture_resource);
-        MemoryCopy(texture_resource.pData, data, sizeof(u32)*width*height);
-        d3d11_state.context->Unmap(d3d11_texture->data, 0);
-#endif
+        D3D11_BOX box = {0};
+        box.front = 0;
+        box.back = 1;
+        box.left = src_x;
+        box.right = src_x + width;
+        box.top = src_y;
+        box.bottom = src_y + height;
+        
+        d3d11_state.context->CopySubresourceRegion(d3d11_dst->data, 0, dst_x, dst_y, 0, d3d11_src->data, 0, &box);
     }
     
     b32 result = !error;
@@ -13,6 +13,9 @@ typedef enum {
     V_BUFFER = 0,
     I_BUFFER,
     C_BUFFER,
+    P_BUFFER, // @Note: Marker palette
+    L_BUFFER, // @Note: Line vertices, structured
+    S_BUFFER, // @Note: Line style
     BUFFER_COUNT,
 } D3D11_Buffer_Type;
 
@@ -20,6 +23,18 @@ typedef struct {
     HMM_Vec2 res;
 } D3D11_Cbuffer;
 
+typedef struct {
+    FLOAT colors[R_MARKER_PALETTE_SIZE][4];
+} D3D11_Palette;
+
+typedef struct {
+    FLOAT col[4];
+    f32 half_width;
+    f32 dash;
+    f32 gap;
+    u32 join;
+} D3D11_Line_Style;
+
 typedef struct D3D11_Texture {
     struct D3D11_Texture *next;
     
@@ -27,25 +42,66 @@ typedef struct D3D11_Texture {
     ID3D11ShaderResourceView *view;
 } D3D11_Texture;
 
+typedef struct D3D11_Target {
+    struct D3D11_Target *next;
+    
+    u32 width;
+    u32 height;
+    
+    ID3D11Texture2D *data;
+    ID3D11RenderTargetView *view;
+    ID3D11Texture2D *staging; // @Note: Created on first read, then reused
+    D3D11_VIEWPORT viewport;
+    D3D11_RECT scissors;
+    
+    // @Note: From r_target_begin_ex(), the viewport spans the whole canvas shifted by -offset
+    HMM_Vec2 offset;
+    HMM_Vec2 canvas;
+    
+    // @Note: Readback buffer, stays with the slot when it goes back to the free-list. It has an arena of
+    // its own that's remade when it has to grow, so bigger targets don't pile up in the backend's arena.
+    Arena *pixels_arena;
+    u8 *pixels;
+    usize pixels_cap;
+} D3D11_Target;
+
 typedef struct {
     ID3D11Device *device;
     ID3D11DeviceContext *context;
     
     ID3D11Buffer *buffer[BUFFER_COUNT];
+    usize instance_cap; // @Note: Size of I_BUFFER in bytes
+    usize line_cap; // @Note: Size of L_BUFFER in vertices
+    ID3D11ShaderResourceView *line_view;
     
     ID3D11InputLayout *layout;
     ID3D11VertexShader *vertex_shader;
     ID3D11PixelShader *pixel_shader;
+    ID3D11PixelShader *sdf_pixel_shader;
+    
+    ID3D11InputLayout *marker_layout;
+    ID3D11VertexShader *marker_vertex_shader;
+    ID3D11PixelShader *marker_pixel_shader;
+    
+    ID3D11InputLayout *line_layout;
+    ID3D11VertexShader *line_vertex_shader;
+    ID3D11PixelShader *line_pixel_shader;
     
     ID3D11RasterizerState *rasterizer;
-    ID3D11BlendState *blend_state;
-    ID3D11SamplerState *sampler_state;
+    ID3D11RasterizerState *rasterizer_no_cull; // @Note: Sharp miters can fold a segment over
+    ID3D11BlendState *blend_state[R_BLEND_COUNT];
+    ID3D11SamplerState *sampler_state; // @Note: Point, for coverage text and everything else
+    ID3D11SamplerState *sdf_sampler_state; // @Note: Linear, for R_SAMPLE_SDF
     
     D3D11_Cbuffer cbuffer;
+    D3D11_Palette palette;
     
     Arena *arena;
     D3D11_Texture *first_free_texture;
     D3D11_Texture dummy_texture;
+    
+    D3D11_Target *first_free_target;
+    D3D11_Target *current_target;
 } D3D11_State;
 
 typedef struct {
@@ -0,0 +1,472 @@
+global Null_State null_state = {0};
+global b32 null_is_init = 0;
+
+internal b32 r_is_init(void)
+{
+    return(null_is_init);
+}
+
+internal b32 r_backend_init(void)
+{
+    b32 result = r_backend_init_ex(0);
+    return(result);
+}
+
+internal b32 r_backend_init_ex(b32 software)
+{
+    UNUSED(software);
+    
+    b32 error = 0;
+    if (null_is_init) {
+        er_push(str8("Null backend is already initialized"));
+        error = 1;
+    }
+    
+    if (!error) {
+        null_state.arena = arena_make();
+        for (u32 i = 0; i < R_MARKER_PALETTE_SIZE; ++i) {
+            null_state.palette[i] = 0xFFFFFFFF;
+        }
+        null_is_init = 1;
+    }
+    
+    b32 result = !error;
+    return(result);
+}
+
+internal void r_backend_end(void)
+{
+    for (Null_Target *target = null_state.first_free_target; target != 0; target = target->next) {
+        if (target->pixels_arena) arena_release(target->pixels_arena);
+    }
+    if (null_state.arena) arena_release(null_state.arena);
+    MemoryZero(&null_state, sizeof(Null_State));
+    null_is_init = 0;
+}
+
+internal b32 r_window_equip(GFX_Window *window)
+{
+    UNUSED(window);
+    
+    b32 result = r_is_init();
+    if (!result) {
+        er_push(str8("render backend not initialized"));
+    }
+    
+    return(result);
+}
+
+internal void r_window_unequip(GFX_Window *window)
+{
+    UNUSED(window);
+}
+
+internal void r_frame_begin(GFX_Window *window, u32 clear_color)
+{
+    UNUSED(window);
+    UNUSED(clear_color);
+    
+    if (!r_is_init()) {
+        er_push(str8("render backend not initialized"));
+    }
+}
+
+internal b32 r_submit_quads(GFX_Window *window, R_Quad_Node *draw_data, usize total_quad_count, R_Draw_State draw_state)
+{
+    OPTICK_EVENT();
+    
+    UNUSED(window);
+    UNUSED(draw_state);
+    
+    b32 error = 0;
+    if (!r_is_init()) {
+        er_push(str8("render backend not initialized"));
+        error = 1;
+    }
+    
+    if (!error) {
+        // @Note: Walk the nodes like a real backend would when copying, but only count.
+        usize count = 0;
+        for (R_Quad_Node *node = draw_data; node != 0; node = node->next) {
+            count += node->count;
+        }
+        Assert(count == total_quad_count);
+        
+        null_state.stats.quad_count += count;
+        null_state.stats.batch_count += 1;
+        null_state.stats.bytes += count*sizeof(R_Quad);
+    }
+    
+    b32 result = !error;
+    return(result);
+}
+
+internal b32 r_submit_markers(GFX_Window *window, R_Marker_Node *draw_data, usize total_marker_count, R_Draw_State draw_state)
+{
+    OPTICK_EVENT();
+    
+    UNUSED(window);
+    UNUSED(draw_state);
+    
+    b32 error = 0;
+    if (!r_is_init()) {
+        er_push(str8("render backend not initialized"));
+        error = 1;
+    }
+    
+    if (!error) {
+        usize count = 0;
+        for (R_Marker_Node *node = draw_data; node != 0; node = node->next) {
+            count += node->count;
+        }
+        Assert(count == total_marker_count);
+        
+        null_state.stats.marker_count += count;
+        null_state.stats.batch_count += 1;
+        null_state.stats.bytes += count*sizeof(R_Marker);
+    }
+    
+    b32 result = !error;
+    return(result);
+}
+
+internal b32 r_submit_lines(GFX_Window *window, R_Line_Node *draw_data, usize total_vertex_count, R_Draw_State draw_state)
+{
+    OPTICK_EVENT();
+    
+    UNUSED(window);
+    UNUSED(draw_state);
+    
+    b32 error = 0;
+    if (!r_is_init()) {
+        er_push(str8("render backend not initialized"));
+        error = 1;
+    }
+    
+    if (!error) {
+        usize count = 0;
+        for (R_Line_Node *node = draw_data; node != 0; node = node->next) {
+            count += node->count;
+        }
+        Assert(count == total_vertex_count);
+        
+        null_state.stats.line_vertex_count += count;
+        null_state.stats.batch_count += 1;
+        null_state.stats.bytes += count*sizeof(R_Line_Vertex);
+    }
+    
+    b32 result = !error;
+    return(result);
+}
+
+internal void r_marker_palette_set(u32 *colors, u32 count)
+{
+    if (!r_is_init()) {
+        er_push(str8("render backend not initialized"));
+    } else {
+        count = MIN(count, R_MARKER_PALETTE_SIZE);
+        MemoryCopy(null_state.palette, colors, count*sizeof(u32));
+    }
+}
+
+internal void r_frame_end(GFX_Window *window)
+{
+    UNUSED(window);
+    
+    if (!r_is_init()) {
+        er_push(str8("render backend not initialized"));
+    } else {
+        null_state.stats.frame_count += 1;
+    }
+}
+
+internal R_Target *r_target_create(u32 width, u32 height)
+{
+    b32 error = 0;
+    if (!r_is_init()) {
+        er_push(str8("render backend not initialized"));
+        error = 1;
+    }
+    
+    if (width == 0 || height == 0) {
+        er_push(str8("Render target has to have a non-zero size"));
+        error = 1;
+    }
+    
+    R_Target *result = 0;
+    if (!error) {
+        Null_Target *target = null_state.first_free_target;
+        if (target == 0) {
+            target = arena_push_array(null_state.arena, Null_Target, 1);
+        } else {
+            SLLStackPop(null_state.first_free_target);
+        }
+        
+        usize bytes = (usize) width*height*4;
+        if (target->pixels_cap < bytes) {
+            if (target->pixels_arena) arena_release(target->pixels_arena);
+            target->pixels_arena = arena_make_sized(MAX(ARENA_HEADER_SIZE + bytes, ARENA_DEFAULT_COMMIT), 0);
+            target->pixels = arena_push_array(target->pixels_arena, u8, bytes);
+            target->pixels_cap = bytes;
+        }
+        
+        target->next = 0;
+        target->width = width;
+        target->height = height;
+        result = (R_Target *) target;
+    }
+    
+    return(result);
+}
+
+internal b32 r_target_destroy(R_Target *target)
+{
+    b32 error = 0;
+    if (!r_is_init()) {
+        er_push(str8("render backend not initialized"));
+        error = 1;
+    }
+    
+    if (target == 0) {
+        er_push(str8("Provided target was null"));
+        error = 1;
+    }
+    
+    if (!error) {
+        Null_Target *null_target = (Null_Target *) target;
+        if (null_state.current_target == null_target) {
+            null_state.current_target = 0;
+        }
+        
+        SLLStackPush(null_state.first_free_target, null_target);
+    }
+    
+    b32 result = !error;
+    return(result);
+}
+
+internal b32 r_target_begin(R_Target *target, u32 clear_color)
+{
+    HMM_Vec2 offset = {0};
+    HMM_Vec2 canvas = {0};
+    b32 result = r_target_begin_ex(target, clear_color, offset, canvas);
+    return(result);
+}
+
+internal b32 r_target_begin_ex(R_Target *target, u32 clear_color, HMM_Vec2 offset, HMM_Vec2 canvas)
+{
+    UNUSED(offset);
+    
+    b32 error = 0;
+    if (!r_is_init()) {
+        er_push(str8("render backend not initialized"));
+        error = 1;
+    }
+    
+    if (target == 0) {
+        er_push(str8("Provided target was null"));
+        error = 1;
+    }
+    
+    if (canvas.X > R_TARGET_MAX_CANVAS || canvas.Y > R_TARGET_MAX_CANVAS) {
+        er_push(str8("Canvas is bigger than R_TARGET_MAX_CANVAS"));
+        error = 1;
+    }
+    
+    if (!error) {
+        Null_Target *null_target = (Null_Target *) target;
+        null_state.current_target = null_target;
+        
+        // @Note: Nothing is ever drawn here, but the clear is honoured so readback is well defined.
+        u8 rgba[4] = {
+            (u8) ((clear_color >> 8*3) & 0xFF),
+            (u8) ((clear_color >> 8*2) & 0xFF),
+            (u8) ((clear_color >> 8*1) & 0xFF),
+            (u8) ((clear_color >> 8*0) & 0xFF),
+        };
+        
+        usize pixel_count = (usize) null_target->width*null_target->height;
+        for (usize i = 0; i < pixel_count; ++i) {
+            MemoryCopy(null_target->pixels + i*4, rgba, 4);
+        }
+    }
+    
+    b32 result = !error;
+    return(result);
+}
+
+internal void r_target_end(R_Target *target)
+{
+    if (!r_is_init()) {
+        er_push(str8("render backend not initialized"));
+    } else {
+        if (null_state.current_target == (Null_Target *) target) {
+            null_state.current_target = 0;
+        }
+    }
+}
+
+internal u8 *r_target_read_pixels(R_Target *target)
+{
+    u8 *result = 0;
+    if (!r_is_init()) {
+        er_push(str8("render backend not initialized"));
+    } else if (target == 0) {
+        er_push(str8("Provided target was null"));
+    } else {
+        result = ((Null_Target *) target)->pixels;
+    }
+    
+    return(result);
+}
+
+internal void r_target_read_begin(R_Target *target)
+{
+    if (!r_is_init()) {
+        er_push(str8("render backend not initialized"));
+    } else if (target == 0) {
+        er_push(str8("Provided target was null"));
+    }
+}
+
+internal u8 *r_target_map(R_Target *target, u32 *pitch)
+{
+    u8 *result = r_target_map_ex(target, pitch, 0);
+    return(result);
+}
+
+internal u8 *r_target_map_ex(R_Target *target, u32 *pitch, b32 wait)
+{
+    UNUSED(wait);
+    
+    u8 *result = 0;
+    if (!r_is_init()) {
+        er_push(str8("render backend not initialized"));
+    } else if (target == 0) {
+        er_push(str8("Provided target was null"));
+    } else {
+        Null_Target *null_target = (Null_Target *) target;
+        result = null_target->pixels;
+        *pitch = null_target->width*4;
+    }
+    
+    return(result);
+}
+
+internal void r_target_unmap(R_Target *target)
+{
+    UNUSED(target);
+}
+
+internal R_Texture2D *r_texture_create(void *data, u32 width, u32 height)
+{
+    UNUSED(data);
+    
+    R_Texture2D *result = 0;
+    if (!r_is_init()) {
+        er_push(str8("render backend not initialized"));
+    } else {
+        Null_Texture *texture = null_state.first_free_texture;
+        if (texture == 0) {
+            texture = arena_push_array(null_state.arena, Null_Texture, 1);
+        } else {
+            SLLStackPop(null_state.first_free_texture);
+            MemoryZero(texture, sizeof(Null_Texture));
+        }
+        
+        texture->width = width;
+        texture->height = height;
+        result = (R_Texture2D *) texture;
+    }
+    
+    return(result);
+}
+
+internal b32 r_texture_destroy(R_Texture2D *texture)
+{
+    b32 error = 0;
+    if (!r_is_init()) {
+        er_push(str8("render backend not initialized"));
+        error = 1;
+    }
+    
+    if (texture == 0) {
+        er_push(str8("Provided texture was null"));
+        error = 1;
+    }
+    
+    if (!error) {
+        Null_Texture *null_texture = (Null_Texture *) texture;
+        SLLStackPush(null_state.first_free_texture, null_texture);
+    }
+    
+    b32 result = !error;
+    return(result);
+}
+
+internal b32 r_texture_update(R_Texture2D *texture, void *data, u32 width, u32 height)
+{
+    b32 result = r_texture_update_region(texture, data, 0, 0, width, height, sizeof(u32)*width);
+    return(result);
+}
+
+internal b32 r_texture_update_region(R_Texture2D *texture, void *data, u32 x, u32 y, u32 width, u32 height, u32 pitch)
+{
+    UNUSED(data);
+    UNUSED(pitch);
+    
+    b32 error = 0;
+    if (!r_is_init()) {
+        er_push(str8("render backend not initialized"));
+        error = 1;
+    }
+    
+    if (texture == 0) {
+        er_push(str8("Provided texture was null"));
+        error = 1;
+    }
+    
+    if (!error) {
+        Null_Texture *null_texture = (Null_Texture *) texture;
+        Assert(x + width <= null_texture->width && y + height <= null_texture->height);
+        
+        null_state.stats.upload_bytes += (u64) width*height*sizeof(u32);
+    }
+    
+    b32 result = !error;
+    return(result);
+}
+
+internal b32 r_texture_copy_region(R_Texture2D *dst, u32 dst_x, u32 dst_y, R_Texture2D *src, u32 src_x, u32 src_y, u32 width, u32 height)
+{
+    b32 error = 0;
+    if (!r_is_init()) {
+        er_push(str8("render backend not initialized"));
+        error = 1;
+    }
+    
+    if (dst == 0 || src == 0) {
+        er_push(str8("Provided texture was null"));
+        error = 1;
+    }
+    
+    if (!error) {
+        Null_Texture *null_dst = (Null_Texture *) dst;
+        Null_Texture *null_src = (Null_Texture *) src;
+        Assert(dst_x + width <= null_dst->width && dst_y + height <= null_dst->height);
+        Assert(src_x + width <= null_src->width && src_y + height <= null_src->height);
+    }
+    
+    b32 result = !error;
+    return(result);
+}
+
+internal Null_Stats r_null_stats_get(void)
+{
+    return(null_state.stats);
+}
+
+internal void r_null_stats_reset(void)
+{
+    MemoryZero(&null_state.stats, sizeof(Null_Stats));
+}
@@ -0,0 +1,49 @@
+#ifndef NULL_RENDER_IMPL_H
+#define NULL_RENDER_IMPL_H
+
+// @Note: Backend that doesn't talk to any GPU, it only counts what it was asked to draw.
+// Used for measuring CPU-side cost of the frame without driver time getting in the way.
+
+typedef struct {
+    u64 quad_count;
+    u64 marker_count;
+    u64 line_vertex_count;
+    u64 batch_count;
+    u64 bytes;
+    u64 upload_bytes; // @Note: Texture data sent through the update functions
+    u64 frame_count;
+} Null_Stats;
+
+typedef struct Null_Texture {
+    struct Null_Texture *next;
+    
+    u32 width;
+    u32 height;
+} Null_Texture;
+
+typedef struct Null_Target {
+    struct Null_Target *next;
+    
+    u32 width;
+    u32 height;
+    
+    Arena *pixels_arena; // @Note: Remade when the buffer has to grow
+    u8 *pixels;
+    usize pixels_cap;
+} Null_Target;
+
+typedef struct {
+    Arena *arena;
+    Null_Texture *first_free_texture;
+    Null_Target *first_free_target;
+    Null_Target *current_target;
+    
+    u32 palette[R_MARKER_PALETTE_SIZE];
+    
+    Null_Stats stats;
+} Null_State;
+
+internal Null_Stats r_null_stats_get(void);
+internal void r_null_stats_reset(void);
+
+#endif // NULL_RENDER_IMPL_H
@@ -2,6 +2,7 @@
 #define RENDER_H
 
 typedef void R_Texture2D;
+typedef void R_Target;
 
 // @Note: Used for templates
 typedef struct {
@@ -17,27 +18,144 @@ typedef struct {
     f32 theta;
 } R_Quad;
 
+// @Note: Compact instance for scatter markers, 12 bytes against the 44 of R_Quad.
+// Radius is stored as a half float, the color comes from the marker palette.
+#define R_MARKER_PALETTE_SIZE 256
+
+typedef enum {
+    R_MARKER_CIRCLE = 0,
+    R_MARKER_SQUARE,
+    R_MARKER_DIAMOND,
+    R_MARKER_SHAPE_COUNT,
+} R_Marker_Shape;
+
+typedef struct {
+    f32 x;
+    f32 y;
+    u16 radius;
+    u8 shape;
+    u8 palette;
+} R_Marker;
+
+// @Note: Polylines are spans of vertices expanded into segments by the backend. 'dist' is
+// the length of the line up to the vertex (only needed for dashes), a negative one breaks the line.
+typedef struct {
+    f32 x;
+    f32 y;
+    f32 dist;
+} R_Line_Vertex;
+
+typedef enum {
+    R_JOIN_MITER = 0,
+    R_JOIN_ROUND,
+} R_Join;
+
+// @Note: Dashes are on when both 'dash' and 'gap' are above zero, lengths are in pixels.
+typedef struct {
+    u32 col;
+    f32 width;
+    f32 dash;
+    f32 gap;
+    R_Join join;
+} R_Line_Style;
+
+typedef enum {
+    R_BLEND_ALPHA = 0,
+    R_BLEND_ADDITIVE,
+    R_BLEND_COUNT,
+} R_Blend;
+
+// @Note: How quads read their texture. SDF takes red as a distance field (0.5 on the edge,
+// growing inwards) and stays sharp at any scale, used for text from SDF font atlases.
+typedef enum {
+    R_SAMPLE_COLOR = 0,
+    R_SAMPLE_SDF,
+    R_SAMPLE_COUNT,
+} R_Sample;
+
+// @Note: Everything a backend needs to know about a submission besides the quads
+typedef struct {
+    R_Texture2D *texture;
+    R_Blend blend;
+    R_Sample sample; // @Note: Only for r_submit_quads
+    R_Line_Style line; // @Note: Only for r_submit_lines
+    
+    // @Note: Scissor in pixels of the output, nothing outside of it may be touched
+    b32 clipped;
+    RectF32 clip;
+} R_Draw_State;
+
 typedef struct R_Quad_Node {
     struct R_Quad_Node *next;
     
     R_Quad *quads;
     usize count;
+    usize cap;
 } R_Quad_Node;
 
+typedef struct R_Marker_Node {
+    struct R_Marker_Node *next;
+    
+    R_Marker *markers;
+    usize count;
+    usize cap;
+} R_Marker_Node;
+
+typedef struct R_Line_Node {
+    struct R_Line_Node *next;
+    
+    R_Line_Vertex *vertices;
+    usize count;
+    usize cap;
+} R_Line_Node;
+
 internal b32 r_is_init(void);
 internal b32 r_backend_init(void);
+internal b32 r_backend_init_ex(b32 software); // @Note: Skips the GPU where the backend has a software rasterizer
 internal void r_backend_end(void);
 internal b32 r_window_equip(GFX_Window *window);
 internal void r_window_unequip(GFX_Window *window);
 internal void r_frame_begin(GFX_Window *window, u32 clear_color);
 internal void r_frame_end(GFX_Window *window);
-internal b32 r_submit_quads(GFX_Window *window, R_Quad_Node *draw_data, usize total_quad_count, R_Texture2D *texture);
+internal b32 r_submit_quads(GFX_Window *window, R_Quad_Node *draw_data, usize total_quad_count, R_Draw_State draw_state);
+internal b32 r_submit_markers(GFX_Window *window, R_Marker_Node *draw_data, usize total_marker_count, R_Draw_State draw_state);
+internal b32 r_submit_lines(GFX_Window *window, R_Line_Node *draw_data, usize total_vertex_count, R_Draw_State draw_state);
+
+// @Note: Colors (0xRRGGBBAA) that R_Marker.palette indexes, entries past 'count' are left alone.
+internal void r_marker_palette_set(u32 *colors, u32 count);
+
+// @Note: Offscreen surfaces of arbitrary size, no window needed. Between r_target_begin/r_target_end
+// everything submitted with a null window is drawn into the target. Pixels returned from
+// r_target_read_pixels are RGBA rows owned by the target, valid until the next read or destroy.
+internal R_Target *r_target_create(u32 width, u32 height);
+internal b32 r_target_destroy(R_Target *target);
+internal b32 r_target_begin(R_Target *target, u32 clear_color);
+internal void r_target_end(R_Target *target);
+internal u8 *r_target_read_pixels(R_Target *target);
+
+// @Note: Draws a window of a canvas that can be bigger than the target. Everything is submitted in
+// canvas pixels and canvas point 'offset' lands on the top left of the target, so big pictures can be
+// drawn tile by tile. A zero 'canvas' is the target itself, which is what r_target_begin() does.
+#define R_TARGET_MAX_CANVAS 16384
+internal b32 r_target_begin_ex(R_Target *target, u32 clear_color, HMM_Vec2 offset, HMM_Vec2 canvas);
+
+// @Note: Readback without waiting on the GPU. r_target_read_begin() queues the copy, r_target_map()
+// returns 0 until it's done and then the RGBA rows ('pitch' bytes apart). Those stay valid and can
+// be read from any thread until r_target_unmap(), the target can't be drawn to or read in between.
+internal void r_target_read_begin(R_Target *target);
+internal u8 *r_target_map(R_Target *target, u32 *pitch);
+internal void r_target_unmap(R_Target *target);
 
-internal u8 *r_end_frame_get_backbuffer(GFX_Window *window, Arena *arena);
+// @Note: Same as r_target_map() but with 'wait' set it blocks until the copy is done instead of returning 0.
+internal u8 *r_target_map_ex(R_Target *target, u32 *pitch, b32 wait);
 
 // @ToDo: We're only allowing for textures in RGBA format for now
+// @Note: Null data creates a zeroed texture. In r_texture_update_region() rows of 'data' are 'pitch'
+// bytes apart, r_texture_copy_region() copies between textures without going through the CPU.
 internal R_Texture2D *r_texture_create(void *data, u32 width, u32 height);
 internal b32 r_texture_destroy(R_Texture2D *texture);
 internal b32 r_texture_update(R_Texture2D *texture, void *data, u32 width, u32 height);
+internal b32 r_texture_update_region(R_Texture2D *texture, void *data, u32 x, u32 y, u32 width, u32 height, u32 pitch);
+internal b32 r_texture_copy_region(R_Texture2D *dst, u32 dst_x, u32 dst_y, R_Texture2D *src, u32 src_x, u32 src_y, u32 width, u32 height);
 
 #endif // RENDER_H
@@ -0,0 +1,418 @@
+internal void r_skyline_init(R_Skyline *sky, R_Skyline_Node *nodes, u32 cap, u32 width, u32 height)
+{
+    Assert(cap > 0);
+    
+    MemoryZero(sky, sizeof(R_Skyline));
+    sky->nodes = nodes;
+    sky->cap = cap;
+    sky->width = width;
+    sky->height = height;
+    
+    r_skyline_reset(sky);
+}
+
+internal void r_skyline_reset(R_Skyline *sky)
+{
+    sky->nodes[0].x = 0;
+    sky->nodes[0].y = 0;
+    sky->nodes[0].width = sky->width;
+    sky->count = 1;
+    sky->used_area = 0;
+}
+
+internal b32 r_skyline_fit(R_Skyline *sky, u32 index, u32 width, u32 height, u32 *y)
+{
+    u32 x = sky->nodes[index].x;
+    if (x + width > sky->width) {
+        return(0);
+    }
+    
+    // @Note: Rect rests on the highest segment it spans, segments always cover the whole width.
+    u32 top = 0;
+    u32 left = width;
+    for (u32 i = index; left > 0; ++i) {
+        Assert(i < sky->count);
+        top = MAX(top, sky->nodes[i].y);
+        if (top + height > sky->height) {
+            return(0);
+        }
+        
+        left -= MIN(left, sky->nodes[i].width);
+    }
+    
+    *y = top;
+    return(1);
+}
+
+internal b32 r_skyline_find(R_Skyline *sky, u32 width, u32 height, u32 *index, u32 *y)
+{
+    // @Note: Placing might add one segment, so a full list can't take anything anymore.
+    if (sky->count >= sky->cap) {
+        return(0);
+    }
+    
+    b32 found = 0;
+    u32 best_top = 0;
+    u32 best_width = 0;
+    for (u32 i = 0; i < sky->count; ++i) {
+        u32 fit_y = 0;
+        if (r_skyline_fit(sky, i, width, height, &fit_y)) {
+            u32 top = fit_y + height;
+            if (!found || top < best_top || (top == best_top && sky->nodes[i].width < best_width)) {
+                *index = i;
+                *y = fit_y;
+                best_top = top;
+                best_width = sky->nodes[i].width;
+                found = 1;
+            }
+        }
+    }
+    
+    return(found);
+}
+
+internal void r_skyline_place(R_Skyline *sky, u32 index, u32 y, u32 width, u32 height)
+{
+    Assert(sky->count < sky->cap);
+    
+    R_Skyline_Node node = { sky->nodes[index].x, y + height, width };
+    MemoryCopy(sky->nodes + index + 1, sky->nodes + index, sizeof(R_Skyline_Node)*(sky->count - index));
+    sky->nodes[index] = node;
+    sky->count += 1;
+    
+    // @Note: Cut away whatever the new segment now covers
+    u32 end = node.x + node.width;
+    u32 i = index + 1;
+    while (i < sky->count && sky->nodes[i].x < end) {
+        R_Skyline_Node *next = sky->nodes + i;
+        u32 shrink = end - next->x;
+        if (next->width <= shrink) {
+            MemoryCopy(sky->nodes + i, sky->nodes + i + 1, sizeof(R_Skyline_Node)*(sky->count - i - 1));
+            sky->count -= 1;
+        } else {
+            next->x += shrink;
+            next->width -= shrink;
+            break;
+        }
+    }
+    
+    // @Note: Merge neighbours of equal height so the walk stays short
+    for (u32 j = 0; j + 1 < sky->count;) {
+        if (sky->nodes[j].y == sky->nodes[j + 1].y) {
+            sky->nodes[j].width += sky->nodes[j + 1].width;
+            MemoryCopy(sky->nodes + j + 1, sky->nodes + j + 2, sizeof(R_Skyline_Node)*(sky->count - j - 2));
+            sky->count -= 1;
+        } else {
+            ++j;
+        }
+    }
+    
+    sky->used_area += (u64) width*height;
+}
+
+internal b32 r_skyline_pack(R_Skyline *sky, u32 width, u32 height, u32 *x, u32 *y)
+{
+    u32 index = 0;
+    b32 found = r_skyline_find(sky, width, height, &index, y);
+    if (found) {
+        *x = sky->nodes[index].x;
+        r_skyline_place(sky, index, *y, width, height);
+    }
+    
+    return(found);
+}
+
+internal void r_skyline_grow(R_Skyline *sky, u32 width)
+{
+    Assert(width >= sky->width);
+    
+    if (width > sky->width) {
+        R_Skyline_Node *last = sky->nodes + sky->count - 1;
+        if (last->y == 0) {
+            last->width += width - sky->width;
+        } else if (sky->count < sky->cap) {
+            R_Skyline_Node node = { sky->width, 0, width - sky->width };
+            sky->nodes[sky->count++] = node;
+        } else {
+            // @Note: No room for another segment, the new space is simply lost to this skyline.
+            last->width += width - sky->width;
+        }
+        
+        sky->width = width;
+    }
+}
+
+internal u32 r_skyline_top(R_Skyline *sky)
+{
+    u32 result = 0;
+    for (u32 i = 0; i < sky->count; ++i) {
+        result = MAX(result, sky->nodes[i].y);
+    }
+    
+    return(result);
+}
+
+internal f32 r_skyline_efficiency(R_Skyline *sky)
+{
+    // @Note: Share of the area under the skyline that's actually taken by rects
+    u64 covered = (u64) sky->width*r_skyline_top(sky);
+    f32 result = covered ? (f32) ((f64) sky->used_area/(f64) covered) : 0.0f;
+    return(result);
+}
+
+internal R_Skyline *r_atlas_sky(R_Atlas *atlas, u32 page)
+{
+    R_Atlas_Page *p = atlas->pages + page;
+    p->sky.nodes = p->nodes;
+    return(&p->sky);
+}
+
+internal void r_atlas_page_add(R_Atlas *atlas)
+{
+    Assert(atlas->page_count < R_ATLAS_MAX_PAGES);
+    
+    R_Atlas_Page *page = atlas->pages + atlas->page_count;
+    MemoryZero(page, sizeof(R_Atlas_Page));
+    page->y = atlas->page_count*atlas->page_height;
+    r_skyline_init(&page->sky, page->nodes, R_ATLAS_MAX_SKYLINE, atlas->width, atlas->page_height);
+    
+    atlas->page_count += 1;
+}
+
+internal b32 r_atlas_init(R_Atlas *atlas, u32 width, u32 height, u32 max_size, R_Atlas_Evict_Func *evict, void *evict_user)
+{
+    MemoryZero(atlas, sizeof(R_Atlas));
+    
+    b32 error = 0;
+    if (width == 0 || height == 0 || width > max_size || height > max_size) {
+        er_push(str8("Atlas size has to be non-zero and within max_size"));
+        error = 1;
+    }
+    
+    if (!error) {
+        atlas->texture = r_texture_create(0, width, height);
+        if (atlas->texture == 0) {
+            er_push(str8("Failed to create atlas texture"));
+            error = 1;
+        }
+    }
+    
+    if (!error) {
+        atlas->width = width;
+        atlas->height = height;
+        atlas->max_size = max_size;
+        atlas->evict = evict;
+        atlas->evict_user = evict_user;
+        
+        u32 pages = MIN(R_ATLAS_INIT_PAGES, height);
+        atlas->page_height = height/pages;
+        for (u32 i = 0; i < pages; ++i) {
+            r_atlas_page_add(atlas);
+        }
+    }
+    
+    b32 result = !error;
+    return(result);
+}
+
+internal void r_atlas_retired_release(R_Atlas *atlas)
+{
+    for (u32 i = 0; i < atlas->retired_count; ++i) {
+        r_texture_destroy(atlas->retired[i]);
+    }
+    atlas->retired_count = 0;
+}
+
+internal void r_atlas_release(R_Atlas *atlas)
+{
+    if (atlas->texture) r_texture_destroy(atlas->texture);
+    r_atlas_retired_release(atlas);
+    MemoryZero(atlas, sizeof(R_Atlas));
+}
+
+internal b32 r_atlas_grow(R_Atlas *atlas)
+{
+    OPTICK_EVENT();
+    
+    b32 error = 0;
+    u32 width = atlas->width;
+    u32 height = atlas->height;
+    b32 more_pages = atlas->page_count < R_ATLAS_MAX_PAGES;
+    if (atlas->retired_count == R_ATLAS_MAX_RETIRED) {
+        error = 1;
+    } else if (width <= height && width < atlas->max_size) {
+        width = MIN(width*2, atlas->max_size);
+    } else if (height < atlas->max_size && more_pages) {
+        height = MIN(height*2, atlas->max_size);
+    } else if (width < atlas->max_size) {
+        width = MIN(width*2, atlas->max_size);
+    } else {
+        error = 1;
+    }
+    
+    R_Texture2D *texture = 0;
+    if (!error) {
+        texture = r_texture_create(0, width, height);
+        if (texture == 0) {
+            er_push(str8("Failed to create atlas texture"));
+            error = 1;
+        }
+    }
+    
+    // @Note: Old contents keep their pixel positions, pages simply get wider or there's more of them below.
+    // The old texture stays until the next frame, quads pushed this frame still point at it with its UVs.
+    if (!error) {
+        r_texture_copy_region(texture, 0, 0, atlas->texture, 0, 0, atlas->width, atlas->height);
+        atlas->retired[atlas->retired_count++] = atlas->texture;
+        
+        atlas->texture = texture;
+        atlas->width = width;
+        atlas->height = height;
+        
+        for (u32 i = 0; i < atlas->page_count; ++i) {
+            r_skyline_grow(r_atlas_sky(atlas, i), width);
+        }
+        
+        while (atlas->page_count < R_ATLAS_MAX_PAGES && (atlas->page_count + 1)*atlas->page_height <= height) {
+            r_atlas_page_add(atlas);
+        }
+    }
+    
+    b32 result = !error;
+    return(result);
+}
+
+internal b32 r_atlas_evict(R_Atlas *atlas, u32 *page)
+{
+    b32 found = 0;
+    u32 oldest = 0;
+    for (u32 i = 0; i < atlas->page_count; ++i) {
+        R_Atlas_Page *p = atlas->pages + i;
+        if (p->last_used < atlas->frame && !p->pinned) {
+            if (!found || p->last_used < atlas->pages[oldest].last_used) {
+                oldest = i;
+                found = 1;
+            }
+        }
+    }
+    
+    if (found) {
+        R_Atlas_Page *p = atlas->pages + oldest;
+        if (atlas->evict) {
+            R_Atlas_Region region = { 0, p->y, atlas->width, atlas->page_height, oldest };
+            atlas->evict(atlas->evict_user, region);
+        }
+        
+        // @Note: Stamped so that it's not picked again before it gets used
+        r_skyline_reset(r_atlas_sky(atlas, oldest));
+        p->last_used = atlas->frame;
+        *page = oldest;
+    }
+    
+    return(found);
+}
+
+internal b32 r_atlas_alloc(R_Atlas *atlas, u32 width, u32 height, R_Atlas_Region *region)
+{
+    OPTICK_EVENT();
+    
+    u32 w = width + R_ATLAS_PADDING;
+    u32 h = height + R_ATLAS_PADDING;
+    
+    b32 error = 0;
+    if (w > atlas->max_size || h > atlas->page_height) {
+        er_push(str8("Atlas allocation is bigger than an atlas page can ever be"));
+        error = 1;
+    }
+    
+    u32 page = 0;
+    u32 index = 0;
+    u32 y = 0;
+    b32 found = 0;
+    while (!error && !found) {
+        // @Note: First page that takes it, so long lived allocations made up front (and pinned)
+        // stay packed into the first few pages instead of spreading over all of them.
+        for (u32 i = 0; i < atlas->page_count && !found; ++i) {
+            if (r_skyline_find(r_atlas_sky(atlas, i), w, h, &index, &y)) {
+                page = i;
+                found = 1;
+            }
+        }
+        
+        if (!found && !r_atlas_grow(atlas)) {
+            if (r_atlas_evict(atlas, &page)) {
+                found = r_skyline_find(r_atlas_sky(atlas, page), w, h, &index, &y);
+                Assert(found);
+            } else {
+                er_push(str8("Atlas is full and nothing can be evicted"));
+                error = 1;
+            }
+        }
+    }
+    
+    if (!error) {
+        R_Atlas_Page *p = atlas->pages + page;
+        R_Skyline *sky = r_atlas_sky(atlas, page);
+        region->x = sky->nodes[index].x;
+        region->y = p->y + y;
+        region->width = width;
+        region->height = height;
+        region->page = page;
+        
+        r_skyline_place(sky, index, y, w, h);
+        p->last_used = atlas->frame;
+    }
+    
+    b32 result = !error;
+    return(result);
+}
+
+internal b32 r_atlas_upload(R_Atlas *atlas, R_Atlas_Region region, void *data, u32 pitch)
+{
+    b32 result = r_texture_update_region(atlas->texture, data, region.x, region.y, region.width, region.height, pitch);
+    return(result);
+}
+
+internal void r_atlas_touch(R_Atlas *atlas, R_Atlas_Region region)
+{
+    Assert(region.page < atlas->page_count);
+    atlas->pages[region.page].last_used = atlas->frame;
+}
+
+internal void r_atlas_pin(R_Atlas *atlas, R_Atlas_Region region)
+{
+    Assert(region.page < atlas->page_count);
+    atlas->pages[region.page].pinned = 1;
+}
+
+internal void r_atlas_next_frame(R_Atlas *atlas)
+{
+    r_atlas_retired_release(atlas);
+    atlas->frame += 1;
+}
+
+internal RectF32 r_atlas_uv(R_Atlas *atlas, R_Atlas_Region region)
+{
+    RectF32 result = {
+        (f32) region.x/(f32) atlas->width,
+        (f32) region.y/(f32) atlas->height,
+        (f32) (region.x + region.width)/(f32) atlas->width,
+        (f32) (region.y + region.height)/(f32) atlas->height,
+    };
+    
+    return(result);
+}
+
+internal f32 r_atlas_efficiency(R_Atlas *atlas)
+{
+    u64 used = 0;
+    u64 covered = 0;
+    for (u32 i = 0; i < atlas->page_count; ++i) {
+        R_Skyline *sky = r_atlas_sky(atlas, i);
+        used += sky->used_area;
+        covered += (u64) sky->width*r_skyline_top(sky);
+    }
+    
+    f32 result = covered ? (f32) ((f64) used/(f64) covered) : 0.0f;
+    return(result);
+}
@@ -0,0 +1,123 @@
+#ifndef RENDER_ATLAS_H
+#define RENDER_ATLAS_H
+
+// @Note: Skyline packer, the top edge of everything placed so far is kept as a list of
+// horizontal segments and a new rect goes where its top ends up the lowest (bottom-left).
+// Insertion walks the segments once, so it's O(width) at worst and never allocates,
+// segment storage is handed in by the caller.
+typedef struct {
+    u32 x;
+    u32 y;
+    u32 width;
+} R_Skyline_Node;
+
+typedef struct {
+    R_Skyline_Node *nodes;
+    u32 count;
+    u32 cap;
+    
+    u32 width;
+    u32 height;
+    u64 used_area;
+} R_Skyline;
+
+internal void r_skyline_init(R_Skyline *sky, R_Skyline_Node *nodes, u32 cap, u32 width, u32 height);
+internal void r_skyline_reset(R_Skyline *sky);
+internal b32 r_skyline_fit(R_Skyline *sky, u32 index, u32 width, u32 height, u32 *y);
+internal b32 r_skyline_find(R_Skyline *sky, u32 width, u32 height, u32 *index, u32 *y);
+internal void r_skyline_place(R_Skyline *sky, u32 index, u32 y, u32 width, u32 height);
+internal b32 r_skyline_pack(R_Skyline *sky, u32 width, u32 height, u32 *x, u32 *y);
+internal void r_skyline_grow(R_Skyline *sky, u32 width);
+internal u32 r_skyline_top(R_Skyline *sky);
+internal f32 r_skyline_efficiency(R_Skyline *sky);
+
+// @Note: Skyline packed atlas over one texture, meant to be shared by everything that wants
+// small sub-images (glyphs, marker sprites, heatmap tiles) so they end up in one draw call.
+// It's split into horizontal pages of equal height, each with its own skyline, pages are
+// what gets evicted. Regions are in pixels, UVs have to be taken with r_atlas_uv() together
+// with 'texture' when a quad is pushed, growing replaces the texture and changes what UVs are
+// relative to. Quads pushed before a grow keep drawing from the old texture, it's only destroyed
+// in r_atlas_next_frame(), which has to come after the frame's list is flushed. UVs kept around
+// across frames have to be taken again after a grow. Once it can't grow anymore the least
+// recently touched page is evicted and the callback is told about it.
+
+#ifndef R_ATLAS_MAX_PAGES
+# define R_ATLAS_MAX_PAGES 32
+#endif
+
+// @Note: Pages an atlas is split into at init, growing in height adds more of the same height.
+#ifndef R_ATLAS_INIT_PAGES
+# define R_ATLAS_INIT_PAGES 4
+#endif
+
+// @Note: Grows in one frame, after that it evicts until r_atlas_next_frame()
+#ifndef R_ATLAS_MAX_RETIRED
+# define R_ATLAS_MAX_RETIRED 4
+#endif
+
+#ifndef R_ATLAS_MAX_SKYLINE
+# define R_ATLAS_MAX_SKYLINE 64
+#endif
+
+// @Note: Gutter between allocations so that filtering never picks up a neighbour
+#ifndef R_ATLAS_PADDING
+# define R_ATLAS_PADDING 1
+#endif
+
+typedef struct {
+    u32 x;
+    u32 y;
+    u32 width;
+    u32 height;
+    u32 page;
+} R_Atlas_Region;
+
+// @Note: 'sky' keeps its segments in 'nodes' right next to it, get it through r_atlas_sky() which
+// points it there first. That way an R_Atlas (or a Font holding one) can be copied and returned by value.
+typedef struct {
+    u32 y;
+    R_Skyline sky;
+    R_Skyline_Node nodes[R_ATLAS_MAX_SKYLINE];
+    
+    u64 last_used;
+    b32 pinned; // @Note: Never evicted, see r_atlas_pin()
+} R_Atlas_Page;
+
+// @Note: 'region' covers the whole evicted page, everything allocated inside of it is gone.
+typedef void R_Atlas_Evict_Func(void *user, R_Atlas_Region region);
+
+typedef struct {
+    R_Texture2D *texture;
+    u32 width;
+    u32 height;
+    u32 max_size;
+    
+    R_Atlas_Page pages[R_ATLAS_MAX_PAGES];
+    u32 page_count;
+    u32 page_height;
+    
+    // @Note: Textures replaced by growing this frame, quads pushed earlier still draw from them
+    R_Texture2D *retired[R_ATLAS_MAX_RETIRED];
+    u32 retired_count;
+    
+    u64 frame;
+    R_Atlas_Evict_Func *evict;
+    void *evict_user;
+} R_Atlas;
+
+// @Note: Allocations are limited to height/R_ATLAS_INIT_PAGES of the initial height.
+internal b32 r_atlas_init(R_Atlas *atlas, u32 width, u32 height, u32 max_size, R_Atlas_Evict_Func *evict, void *evict_user);
+internal void r_atlas_release(R_Atlas *atlas);
+internal b32 r_atlas_alloc(R_Atlas *atlas, u32 width, u32 height, R_Atlas_Region *region);
+internal b32 r_atlas_upload(R_Atlas *atlas, R_Atlas_Region region, void *data, u32 pitch);
+internal void r_atlas_touch(R_Atlas *atlas, R_Atlas_Region region);
+internal void r_atlas_pin(R_Atlas *atlas, R_Atlas_Region region);
+internal void r_atlas_next_frame(R_Atlas *atlas);
+internal RectF32 r_atlas_uv(R_Atlas *atlas, R_Atlas_Region region);
+internal f32 r_atlas_efficiency(R_Atlas *atlas);
+internal R_Skyline *r_atlas_sky(R_Atlas *atlas, u32 page);
+
+internal b32 r_atlas_grow(R_Atlas *atlas);
+internal b32 r_atlas_evict(R_Atlas *atlas, u32 *page);
+
+#endif // RENDER_ATLAS_H
@@ -0,0 +1,278 @@
+global usize r_capture_stride[R_CMD_KIND_COUNT] = { sizeof(R_Quad), sizeof(R_Marker), sizeof(R_Line_Vertex) };
+
+internal b32 r_capture_begin(R_Capture *capture, String8 path)
+{
+    b32 error = 0;
+    if (capture->active) {
+        er_push(str8("Capture is already running"));
+        error = 1;
+    }
+    
+    if (!error) {
+        R_Capture_Header header = {0};
+        header.magic = R_CAPTURE_MAGIC;
+        header.version = R_CAPTURE_VERSION;
+        header.quad_size = sizeof(R_Quad);
+        header.marker_size = sizeof(R_Marker);
+        header.line_vertex_size = sizeof(R_Line_Vertex);
+        
+        if (!os_file_write(path, str8_make((u8 *) &header, sizeof(header)))) {
+            er_push(str8("Failed to create capture file"));
+            error = 1;
+        }
+    }
+    
+    if (!error) {
+        capture->arena = arena_make();
+        capture->path = str8_push_copy(capture->arena, path);
+        capture->frame_count = 0;
+        capture->active = 1;
+    }
+    
+    b32 result = !error;
+    return(result);
+}
+
+internal void r_capture_end(R_Capture *capture)
+{
+    if (capture->arena) arena_release(capture->arena);
+    MemoryZero(capture, sizeof(R_Capture));
+}
+
+internal b32 r_capture_frame(R_Capture *capture, R_List *list, HMM_Vec2 size, u32 clear_color)
+{
+    OPTICK_EVENT();
+    
+    b32 error = 0;
+    if (!capture->active) {
+        er_push(str8("Capture is not running"));
+        error = 1;
+    }
+    
+    if (!error) {
+        R_Capture_Frame frame = {0};
+        frame.magic = R_CAPTURE_FRAME_MAGIC;
+        frame.clear_color = clear_color;
+        frame.width = size.X;
+        frame.height = size.Y;
+        frame.texture_count = list->texture_count;
+        frame.line_style_count = list->line_style_count;
+        frame.clip_count = list->clip_count;
+        
+        usize bytes = list->texture_count*sizeof(u32);
+        bytes += list->line_style_count*sizeof(R_Line_Style);
+        bytes += list->clip_count*sizeof(RectF32);
+        for (R_Cmd *cmd = list->first; cmd != 0; cmd = cmd->next) {
+            if (cmd->count > 0) {
+                bytes += sizeof(R_Capture_Cmd) + cmd->count*r_capture_stride[r_key_kind(cmd->key)];
+                frame.cmd_count += 1;
+            }
+        }
+        bytes = ALIGN_POW2(bytes, 8);
+        frame.bytes = bytes;
+        
+        Arena_Temp temp = arena_temp_begin(capture->arena);
+        
+        usize total = sizeof(R_Capture_Frame) + bytes;
+        u8 *buffer = arena_push_array(temp.arena, u8, total);
+        u8 *at = buffer;
+        
+        MemoryCopy(at, &frame, sizeof(R_Capture_Frame));
+        at += sizeof(R_Capture_Frame);
+        
+        for (u32 i = 0; i < list->texture_count; ++i) {
+            u32 slot = (list->textures[i] == 0) ? 0 : 1;
+            MemoryCopy(at, &slot, sizeof(u32));
+            at += sizeof(u32);
+        }
+        
+        MemoryCopy(at, list->line_styles, list->line_style_count*sizeof(R_Line_Style));
+        at += list->line_style_count*sizeof(R_Line_Style);
+        
+        MemoryCopy(at, list->clips, list->clip_count*sizeof(RectF32));
+        at += list->clip_count*sizeof(RectF32);
+        
+        for (R_Cmd *cmd = list->first; cmd != 0; cmd = cmd->next) {
+            if (cmd->count > 0) {
+                R_Capture_Cmd header = { cmd->key, cmd->count };
+                MemoryCopy(at, &header, sizeof(R_Capture_Cmd));
+                at += sizeof(R_Capture_Cmd);
+                
+                usize cmd_bytes = cmd->count*r_capture_stride[r_key_kind(cmd->key)];
+                MemoryCopy(at, cmd->data, cmd_bytes);
+                at += cmd_bytes;
+            }
+        }
+        
+        if (!os_file_append(capture->path, str8_make(buffer, total))) {
+            er_push(str8("Failed to write capture frame"));
+            error = 1;
+        } else {
+            capture->frame_count += 1;
+        }
+        
+        arena_temp_end(&temp);
+    }
+    
+    b32 result = !error;
+    return(result);
+}
+
+internal b32 r_replay_open(R_Replay *replay, Arena *arena, String8 path)
+{
+    MemoryZero(replay, sizeof(R_Replay));
+    
+    b32 error = 0;
+    String8 data = os_file_read(arena, path);
+    if (data.size < sizeof(R_Capture_Header)) {
+        er_push(str8("Failed to read capture file"));
+        error = 1;
+    }
+    
+    if (!error) {
+        R_Capture_Header header = {0};
+        MemoryCopy(&header, data.data, sizeof(R_Capture_Header));
+        
+        if (header.magic != R_CAPTURE_MAGIC || header.version != R_CAPTURE_VERSION) {
+            er_push(str8("Not a capture file or unsupported version"));
+            error = 1;
+        } else if (header.quad_size != sizeof(R_Quad) ||
+                   header.marker_size != sizeof(R_Marker) ||
+                   header.line_vertex_size != sizeof(R_Line_Vertex)) {
+            er_push(str8("Capture was recorded with different element layouts"));
+            error = 1;
+        }
+    }
+    
+    if (!error) {
+        u32 white = 0xFFFFFFFF;
+        replay->placeholder = r_texture_create(&white, 1, 1);
+        replay->data = data;
+        replay->at = sizeof(R_Capture_Header);
+        
+        // @Note: Count the frames up front, it also validates the stream once
+        R_List list = {0};
+        R_Replay_Frame frame = {0};
+        Arena_Temp temp = arena_temp_begin(arena);
+        while (r_replay_next(replay, temp.arena, &list, &frame)) {
+            replay->frame_count += 1;
+            arena_temp_end(&temp);
+            temp = arena_temp_begin(arena);
+        }
+        arena_temp_end(&temp);
+        
+        r_replay_rewind(replay);
+    }
+    
+    b32 result = !error;
+    return(result);
+}
+
+internal void r_replay_close(R_Replay *replay)
+{
+    if (replay->placeholder) r_texture_destroy(replay->placeholder);
+    MemoryZero(replay, sizeof(R_Replay));
+}
+
+internal void r_replay_rewind(R_Replay *replay)
+{
+    replay->at = sizeof(R_Capture_Header);
+}
+
+internal b32 r_replay_next(R_Replay *replay, Arena *arena, R_List *list, R_Replay_Frame *frame)
+{
+    MemoryZero(list, sizeof(R_List));
+    list->arena = arena;
+    
+    b32 error = 0;
+    u8 *start = replay->data.data + replay->at;
+    u8 *end = replay->data.data + replay->data.size;
+    
+    R_Capture_Frame header = {0};
+    if ((usize) (end - start) < sizeof(R_Capture_Frame)) {
+        error = 1; // @Note: Regular end of the stream
+    } else {
+        MemoryCopy(&header, start, sizeof(R_Capture_Frame));
+        
+        // @Note: The tables are read before any command, they have to fit inside the frame too.
+        u64 table_bytes = (u64) header.texture_count*sizeof(u32) +
+                          (u64) header.line_style_count*sizeof(R_Line_Style) +
+                          (u64) header.clip_count*sizeof(RectF32);
+        if (header.magic != R_CAPTURE_FRAME_MAGIC ||
+            header.bytes > (u64) (end - start) - sizeof(R_Capture_Frame) ||
+            header.texture_count > R_MAX_LIST_TEXTURES ||
+            header.line_style_count > R_MAX_LIST_LINE_STYLES ||
+            header.clip_count > R_MAX_LIST_CLIPS ||
+            table_bytes > header.bytes) {
+            er_push(str8("Corrupted capture frame"));
+            error = 1;
+        }
+    }
+    
+    if (!error) {
+        u8 *at = start + sizeof(R_Capture_Frame);
+        u8 *frame_end = at + header.bytes;
+        
+        for (u32 i = 0; i < header.texture_count; ++i) {
+            u32 slot = 0;
+            MemoryCopy(&slot, at, sizeof(u32));
+            at += sizeof(u32);
+            
+            list->textures[i] = (slot == 0) ? 0 : replay->placeholder;
+        }
+        list->texture_count = header.texture_count;
+        
+        MemoryCopy(list->line_styles, at, header.line_style_count*sizeof(R_Line_Style));
+        list->line_style_count = header.line_style_count;
+        at += header.line_style_count*sizeof(R_Line_Style);
+        
+        MemoryCopy(list->clips, at, header.clip_count*sizeof(RectF32));
+        list->clip_count = header.clip_count;
+        at += header.clip_count*sizeof(RectF32);
+        
+        // @Note: Commands point straight into the stream, nothing gets copied
+        for (u32 i = 0; i < header.cmd_count && !error; ++i) {
+            R_Capture_Cmd cmd_header = {0};
+            if ((usize) (frame_end - at) < sizeof(R_Capture_Cmd)) {
+                error = 1;
+            } else {
+                MemoryCopy(&cmd_header, at, sizeof(R_Capture_Cmd));
+                at += sizeof(R_Capture_Cmd);
+                
+                // @Note: Every table index inside of the key has to be in range, flushing trusts them
+                u64 key = cmd_header.key;
+                u64 kind = r_key_kind(key);
+                if (kind >= R_CMD_KIND_COUNT ||
+                    r_key_texture(key) >= header.texture_count ||
+                    r_key_clip(key) > header.clip_count ||
+                    (kind == R_CMD_LINES && r_key_param(key) >= header.line_style_count) ||
+                    cmd_header.count > (u64) (frame_end - at)/r_capture_stride[kind]) {
+                    error = 1;
+                }
+            }
+            
+            if (error) {
+                er_push(str8("Corrupted capture command"));
+            } else {
+                R_Cmd *cmd = arena_push_array(arena, R_Cmd, 1);
+                cmd->key = cmd_header.key;
+                cmd->data = at;
+                cmd->count = (usize) cmd_header.count;
+                at += cmd->count*r_capture_stride[r_key_kind(cmd->key)];
+                
+                SLLQueuePush(list->first, list->last, cmd);
+                list->count += 1;
+            }
+        }
+    }
+    
+    if (!error) {
+        frame->width = header.width;
+        frame->height = header.height;
+        frame->clear_color = header.clear_color;
+        replay->at += sizeof(R_Capture_Frame) + header.bytes;
+    }
+    
+    b32 result = !error;
+    return(result);
+}
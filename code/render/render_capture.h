@@ -0,0 +1,78 @@
+#ifndef RENDER_CAPTURE_H
+#define RENDER_CAPTURE_H
+
+// @Note: Binary recording of what frames submitted, so a slow frame can be replayed later
+// on any backend. A stream is an R_Capture_Header followed by frames, each frame is:
+//
+// | R_Capture_Frame | texture slots u32[texture_count] | R_Line_Style[line_style_count] |
+// | RectF32[clip_count] | commands: (R_Capture_Cmd, elements)[cmd_count] | padding to 8 |
+//
+// Texture contents aren't recorded, only which slots were null. On replay every other slot
+// is bound to a placeholder texture, which keeps the workload the same minus sampling.
+// Everything is little-endian and in the in-memory layout of the types.
+
+#define R_CAPTURE_MAGIC 0x50414352u // @Note: 'RCAP'
+#define R_CAPTURE_FRAME_MAGIC 0x4D415246u // @Note: 'FRAM'
+#define R_CAPTURE_VERSION 1
+
+typedef struct {
+    u32 magic;
+    u32 version;
+    u32 quad_size;
+    u32 marker_size;
+    u32 line_vertex_size;
+    u32 reserved;
+} R_Capture_Header;
+
+typedef struct {
+    u32 magic;
+    u32 clear_color;
+    f32 width;
+    f32 height;
+    
+    u32 texture_count;
+    u32 line_style_count;
+    u32 clip_count;
+    u32 cmd_count;
+    
+    u64 bytes; // @Note: Size of everything after this struct up to the next frame
+} R_Capture_Frame;
+
+typedef struct {
+    u64 key;
+    u64 count;
+} R_Capture_Cmd;
+
+typedef struct {
+    Arena *arena;
+    String8 path;
+    u32 frame_count;
+    b32 active;
+} R_Capture;
+
+typedef struct {
+    String8 data;
+    usize at;
+    u32 frame_count;
+    
+    R_Texture2D *placeholder;
+} R_Replay;
+
+typedef struct {
+    f32 width;
+    f32 height;
+    u32 clear_color;
+} R_Replay_Frame;
+
+internal b32 r_capture_begin(R_Capture *capture, String8 path);
+internal void r_capture_end(R_Capture *capture);
+internal b32 r_capture_frame(R_Capture *capture, R_List *list, HMM_Vec2 size, u32 clear_color);
+
+// @Note: The whole stream is loaded into 'arena'. Lists filled by r_replay_next() point
+// into the stream, so they stay valid until the arena is cleared.
+internal b32 r_replay_open(R_Replay *replay, Arena *arena, String8 path);
+internal void r_replay_close(R_Replay *replay);
+internal void r_replay_rewind(R_Replay *replay);
+internal b32 r_replay_next(R_Replay *replay, Arena *arena, R_List *list, R_Replay_Frame *frame);
+
+#endif // RENDER_CAPTURE_H
@@ -9,7 +9,11 @@
 # define R_BACKEND_D3D11 0
 #endif
 
-#define R_BACKEND_MIX (AS_BOOL(R_BACKEND_OPENGL) + AS_BOOL(R_BACKEND_D3D11))
+#ifndef R_BACKEND_NULL
+# define R_BACKEND_NULL 0
+#endif
+
+#define R_BACKEND_MIX (AS_BOOL(R_BACKEND_OPENGL) + AS_BOOL(R_BACKEND_D3D11) + AS_BOOL(R_BACKEND_NULL))
 
 #if R_BACKEND_MIX == 0
 # error no backend selected, please #define R_BACKEND_XXX 1
@@ -23,6 +27,9 @@
 # if R_BACKEND_OPENGL
 #  error d3d11 backend selected
 # endif
+# if R_BACKEND_NULL
+#  error null backend selected
+# endif
 #endif
 
 #endif // RENDER_CONTEXT_H
@@ -1,32 +1,156 @@
-internal R_Ctx r_make_context(Arena *arena, R_List *list)
+global R_Solid r_solid = { 0, { 0.0f, 0.0f, 1.0f, 1.0f } };
+
+internal R_Ctx r_make_context(Arena *arena, R_List *list, u32 layer)
 {
+    Assert(layer < R_LAYER_COUNT);
+    
     R_Ctx result = {0};
     result.arena = arena;
     result.list = list;
+    result.layer = layer;
+    result.blend = R_BLEND_ALPHA;
     return(result);
 }
 
-internal void r_new_batch(Arena *arena, R_List *list)
+internal u32 r_list_texture_id(R_List *list, R_Texture2D *texture)
 {
-    R_Quad_Batch *batch = arena_push_array(arena, R_Quad_Batch, 1);
-    SLLQueuePush(list->first, list->last, batch);
-    list->count += 1;
+    // @Note: There's only a handful of textures per frame, linear search is fine.
+    u32 result = 0;
+    for (; result < list->texture_count; ++result) {
+        if (list->textures[result] == texture) {
+            break;
+        }
+    }
+    
+    // @Note: A full table draws with the first texture instead of writing past it.
+    if (result == list->texture_count) {
+        if (list->texture_count < R_MAX_LIST_TEXTURES) {
+            list->textures[list->texture_count++] = texture;
+        } else {
+            er_push(str8("Too many textures in one render list"));
+            result = 0;
+        }
+    }
+    
+    return(result);
 }
 
-internal void r_prep_batch(Arena *arena, R_List *list, R_Texture2D *texture)
+internal u32 r_list_line_style_id(R_List *list, R_Line_Style *style)
 {
-    if (list->first == 0) {
-        r_new_batch(arena, list);
-    } else {
-        if (list->last->texture != texture) {
-            r_new_batch(arena, list);
+    u32 result = 0;
+    for (; result < list->line_style_count; ++result) {
+        if (MemoryMatch(list->line_styles + result, style, sizeof(R_Line_Style))) {
+            break;
+        }
+    }
+    
+    if (result == list->line_style_count) {
+        if (list->line_style_count < R_MAX_LIST_LINE_STYLES) {
+            list->line_styles[list->line_style_count++] = *style;
+        } else {
+            er_push(str8("Too many line styles in one render list"));
+            result = 0;
         }
     }
     
-    list->last->texture = texture;
+    return(result);
+}
+
+internal u32 r_list_clip_id(R_List *list, RectF32 *rect)
+{
+    u32 index = 0;
+    for (; index < list->clip_count; ++index) {
+        if (MemoryMatch(list->clips + index, rect, sizeof(RectF32))) {
+            break;
+        }
+    }
+    
+    // @Note: Out of clips it's drawn unclipped, still culled up front by the context's rect.
+    u32 result = index + 1;
+    if (index == list->clip_count) {
+        if (list->clip_count < R_MAX_LIST_CLIPS) {
+            list->clips[list->clip_count++] = *rect;
+        } else {
+            er_push(str8("Too many clip rects in one render list"));
+            result = 0;
+        }
+    }
+    
+    return(result);
+}
+
+internal b32 r_ctx_clip_rejects(R_Ctx *ctx, RectF32 bounds)
+{
+    b32 result = 0;
+    if (ctx->clip_depth > 0) {
+        result = (bounds.x1 < ctx->clip.x0 || bounds.x0 > ctx->clip.x1 ||
+                  bounds.y1 < ctx->clip.y0 || bounds.y0 > ctx->clip.y1);
+    }
+    
+    return(result);
+}
+
+internal u64 r_ctx_key(R_Ctx *ctx, R_Texture2D *texture, R_Cmd_Kind kind, u32 param)
+{
+    u32 texture_id = r_list_texture_id(ctx->list, texture);
+    u32 clip_id = ctx->clip_depth > 0 ? ctx->clip_stack[ctx->clip_depth - 1] : 0;
+    u64 result = r_key_make(ctx->layer, clip_id, ctx->blend, texture_id, kind, param);
+    return(result);
+}
+
+global usize r_cmd_stride[R_CMD_KIND_COUNT] = { sizeof(R_Quad), sizeof(R_Marker), sizeof(R_Line_Vertex) };
+global usize r_cmd_chunk_cap[R_CMD_KIND_COUNT] = { R_MAX_QUAD_CHUNK, R_MAX_MARKER_CHUNK, R_MAX_LINE_CHUNK };
+
+internal void *r_prep_cmd(R_Ctx *ctx, R_Cmd_Kind kind, R_Texture2D *texture, u32 param, usize count)
+{
+    R_List *list = ctx->list;
+    if (list->arena == 0) {
+        list->arena = ctx->arena;
+    }
+    
+    usize stride = r_cmd_stride[kind];
+    R_Chunk *chunk = list->chunks + kind;
+    if (chunk->data == 0 || (chunk->cap - chunk->count) < count) {
+        chunk->cap = MAX(count, r_cmd_chunk_cap[kind]);
+        chunk->data = (u8 *) arena_push_no_zero(list->arena, stride*chunk->cap);
+        chunk->count = 0;
+    }
+    
+    u64 key = r_ctx_key(ctx, texture, kind, param);
+    void *result = chunk->data + chunk->count*stride;
+    
+    // @Note: Keep growing the last command while nothing else was pushed in between.
+    R_Cmd *cmd = list->last;
+    if (cmd == 0 || cmd->key != key || ((u8 *) cmd->data + cmd->count*stride) != result) {
+        cmd = arena_push_array(list->arena, R_Cmd, 1);
+        cmd->key = key;
+        cmd->data = result;
+        cmd->count = 0;
+        
+        SLLQueuePush(list->first, list->last, cmd);
+        list->count += 1;
+    }
+    
+    return(result);
 }
 
-internal void r_push_quad(Arena *arena, R_Quad_Batch *batch, R_Quad *quad)
+internal void r_commit_cmd(R_Ctx *ctx, R_Cmd_Kind kind, usize count)
+{
+    R_List *list = ctx->list;
+    R_Chunk *chunk = list->chunks + kind;
+    Assert(list->last != 0 && r_key_kind(list->last->key) == (u64) kind);
+    Assert(chunk->count + count <= chunk->cap);
+    
+    list->last->count += count;
+    chunk->count += count;
+}
+
+internal void r_push_quad(R_Ctx *ctx, R_Texture2D *texture, R_Quad *quad)
+{
+    r_push_quad_ex(ctx, texture, quad, R_SAMPLE_COLOR);
+}
+
+internal void r_push_quad_ex(R_Ctx *ctx, R_Texture2D *texture, R_Quad *quad, R_Sample sample)
 {
     if (quad->pos.x0 > quad->pos.x1) {
         SWAP(quad->pos.x0, quad->pos.x1, f32);
@@ -36,44 +160,202 @@ internal void r_push_quad(Arena *arena, R_Quad_Batch *batch, R_Quad *quad)
         SWAP(quad->pos.y0, quad->pos.y1, f32);
     }
     
-    if (batch->first == 0) {
-        R_Quad_Node *node = arena_push_array(arena, R_Quad_Node, 1);
-        SLLQueuePush(batch->first, batch->last, node);
-        batch->count += 1;
+    if (ctx->clip_depth > 0) {
+        // @Note: Rotated quads get the circle around them, plus room for the smooth edge.
+        f32 pad = 2.0f;
+        RectF32 bounds = { quad->pos.x0 - pad, quad->pos.y0 - pad, quad->pos.x1 + pad, quad->pos.y1 + pad };
+        if (quad->theta != 0.0f) {
+            f32 hw = (quad->pos.x1 - quad->pos.x0)*.5f;
+            f32 hh = (quad->pos.y1 - quad->pos.y0)*.5f;
+            f32 cx = quad->pos.x0 + hw;
+            f32 cy = quad->pos.y0 + hh;
+            f32 r = HMM_SqrtF(hw*hw + hh*hh) + pad;
+            bounds = { cx - r, cy - r, cx + r, cy + r };
+        }
+        
+        if (r_ctx_clip_rejects(ctx, bounds)) {
+            return;
+        }
+    }
+    
+    R_Quad *slot = (R_Quad *) r_prep_cmd(ctx, R_CMD_QUADS, texture, sample, 1);
+    MemoryCopyStruct(slot, quad);
+    
+    r_commit_cmd(ctx, R_CMD_QUADS, 1);
+}
+
+internal R_Quad *r_quads_reserve(R_Ctx *ctx, R_Texture2D *texture, usize count)
+{
+    return(r_quads_reserve_ex(ctx, texture, count, R_SAMPLE_COLOR));
+}
+
+internal R_Quad *r_quads_reserve_ex(R_Ctx *ctx, R_Texture2D *texture, usize count, R_Sample sample)
+{
+    R_Quad *result = (R_Quad *) r_prep_cmd(ctx, R_CMD_QUADS, texture, sample, count);
+    return(result);
+}
+
+internal void r_quads_commit(R_Ctx *ctx, usize count)
+{
+    r_commit_cmd(ctx, R_CMD_QUADS, count);
+}
+
+internal R_Marker *r_markers_reserve(R_Ctx *ctx, usize count)
+{
+    // @Note: Markers don't sample anything, texture slot stays null for every one of them
+    R_Marker *result = (R_Marker *) r_prep_cmd(ctx, R_CMD_MARKERS, 0, 0, count);
+    return(result);
+}
+
+internal void r_markers_commit(R_Ctx *ctx, usize count)
+{
+    r_commit_cmd(ctx, R_CMD_MARKERS, count);
+}
+
+// @Note: Round-to-nearest-even, overflow goes to infinity and denormals get flushed to zero,
+// which is more than enough for sizes in pixels.
+internal u16 r_f16_from_f32(f32 value)
+{
+    u32 bits = 0;
+    MemoryCopy(&bits, &value, sizeof(u32));
+    
+    u32 sign = (bits >> 16) & 0x8000;
+    s32 exponent = (s32) ((bits >> 23) & 0xFF) - 127 + 15;
+    u32 mantissa = bits & 0x007FFFFF;
+    
+    u16 result = 0;
+    if (((bits >> 23) & 0xFF) == 0xFF) {
+        result = (u16) (sign | 0x7C00 | (mantissa ? 0x200 : 0));
+    } else if (exponent >= 0x1F) {
+        result = (u16) (sign | 0x7C00);
+    } else if (exponent <= 0) {
+        result = (u16) sign;
+    } else {
+        u32 half = ((u32) exponent << 10) | (mantissa >> 13);
+        u32 rest = mantissa & 0x1FFF;
+        if (rest > 0x1000 || (rest == 0x1000 && (half & 1))) {
+            half += 1; // @Note: Carry into the exponent is the correct rounding
+        }
+        result = (u16) (sign | half);
+    }
+    
+    return(result);
+}
+
+// @Note: Inverse of the above for what it produces, denormals come back as zero.
+internal f32 r_f32_from_f16(u16 value)
+{
+    u32 sign = ((u32) value & 0x8000) << 16;
+    u32 exponent = ((u32) value >> 10) & 0x1F;
+    u32 mantissa = (u32) value & 0x3FF;
+    
+    u32 bits = sign;
+    if (exponent == 0x1F) {
+        bits |= 0x7F800000 | (mantissa << 13);
+    } else if (exponent != 0) {
+        bits |= ((exponent - 15 + 127) << 23) | (mantissa << 13);
+    }
+    
+    f32 result = 0.0f;
+    MemoryCopy(&result, &bits, sizeof(u32));
+    return(result);
+}
+
+// @Note: Stable counting sort over the layer byte only, in one pass. Sorting by the state below
+// it would reorder what overlaps inside a layer (a line pushed under its markers would end up on
+// top of them). When everything is in one layer the list is handed back as it is.
+internal R_Cmd **r_sort_cmds(Arena *arena, R_Cmd **cmds, usize count)
+{
+    OPTICK_EVENT();
+    
+    R_Cmd **result = cmds;
+    if (count > 1) {
+        usize hist[R_KEY_LAYER_MASK + 1] = {0};
+        for (usize i = 0; i < count; ++i) {
+            hist[r_key_layer(cmds[i]->key)] += 1;
+        }
+        
+        if (hist[r_key_layer(cmds[0]->key)] != count) {
+            usize offset = 0;
+            for (u32 i = 0; i <= R_KEY_LAYER_MASK; ++i) {
+                usize c = hist[i];
+                hist[i] = offset;
+                offset += c;
+            }
+            
+            result = arena_push_array(arena, R_Cmd *, count);
+            for (usize i = 0; i < count; ++i) {
+                R_Cmd *cmd = cmds[i];
+                result[hist[r_key_layer(cmd->key)]++] = cmd;
+            }
+        }
     }
     
-    R_Quad_Node *last_node = batch->last;
-    if (last_node->count >= R_MAX_QUAD_CHUNK) {
-        R_Quad_Node *node = arena_push_array(arena, R_Quad_Node, 1);
-        SLLQueuePush(batch->first, batch->last, node);
-        batch->count += 1;
-        last_node = node;
+    return(result);
+}
+
+internal void r_push_clip(R_Ctx *ctx, RectF32 rect)
+{
+    Assert(ctx->clip_depth < R_MAX_CLIP_DEPTH);
+    
+    if (rect.x0 > rect.x1) {
+        SWAP(rect.x0, rect.x1, f32);
     }
     
-    if (last_node->quads == 0) {
-        last_node->quads = arena_push_array(arena, R_Quad, R_MAX_QUAD_CHUNK);
-        last_node->count = 0;
+    if (rect.y0 > rect.y1) {
+        SWAP(rect.y0, rect.y1, f32);
     }
     
-    R_Quad *slot = last_node->quads + last_node->count;
-    MemoryCopyStruct(slot, quad);
+    if (ctx->clip_depth > 0) {
+        rect.x0 = MAX(rect.x0, ctx->clip.x0);
+        rect.y0 = MAX(rect.y0, ctx->clip.y0);
+        rect.x1 = MIN(rect.x1, ctx->clip.x1);
+        rect.y1 = MIN(rect.y1, ctx->clip.y1);
+        
+        // @Note: No overlap, keep it empty instead of inside-out
+        rect.x1 = MAX(rect.x0, rect.x1);
+        rect.y1 = MAX(rect.y0, rect.y1);
+    }
     
-    last_node->count += 1;
-    batch->total_quad_count += 1;
+    ctx->clip_stack[ctx->clip_depth] = r_list_clip_id(ctx->list, &rect);
+    ctx->clip_rects[ctx->clip_depth] = rect;
+    ctx->clip_depth += 1;
+    ctx->clip = rect;
 }
 
-internal void r_rect_ex(R_Ctx *ctx, RectF32 pos, u32 col, f32 radius, f32 theta)
+internal void r_pop_clip(R_Ctx *ctx)
 {
-    r_prep_batch(ctx->arena, ctx->list, 0);
+    Assert(ctx->clip_depth > 0);
     
+    ctx->clip_depth -= 1;
+    if (ctx->clip_depth > 0) {
+        ctx->clip = ctx->clip_rects[ctx->clip_depth - 1];
+    } else {
+        MemoryZero(&ctx->clip, sizeof(RectF32));
+    }
+}
+
+internal void r_solid_set(R_Texture2D *texture, RectF32 uv)
+{
+    r_solid.texture = texture;
+    r_solid.uv = uv;
+}
+
+internal R_Solid r_solid_get(void)
+{
+    return(r_solid);
+}
+
+internal void r_rect_ex(R_Ctx *ctx, RectF32 pos, u32 col, f32 radius, f32 theta)
+{
     R_Quad quad = {0};
     quad.pos = pos;
     quad.col = col;
     quad.radius = radius;
     quad.theta = theta;
-    quad.uv = { 0.0f, 0.0f, 1.0f, 1.0f };
+    quad.uv = r_solid.uv;
     
-    r_push_quad(ctx->arena, ctx->list->last, &quad);
+    r_push_quad(ctx, r_solid.texture, &quad);
 }
 
 internal void r_rect(R_Ctx *ctx, RectF32 pos, u32 col, f32 radius)
@@ -92,10 +374,270 @@ internal void r_circ(R_Ctx *ctx, HMM_Vec2 pos, u32 col, f32 radius)
     r_rect_ex(ctx, offset_pos, col, radius, 0.0f);
 }
 
-internal void r_rect_tex_ex(R_Ctx *ctx, RectF32 pos, u32 tint, f32 radius, f32 theta, RectF32 uv, R_Texture2D *texture)
+internal void r_circs_from_xy(R_Ctx *ctx, f32 *xs, f32 *ys, usize count, HMM_Vec2 origin, HMM_Vec2 scale, u32 col, f32 radius)
+{
+    OPTICK_EVENT();
+    
+    Assert(radius >= 0.0f);
+    
+    R_Quad *quads = r_quads_reserve(ctx, r_solid.texture, count);
+    
+    // @Note: Four points at a time, the 4x4 transpose turns (x0s, y0s, x1s, y1s) into
+    // one RectF32 per point which is exactly the first 16 bytes of R_Quad.
+    __m128 ox = _mm_set1_ps(origin.X);
+    __m128 oy = _mm_set1_ps(origin.Y);
+    __m128 sx = _mm_set1_ps(scale.X);
+    __m128 sy = _mm_set1_ps(scale.Y);
+    __m128 r = _mm_set1_ps(radius);
+    __m128 uv = _mm_loadu_ps(&r_solid.uv.x0);
+    
+    // @Note: With a clip, centres are tested against the clip grown by the radius and the smooth
+    // edge. Whole groups that pass keep the fast path, the rest are written one by one.
+    b32 clipped = ctx->clip_depth > 0;
+    f32 pad = radius + 2.0f;
+    RectF32 bounds = { ctx->clip.x0 - pad, ctx->clip.y0 - pad, ctx->clip.x1 + pad, ctx->clip.y1 + pad };
+    __m128 bx0 = _mm_set1_ps(bounds.x0);
+    __m128 by0 = _mm_set1_ps(bounds.y0);
+    __m128 bx1 = _mm_set1_ps(bounds.x1);
+    __m128 by1 = _mm_set1_ps(bounds.y1);
+    
+    usize written = 0;
+    usize i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 px = _mm_add_ps(ox, _mm_mul_ps(_mm_loadu_ps(xs + i), sx));
+        __m128 py = _mm_add_ps(oy, _mm_mul_ps(_mm_loadu_ps(ys + i), sy));
+        
+        s32 mask = 0xF;
+        if (clipped) {
+            __m128 in_x = _mm_and_ps(_mm_cmpge_ps(px, bx0), _mm_cmple_ps(px, bx1));
+            __m128 in_y = _mm_and_ps(_mm_cmpge_ps(py, by0), _mm_cmple_ps(py, by1));
+            mask = _mm_movemask_ps(_mm_and_ps(in_x, in_y));
+        }
+        
+        if (mask == 0xF) {
+            __m128 r0 = _mm_sub_ps(px, r);
+            __m128 r1 = _mm_sub_ps(py, r);
+            __m128 r2 = _mm_add_ps(px, r);
+            __m128 r3 = _mm_add_ps(py, r);
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            
+            R_Quad *q = quads + written;
+            _mm_storeu_ps(&q[0].pos.x0, r0);
+            _mm_storeu_ps(&q[1].pos.x0, r1);
+            _mm_storeu_ps(&q[2].pos.x0, r2);
+            _mm_storeu_ps(&q[3].pos.x0, r3);
+            
+            for (u32 j = 0; j < 4; ++j) {
+                _mm_storeu_ps(&q[j].uv.x0, uv);
+                q[j].col = col;
+                q[j].radius = radius;
+                q[j].theta = 0.0f;
+            }
+            
+            written += 4;
+        } else if (mask != 0) {
+            f32 lane_x[4];
+            f32 lane_y[4];
+            _mm_storeu_ps(lane_x, px);
+            _mm_storeu_ps(lane_y, py);
+            
+            for (u32 j = 0; j < 4; ++j) {
+                if (mask & (1 << j)) {
+                    R_Quad *q = quads + written++;
+                    q->pos = { lane_x[j] - radius, lane_y[j] - radius, lane_x[j] + radius, lane_y[j] + radius };
+                    q->uv = r_solid.uv;
+                    q->col = col;
+                    q->radius = radius;
+                    q->theta = 0.0f;
+                }
+            }
+        }
+    }
+    
+    for (; i < count; ++i) {
+        f32 px = origin.X + xs[i]*scale.X;
+        f32 py = origin.Y + ys[i]*scale.Y;
+        
+        if (clipped && !(px >= bounds.x0 && px <= bounds.x1 && py >= bounds.y0 && py <= bounds.y1)) {
+            continue;
+        }
+        
+        R_Quad *q = quads + written++;
+        q->pos = { px - radius, py - radius, px + radius, py + radius };
+        q->uv = r_solid.uv;
+        q->col = col;
+        q->radius = radius;
+        q->theta = 0.0f;
+    }
+    
+    r_quads_commit(ctx, written);
+}
+
+internal void r_marker(R_Ctx *ctx, HMM_Vec2 pos, f32 radius, R_Marker_Shape shape, u8 palette)
+{
+    Assert(radius >= 0.0f && shape < R_MARKER_SHAPE_COUNT);
+    
+    f32 pad = radius + 2.0f;
+    RectF32 bounds = { pos.X - pad, pos.Y - pad, pos.X + pad, pos.Y + pad };
+    if (r_ctx_clip_rejects(ctx, bounds)) {
+        return;
+    }
+    
+    R_Marker *marker = r_markers_reserve(ctx, 1);
+    marker->x = pos.X;
+    marker->y = pos.Y;
+    marker->radius = r_f16_from_f32(radius);
+    marker->shape = (u8) shape;
+    marker->palette = palette;
+    
+    r_markers_commit(ctx, 1);
+}
+
+internal void r_markers(R_Ctx *ctx, f32 *xs, f32 *ys, usize count, HMM_Vec2 origin, HMM_Vec2 scale, f32 radius, R_Marker_Shape shape, u8 palette)
 {
-    r_prep_batch(ctx->arena, ctx->list, texture);
+    OPTICK_EVENT();
+    
+    Assert(radius >= 0.0f && shape < R_MARKER_SHAPE_COUNT);
+    
+    R_Marker *markers = r_markers_reserve(ctx, count);
+    
+    // @Note: Everything but the centre is the same for all of them, so the tail of each
+    // marker is one precomputed u32 and the centres are interleaved four at a time.
+    u32 tail = (u32) r_f16_from_f32(radius) | ((u32) shape << 16) | ((u32) palette << 24);
+    
+    __m128 ox = _mm_set1_ps(origin.X);
+    __m128 oy = _mm_set1_ps(origin.Y);
+    __m128 sx = _mm_set1_ps(scale.X);
+    __m128 sy = _mm_set1_ps(scale.Y);
+    
+    // @Note: Same clip rejection as in r_circs_from_xy()
+    b32 clipped = ctx->clip_depth > 0;
+    f32 pad = radius + 2.0f;
+    RectF32 bounds = { ctx->clip.x0 - pad, ctx->clip.y0 - pad, ctx->clip.x1 + pad, ctx->clip.y1 + pad };
+    __m128 bx0 = _mm_set1_ps(bounds.x0);
+    __m128 by0 = _mm_set1_ps(bounds.y0);
+    __m128 bx1 = _mm_set1_ps(bounds.x1);
+    __m128 by1 = _mm_set1_ps(bounds.y1);
+    
+    usize written = 0;
+    usize i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 px = _mm_add_ps(ox, _mm_mul_ps(_mm_loadu_ps(xs + i), sx));
+        __m128 py = _mm_add_ps(oy, _mm_mul_ps(_mm_loadu_ps(ys + i), sy));
+        
+        s32 mask = 0xF;
+        if (clipped) {
+            __m128 in_x = _mm_and_ps(_mm_cmpge_ps(px, bx0), _mm_cmple_ps(px, bx1));
+            __m128 in_y = _mm_and_ps(_mm_cmpge_ps(py, by0), _mm_cmple_ps(py, by1));
+            mask = _mm_movemask_ps(_mm_and_ps(in_x, in_y));
+        }
+        
+        if (mask == 0xF) {
+            __m128 lo = _mm_unpacklo_ps(px, py);
+            __m128 hi = _mm_unpackhi_ps(px, py);
+            
+            R_Marker *m = markers + written;
+            _mm_storel_pi((__m64 *) &m[0].x, lo);
+            _mm_storeh_pi((__m64 *) &m[1].x, lo);
+            _mm_storel_pi((__m64 *) &m[2].x, hi);
+            _mm_storeh_pi((__m64 *) &m[3].x, hi);
+            
+            for (u32 j = 0; j < 4; ++j) {
+                MemoryCopy(&m[j].radius, &tail, sizeof(u32));
+            }
+            
+            written += 4;
+        } else if (mask != 0) {
+            f32 lane_x[4];
+            f32 lane_y[4];
+            _mm_storeu_ps(lane_x, px);
+            _mm_storeu_ps(lane_y, py);
+            
+            for (u32 j = 0; j < 4; ++j) {
+                if (mask & (1 << j)) {
+                    R_Marker *m = markers + written++;
+                    m->x = lane_x[j];
+                    m->y = lane_y[j];
+                    MemoryCopy(&m->radius, &tail, sizeof(u32));
+                }
+            }
+        }
+    }
     
+    for (; i < count; ++i) {
+        f32 px = origin.X + xs[i]*scale.X;
+        f32 py = origin.Y + ys[i]*scale.Y;
+        
+        if (clipped && !(px >= bounds.x0 && px <= bounds.x1 && py >= bounds.y0 && py <= bounds.y1)) {
+            continue;
+        }
+        
+        R_Marker *m = markers + written++;
+        m->x = px;
+        m->y = py;
+        MemoryCopy(&m->radius, &tail, sizeof(u32));
+    }
+    
+    r_markers_commit(ctx, written);
+}
+
+internal void r_line(R_Ctx *ctx, HMM_Vec2 a, HMM_Vec2 b, R_Line_Style style)
+{
+    f32 xs[] = { a.X, b.X };
+    f32 ys[] = { a.Y, b.Y };
+    HMM_Vec2 origin = { 0.0f, 0.0f };
+    HMM_Vec2 scale = { 1.0f, 1.0f };
+    r_polyline(ctx, xs, ys, 2, origin, scale, style);
+}
+
+internal void r_polyline(R_Ctx *ctx, f32 *xs, f32 *ys, usize count, HMM_Vec2 origin, HMM_Vec2 scale, R_Line_Style style)
+{
+    OPTICK_EVENT();
+    
+    Assert(style.width >= 0.0f);
+    
+    // @Note: Lines are not rejected on the CPU, dropping vertices would change the
+    // segments that are still visible. The backend scissor takes care of them.
+    
+    if (count > 1) {
+        u32 style_id = r_list_line_style_id(ctx->list, &style);
+        
+        // @Note: One extra vertex for the terminator, so that lines that end up
+        // next to each other in the same command don't get connected.
+        R_Line_Vertex *vertices = (R_Line_Vertex *) r_prep_cmd(ctx, R_CMD_LINES, 0, style_id, count + 1);
+        
+        // @Note: Only the distance along the line is computed here (one sqrt per vertex,
+        // and only with dashes on), segment directions, joins and dashes are the backend's job.
+        b32 dashed = style.dash > 0.0f && style.gap > 0.0f;
+        f32 dist = 0.0f;
+        f32 px = origin.X + xs[0]*scale.X;
+        f32 py = origin.Y + ys[0]*scale.Y;
+        for (usize i = 0; i < count; ++i) {
+            f32 x = origin.X + xs[i]*scale.X;
+            f32 y = origin.Y + ys[i]*scale.Y;
+            if (dashed) {
+                f32 dx = x - px;
+                f32 dy = y - py;
+                dist += HMM_SqrtF(dx*dx + dy*dy);
+                px = x;
+                py = y;
+            }
+            
+            vertices[i].x = x;
+            vertices[i].y = y;
+            vertices[i].dist = dist;
+        }
+        
+        vertices[count].x = 0.0f;
+        vertices[count].y = 0.0f;
+        vertices[count].dist = -1.0f;
+        
+        r_commit_cmd(ctx, R_CMD_LINES, count + 1);
+    }
+}
+
+internal void r_rect_tex_ex(R_Ctx *ctx, RectF32 pos, u32 tint, f32 radius, f32 theta, RectF32 uv, R_Texture2D *texture)
+{
     R_Quad quad = {0};
     quad.pos = pos;
     quad.col = tint;
@@ -103,7 +645,7 @@ internal void r_rect_tex_ex(R_Ctx *ctx, RectF32 pos, u32 tint, f32 radius, f32 t
     quad.theta = theta;
     quad.uv = uv;
     
-    r_push_quad(ctx->arena, ctx->list->last, &quad);
+    r_push_quad(ctx, texture, &quad);
 }
 
 internal void r_rect_tex(R_Ctx *ctx, RectF32 pos, f32 radius, R_Texture2D *texture)
@@ -114,13 +656,99 @@ internal void r_rect_tex(R_Ctx *ctx, RectF32 pos, f32 radius, R_Texture2D *textu
 
 internal void r_flush_batches(GFX_Window *window, R_List *list)
 {
+    OPTICK_EVENT();
+    
     if (!r_is_init()) {
         er_push(str8("render backend not initialized"));
-    } else {
-        R_Quad_Batch *batch = list->first;
-        while (batch != 0) {
-            r_submit_quads(window, batch->first, batch->total_quad_count, batch->texture);
-            batch = batch->next;
+    } else if (list->count > 0) {
+        Arena_Temp temp = arena_temp_begin(list->arena);
+        
+        R_Cmd **cmds = arena_push_array(temp.arena, R_Cmd *, list->count);
+        usize cmd_count = 0;
+        for (R_Cmd *cmd = list->first; cmd != 0; cmd = cmd->next) {
+            if (cmd->count > 0) {
+                cmds[cmd_count++] = cmd;
+            }
+        }
+        
+        R_Cmd **sorted = r_sort_cmds(temp.arena, cmds, cmd_count);
+        
+        // @Note: Runs of neighbouring commands with equal state (everything but the layer) become one
+        // submission, the nodes are just views into the list's chunks.
+        usize i = 0;
+        while (i < cmd_count) {
+            u64 state = r_key_state(sorted[i]->key);
+            
+            R_Draw_State draw_state = {0};
+            draw_state.texture = list->textures[r_key_texture(state)];
+            draw_state.blend = (R_Blend) r_key_blend(state);
+            if (r_key_clip(state) != 0) {
+                draw_state.clipped = 1;
+                draw_state.clip = list->clips[r_key_clip(state) - 1];
+            }
+            
+            switch (r_key_kind(state)) {
+                case R_CMD_QUADS: {
+                    draw_state.sample = (R_Sample) r_key_param(state);
+                    
+                    R_Quad_Node *first = 0;
+                    R_Quad_Node *last = 0;
+                    usize total = 0;
+                    for (; i < cmd_count && r_key_state(sorted[i]->key) == state; ++i) {
+                        R_Quad_Node *node = arena_push_array(temp.arena, R_Quad_Node, 1);
+                        node->quads = (R_Quad *) sorted[i]->data;
+                        node->count = sorted[i]->count;
+                        node->cap = sorted[i]->count;
+                        
+                        SLLQueuePush(first, last, node);
+                        total += node->count;
+                    }
+                    
+                    r_submit_quads(window, first, total, draw_state);
+                } break;
+                
+                case R_CMD_MARKERS: {
+                    R_Marker_Node *first = 0;
+                    R_Marker_Node *last = 0;
+                    usize total = 0;
+                    for (; i < cmd_count && r_key_state(sorted[i]->key) == state; ++i) {
+                        R_Marker_Node *node = arena_push_array(temp.arena, R_Marker_Node, 1);
+                        node->markers = (R_Marker *) sorted[i]->data;
+                        node->count = sorted[i]->count;
+                        node->cap = sorted[i]->count;
+                        
+                        SLLQueuePush(first, last, node);
+                        total += node->count;
+                    }
+                    
+                    r_submit_markers(window, first, total, draw_state);
+                } break;
+                
+                case R_CMD_LINES: {
+                    R_Line_Node *first = 0;
+                    R_Line_Node *last = 0;
+                    usize total = 0;
+                    for (; i < cmd_count && r_key_state(sorted[i]->key) == state; ++i) {
+                        R_Line_Node *node = arena_push_array(temp.arena, R_Line_Node, 1);
+                        node->vertices = (R_Line_Vertex *) sorted[i]->data;
+                        node->count = sorted[i]->count;
+                        node->cap = sorted[i]->count;
+                        
+                        SLLQueuePush(first, last, node);
+                        total += node->count;
+                    }
+                    
+                    draw_state.line = list->line_styles[r_key_param(state)];
+                    r_submit_lines(window, first, total, draw_state);
+                } break;
+                
+                default: {
+                    Assert(!"Unknown command kind");
+                    for (; i < cmd_count && r_key_state(sorted[i]->key) == state; ++i);
+                } break;
+            }
         }
+        
+        arena_temp_end(&temp);
     }
 }
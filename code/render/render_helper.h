@@ -1,42 +1,187 @@
 #ifndef RENDER_HELPER_H
 #define RENDER_HELPER_H
 
+#include <xmmintrin.h>
+
 #ifndef R_MAX_QUAD_CHUNK
 # define R_MAX_QUAD_CHUNK 4096
 #endif
 
-typedef struct R_Quad_Batch {
-    struct R_Quad_Batch *next;
-    
-    R_Quad_Node *first;
-    R_Quad_Node *last;
+#ifndef R_MAX_MARKER_CHUNK
+# define R_MAX_MARKER_CHUNK 16384
+#endif
+
+#ifndef R_LAYER_COUNT
+# define R_LAYER_COUNT 8
+#endif
+
+#ifndef R_MAX_LINE_CHUNK
+# define R_MAX_LINE_CHUNK 16384
+#endif
+
+#ifndef R_MAX_LIST_TEXTURES
+# define R_MAX_LIST_TEXTURES 64
+#endif
+
+#ifndef R_MAX_LIST_CLIPS
+# define R_MAX_LIST_CLIPS 256
+#endif
+
+#ifndef R_MAX_CLIP_DEPTH
+# define R_MAX_CLIP_DEPTH 16
+#endif
+
+#ifndef R_MAX_LIST_LINE_STYLES
+# define R_MAX_LIST_LINE_STYLES 256
+#endif
+
+// @Note: 64-bit sort key of a command, from most to least significant:
+// | layer 8 | clip 16 | blend 4 | texture 16 | kind 4 | param 16 |
+// 'param' is per kind, for quads it's the R_Sample mode and for lines it's the style id. Clip 0 is 'not clipped',
+// anything else is one past the index into the list's clip table.
+// Commands are stable-sorted by layer only before flushing, so inside a layer they're drawn in the order
+// they were pushed. Neighbours with the same state (everything below the layer) share a draw call, also
+// across a layer boundary.
+#define R_KEY_LAYER_SHIFT 56
+#define R_KEY_CLIP_SHIFT 40
+#define R_KEY_BLEND_SHIFT 36
+#define R_KEY_TEXTURE_SHIFT 20
+#define R_KEY_KIND_SHIFT 16
+#define R_KEY_PARAM_SHIFT 0
+
+#define R_KEY_LAYER_MASK 0xFFull
+#define R_KEY_CLIP_MASK 0xFFFFull
+#define R_KEY_BLEND_MASK 0xFull
+#define R_KEY_TEXTURE_MASK 0xFFFFull
+#define R_KEY_KIND_MASK 0xFull
+#define R_KEY_PARAM_MASK 0xFFFFull
+
+#define r_key_make(layer, clip, blend, texture, kind, param)          \
+    ((((u64) (layer) & R_KEY_LAYER_MASK) << R_KEY_LAYER_SHIFT) |       \
+     (((u64) (clip) & R_KEY_CLIP_MASK) << R_KEY_CLIP_SHIFT) |          \
+     (((u64) (blend) & R_KEY_BLEND_MASK) << R_KEY_BLEND_SHIFT) |       \
+     (((u64) (texture) & R_KEY_TEXTURE_MASK) << R_KEY_TEXTURE_SHIFT) | \
+     (((u64) (kind) & R_KEY_KIND_MASK) << R_KEY_KIND_SHIFT) |          \
+     (((u64) (param) & R_KEY_PARAM_MASK) << R_KEY_PARAM_SHIFT))
+
+#define r_key_layer(key) (((key) >> R_KEY_LAYER_SHIFT) & R_KEY_LAYER_MASK)
+#define r_key_clip(key) (((key) >> R_KEY_CLIP_SHIFT) & R_KEY_CLIP_MASK)
+#define r_key_blend(key) (((key) >> R_KEY_BLEND_SHIFT) & R_KEY_BLEND_MASK)
+#define r_key_texture(key) (((key) >> R_KEY_TEXTURE_SHIFT) & R_KEY_TEXTURE_MASK)
+#define r_key_kind(key) (((key) >> R_KEY_KIND_SHIFT) & R_KEY_KIND_MASK)
+#define r_key_param(key) (((key) >> R_KEY_PARAM_SHIFT) & R_KEY_PARAM_MASK)
+
+// @Note: Everything but the layer, commands with equal state can share a draw call.
+#define r_key_state(key) ((key) & ~(R_KEY_LAYER_MASK << R_KEY_LAYER_SHIFT))
+
+// @Note: What the elements of a command are, each kind goes through its own submit path.
+typedef enum {
+    R_CMD_QUADS = 0,
+    R_CMD_MARKERS,
+    R_CMD_LINES,
+    R_CMD_KIND_COUNT,
+} R_Cmd_Kind;
+
+// @Note: A contiguous range of elements that all share one sort key.
+typedef struct R_Cmd {
+    struct R_Cmd *next;
+
+    u64 key;
+    void *data;
     usize count;
-    usize total_quad_count;
-    
-    R_Texture2D *texture;
-} R_Quad_Batch;
+} R_Cmd;
 
+// @Note: Element storage of one kind, commands are ranges inside of these chunks
 typedef struct {
-    R_Quad_Batch *first;
-    R_Quad_Batch *last;
+    u8 *data;
     usize count;
+    usize cap;
+} R_Chunk;
+
+typedef struct {
+    Arena *arena; // @Note: Taken from the first context that pushes into the list
+
+    R_Cmd *first;
+    R_Cmd *last;
+    usize count;
+
+    R_Chunk chunks[R_CMD_KIND_COUNT];
+
+    // @Note: Texture id inside the sort key indexes this table
+    R_Texture2D *textures[R_MAX_LIST_TEXTURES];
+    u32 texture_count;
+    
+    // @Note: Same for the param of line commands
+    R_Line_Style line_styles[R_MAX_LIST_LINE_STYLES];
+    u32 line_style_count;
+    
+    RectF32 clips[R_MAX_LIST_CLIPS];
+    u32 clip_count;
 } R_List;
 
 typedef struct {
     Arena *arena;
     R_List *list;
+    u32 layer;
+    R_Blend blend;
+    
+    // @Note: Ids into the list's clip table and their rects, 'clip' is the rect of the top one. An id can
+    // be 0 when the table was full, the rect is still kept for culling.
+    u32 clip_stack[R_MAX_CLIP_DEPTH];
+    RectF32 clip_rects[R_MAX_CLIP_DEPTH];
+    u32 clip_depth;
+    RectF32 clip;
 } R_Ctx;
 
+// @Note: Where solid (untextured) quads sample from. Pointing this at a white region inside
+// an atlas that is also used for text lets rects and glyphs share batches and draw calls.
+typedef struct {
+    R_Texture2D *texture;
+    RectF32 uv;
+} R_Solid;
+
 // @Note: Actual internal helpers
-internal R_Ctx r_make_context(Arena *arena, R_List *list);
-internal void r_new_batch(Arena *arena, R_List *list);
-internal void r_prep_batch(Arena *arena, R_List *list, R_Texture2D *texture);
-internal void r_push_quad(Arena *arena, R_Quad_Batch *batch, R_Quad *quad);
+internal R_Ctx r_make_context(Arena *arena, R_List *list, u32 layer);
+internal u32 r_list_texture_id(R_List *list, R_Texture2D *texture);
+internal u32 r_list_line_style_id(R_List *list, R_Line_Style *style);
+internal u32 r_list_clip_id(R_List *list, RectF32 *rect);
+internal b32 r_ctx_clip_rejects(R_Ctx *ctx, RectF32 bounds);
+internal u64 r_ctx_key(R_Ctx *ctx, R_Texture2D *texture, R_Cmd_Kind kind, u32 param);
+internal void *r_prep_cmd(R_Ctx *ctx, R_Cmd_Kind kind, R_Texture2D *texture, u32 param, usize count);
+internal void r_commit_cmd(R_Ctx *ctx, R_Cmd_Kind kind, usize count);
+internal void r_push_quad(R_Ctx *ctx, R_Texture2D *texture, R_Quad *quad);
+internal void r_push_quad_ex(R_Ctx *ctx, R_Texture2D *texture, R_Quad *quad, R_Sample sample);
+internal R_Cmd **r_sort_cmds(Arena *arena, R_Cmd **cmds, usize count);
+
+// @Note: Bulk emission, r_quads_reserve() returns 'count' contiguous writable quads for
+// 'texture', r_quads_commit() then makes the first 'count' of them visible. Nothing else
+// may be pushed into the same list in between. Quads written this way are taken
+// as they are, x0 <= x1 and y0 <= y1 is on the caller.
+internal R_Quad *r_quads_reserve(R_Ctx *ctx, R_Texture2D *texture, usize count);
+internal R_Quad *r_quads_reserve_ex(R_Ctx *ctx, R_Texture2D *texture, usize count, R_Sample sample);
+internal void r_quads_commit(R_Ctx *ctx, usize count);
+internal R_Marker *r_markers_reserve(R_Ctx *ctx, usize count);
+internal void r_markers_commit(R_Ctx *ctx, usize count);
+internal u16 r_f16_from_f32(f32 value);
+internal f32 r_f32_from_f16(u16 value);
+
+// @Note: Everything pushed into the context is clipped to the intersection of all pushed rects,
+// both by the backend and up front for quads and markers that are fully outside of it.
+internal void r_push_clip(R_Ctx *ctx, RectF32 rect);
+internal void r_pop_clip(R_Ctx *ctx);
+
+internal void r_solid_set(R_Texture2D *texture, RectF32 uv);
+internal R_Solid r_solid_get(void);
 
 // @Note: Helpers more 'external', intended to be more user-friendly
 internal void r_rect_ex(R_Ctx *ctx, RectF32 pos, u32 col, f32 radius, f32 theta);
 internal void r_rect(R_Ctx *ctx, RectF32 pos, u32 col, f32 radius);
 internal void r_circ(R_Ctx *ctx, HMM_Vec2 pos, u32 col, f32 radius);
+internal void r_circs_from_xy(R_Ctx *ctx, f32 *xs, f32 *ys, usize count, HMM_Vec2 origin, HMM_Vec2 scale, u32 col, f32 radius);
+internal void r_marker(R_Ctx *ctx, HMM_Vec2 pos, f32 radius, R_Marker_Shape shape, u8 palette);
+internal void r_markers(R_Ctx *ctx, f32 *xs, f32 *ys, usize count, HMM_Vec2 origin, HMM_Vec2 scale, f32 radius, R_Marker_Shape shape, u8 palette);
+internal void r_line(R_Ctx *ctx, HMM_Vec2 a, HMM_Vec2 b, R_Line_Style style);
+internal void r_polyline(R_Ctx *ctx, f32 *xs, f32 *ys, usize count, HMM_Vec2 origin, HMM_Vec2 scale, R_Line_Style style);
 internal void r_rect_tex_ex(R_Ctx *ctx, RectF32 pos, u32 tint, f32 radius, f32 theta, RectF32 uv, R_Texture2D *texture);
 internal void r_rect_tex(R_Ctx *ctx, RectF32 pos, f32 radius, R_Texture2D *texture);
 internal void r_flush_batches(GFX_Window *window, R_List *list);
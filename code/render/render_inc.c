@@ -2,6 +2,8 @@
 #define RENDER_INC_C
 
 #include "./render/render_helper.c"
+#include "./render/render_capture.c"
+#include "./render/render_atlas.c"
 
 #if R_BACKEND_D3D11
 # if _WIN32
@@ -9,6 +11,8 @@
 # else
 #  error d3d11 backend is only available on windows for now render_inc.c
 # endif
+#elif R_BACKEND_NULL
+# include "./render/null/null_render_impl.c"
 #elif R_BACKEND_OPENGL
 # error opengl backend not implemented render_inc.c
 #else
@@ -5,6 +5,8 @@
 #include "./render/render.h"
 
 #include "./render/render_helper.h"
+#include "./render/render_capture.h"
+#include "./render/render_atlas.h"
 
 #if R_BACKEND_D3D11
 # if _WIN32
@@ -12,6 +14,8 @@
 # else
 #  error d3d11 backend is only available on windows for now render_inc.h
 # endif
+#elif R_BACKEND_NULL
+# include "./render/null/null_render_impl.h"
 #elif R_BACKEND_OPENGL
 # error opengl backend not implemented render_inc.h
 #else
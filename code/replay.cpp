@@ -0,0 +1,143 @@
+#if !R_BACKEND_D3D11
+# define R_BACKEND_NULL 1
+#endif
+
+// @Note: Feeds a stream recorded with r_capture_frame() into the backend this is built with,
+// drawing into an offscreen target of the recorded size, and reports per-frame timings.
+//
+// replay <capture file> [passes] [-sync]
+//
+// With -sync every frame is read back, so timings include the GPU finishing the frame.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <HandmadeMath.h>
+#include <optick.h>
+
+#include "./base/base_inc.h"
+#include "./os/os_inc.h"
+#include "./gfx/gfx_inc.h"
+#include "./render/render_inc.h"
+
+#include "./base/base_inc.c"
+#include "./os/os_inc.c"
+#include "./gfx/gfx_inc.c"
+#include "./render/render_inc.c"
+
+internal usize replay_element_count(R_List *list)
+{
+    usize result = 0;
+    for (R_Cmd *cmd = list->first; cmd != 0; cmd = cmd->next) {
+        result += cmd->count;
+    }
+    
+    return(result);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        printf("usage: replay <capture file> [passes] [-sync]\n");
+        return 1;
+    }
+    
+    u32 passes = 1;
+    b32 sync = 0;
+    for (int i = 2; i < argc; ++i) {
+        if (strcmp(argv[i], "-sync") == 0) {
+            sync = 1;
+        } else {
+            passes = MAX(atoi(argv[i]), 1);
+        }
+    }
+    
+    os_main_init();
+    r_backend_init();
+    
+    Arena *arena = arena_make();
+    Arena *frame_arena = arena_make();
+    
+    er_accum_start();
+    
+    R_Replay replay = {0};
+    if (!r_replay_open(&replay, arena, str8_from_cstr(argv[1]))) {
+        String8 errors = er_accum_end(arena);
+        printf("Failed to open capture: %.*s\n", (int) errors.size, errors.data);
+        return 1;
+    }
+    
+    printf("%u frames, %u passes%s\n", replay.frame_count, passes, sync ? ", synced" : "");
+    printf("%6s | %10s | %8s | %12s | %10s\n", "frame", "size", "cmds", "elements", "ms");
+    
+    R_Target *target = 0;
+    u32 target_width = 0;
+    u32 target_height = 0;
+    
+    f64 total_ms = 0.0;
+    f64 min_ms = 0.0;
+    f64 max_ms = 0.0;
+    u32 total_frames = 0;
+    
+    for (u32 pass = 0; pass < passes; ++pass) {
+        r_replay_rewind(&replay);
+        
+        R_List list = {0};
+        R_Replay_Frame frame = {0};
+        for (u32 index = 0; r_replay_next(&replay, frame_arena, &list, &frame); ++index) {
+            u32 width = (u32) MAX(frame.width, 1.0f);
+            u32 height = (u32) MAX(frame.height, 1.0f);
+            if (target == 0 || width != target_width || height != target_height) {
+                if (target) r_target_destroy(target);
+                target = r_target_create(width, height);
+                target_width = width;
+                target_height = height;
+            }
+            
+            f64 start = os_ticks_now();
+            {
+                r_target_begin(target, frame.clear_color);
+                r_flush_batches(0, &list);
+                r_target_end(target);
+                
+                if (sync) {
+                    r_target_read_pixels(target);
+                }
+            }
+            f64 ms = os_ticks_now() - start;
+            
+            total_ms += ms;
+            min_ms = (total_frames == 0) ? ms : MIN(min_ms, ms);
+            max_ms = (total_frames == 0) ? ms : MAX(max_ms, ms);
+            total_frames += 1;
+            
+            if (pass == passes - 1) {
+                printf("%6u | %4ux%-5u | %8zu | %12zu | %10.3f\n",
+                       index, width, height, list.count, replay_element_count(&list), ms);
+            }
+            
+            arena_clear(frame_arena);
+        }
+    }
+    
+    String8 errors = er_accum_end(arena);
+    if (errors.size > 0) {
+        printf("Errors: %.*s\n", (int) errors.size, errors.data);
+    }
+    
+    if (total_frames > 0) {
+        printf("avg %.3f ms, min %.3f ms, max %.3f ms over %u frames\n",
+               total_ms/total_frames, min_ms, max_ms, total_frames);
+    }
+    
+    if (target) r_target_destroy(target);
+    r_replay_close(&replay);
+    
+    arena_release(frame_arena);
+    arena_release(arena);
+    
+    r_backend_end();
+    
+    return 0;
+}